@@ -0,0 +1,104 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/frta-routing-helper.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FrtaResolveExample");
+
+/**
+ * Checks that route discovery alone resolves a multi-hop route.
+ *
+ *   requester -- relay 1 -- ... -- relay n -- target
+ *
+ * Only neighbors hear each other. The requester resolves the target once
+ * the initial advertisements are over, so the route can only come from
+ * the reply to its request. The run fails unless the route is resolved
+ * by the first discovery round, long before the next advertisement.
+ */
+
+static Time g_requested;
+static Time g_resolved;
+static bool g_available = false;
+
+static void
+RouteResolved(Ipv4Address destination, bool available)
+{
+  g_resolved = Simulator::Now();
+  g_available = available;
+  std::cout << "Route to " << destination << (available ? " resolved" : " not resolved")
+            << " after " << (g_resolved - g_requested).GetMilliSeconds() << " ms" << std::endl;
+}
+
+static void
+Resolve(Ptr<Node> node, Ipv4Address destination, Time timeout)
+{
+  g_requested = Simulator::Now();
+  FrtaRoutingHelper::ResolveRoute(node, destination, MakeCallback(&RouteResolved), timeout);
+}
+
+int
+main(int argc, char *argv[])
+{
+  uint32_t nRelays = 2;
+  double spacing = 80.0;
+  double updateInterval = 30.0;
+  double requestTimeout = 2.0;
+
+  CommandLine cmd;
+  cmd.AddValue("nRelays", "Number of relays between requester and target", nRelays);
+  cmd.AddValue("spacing", "Distance between neighboring nodes, m", spacing);
+  cmd.AddValue("updateInterval", "Interval between route advertisements, s", updateInterval);
+  cmd.AddValue("requestTimeout", "Time to wait for a route reply, s", requestTimeout);
+  cmd.Parse(argc, argv);
+
+  FrtaRoutingProtocol::EnableProtocolLog(false);
+
+  NodeContainer nodes;
+  nodes.Create(nRelays + 2);
+
+  WifiHelper wifi;
+  wifi.SetStandard(WIFI_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy;
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
+  wifiChannel.AddPropagationLoss("ns3::RangePropagationLossModel",
+                                "MaxRange", DoubleValue(1.5 * spacing));
+  wifiPhy.SetChannel(wifiChannel.Create());
+  WifiMacHelper wifiMac;
+  wifiMac.SetType("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, nodes);
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator("ns3::GridPositionAllocator",
+                               "MinX", DoubleValue(0.0),
+                               "MinY", DoubleValue(0.0),
+                               "DeltaX", DoubleValue(spacing),
+                               "GridWidth", UintegerValue(nodes.GetN()),
+                               "LayoutType", StringValue("RowFirst"));
+  mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+  mobility.Install(nodes);
+
+  FrtaRoutingHelper frtaRouting;
+  frtaRouting.Set("UpdateInterval", TimeValue(Seconds(updateInterval)));
+  frtaRouting.Set("RouteRequestTimeout", TimeValue(Seconds(requestTimeout)));
+  frtaRouting.Install(nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+  Ipv4Address target = interfaces.GetAddress(nodes.GetN() - 1);
+  Simulator::Schedule(Seconds(1.0), &Resolve, nodes.Get(0), target, Seconds(updateInterval));
+
+  Simulator::Stop(Seconds(1.0 + updateInterval));
+  Simulator::Run();
+  Simulator::Destroy();
+
+  NS_ABORT_MSG_UNLESS(g_available, "No route to " << target << " was resolved");
+  NS_ABORT_MSG_UNLESS(g_resolved - g_requested < Seconds(requestTimeout),
+                      "The route to " << target << " took more than one discovery round");
+  return 0;
+}
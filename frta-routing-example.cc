@@ -8,6 +8,8 @@
 #include "ns3/netanim-module.h"
 #include "ns3/frta-routing-helper.h"
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 using namespace ns3;
 
@@ -46,20 +48,44 @@ main(int argc, char *argv[])
   LogComponentEnable("FrtaRoutingProtocol", LOG_LEVEL_INFO);
   LogComponentEnable("FrtaRoutingExample", LOG_LEVEL_INFO);
 
+  uint32_t nNodes = 5;
+  bool protocolLog = true;
+  double snapshotTime = 0.0;
+  std::string snapshotFile = "frta-snapshot.bin";
+  std::string restoreFile;
+  double routeDumpInterval = 0.0;
+  std::string protocolType = "ns3::FrtaDefaultRoutingProtocol";
+  bool txPowerControl = false;
+
   // Allow command line arguments
   CommandLine cmd;
+  cmd.AddValue("nNodes", "Number of nodes (at least 5)", nNodes);
+  cmd.AddValue("protocolLog", "Write protocol events to frta-protocol.log", protocolLog);
+  cmd.AddValue("snapshotTime", "Time at which to save a warm-start snapshot (0 = never)", snapshotTime);
+  cmd.AddValue("snapshotFile", "Warm-start snapshot file to write", snapshotFile);
+  cmd.AddValue("restoreFile", "Warm-start snapshot file to restore before running", restoreFile);
+  cmd.AddValue("routeDumpInterval", "Interval between route cache dumps to frta-routes.csv (0 = off)",
+               routeDumpInterval);
+  cmd.AddValue("protocolType", "FRTA variant to run, e.g. ns3::FrtaConservativeRoutingProtocol "
+               "or ns3::FrtaLenientRoutingProtocol", protocolType);
+  cmd.AddValue("txPowerControl", "Send to each neighbor at the lowest power that reaches it "
+               "(0-20 dBm) instead of always at 20 dBm", txPowerControl);
   cmd.Parse(argc, argv);
+  nNodes = std::max<uint32_t>(nNodes, 5);
+
+  FrtaRoutingProtocol::EnableProtocolLog(protocolLog);
 
   NS_LOG_INFO("Creating nodes");
   // Create nodes
   NodeContainer nodes;
-  nodes.Create(5);
+  nodes.Create(nNodes);
 
   NS_LOG_INFO("Configuring WiFi");
   // Configure WiFi
   WifiHelper wifi;
   wifi.SetStandard(WIFI_STANDARD_80211b);
-  wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+  wifi.SetRemoteStationManager(txPowerControl ? "ns3::FrtaTxPowerWifiManager"
+                                               : "ns3::ConstantRateWifiManager",
                               "DataMode", StringValue("DsssRate11Mbps"),
                               "ControlMode", StringValue("DsssRate11Mbps"));
 
@@ -68,8 +94,9 @@ main(int argc, char *argv[])
   wifiChannel.AddPropagationLoss("ns3::RangePropagationLossModel",
                                 "MaxRange", DoubleValue(100.0));
   wifiPhy.SetChannel(wifiChannel.Create());
-  wifiPhy.Set("TxPowerStart", DoubleValue(20.0));
+  wifiPhy.Set("TxPowerStart", DoubleValue(txPowerControl ? 0.0 : 20.0));
   wifiPhy.Set("TxPowerEnd", DoubleValue(20.0));
+  wifiPhy.Set("TxPowerLevels", UintegerValue(txPowerControl ? 21 : 1));
   wifiPhy.Set("RxSensitivity", DoubleValue(-85.0));
 
   WifiMacHelper wifiMac;
@@ -86,7 +113,7 @@ main(int argc, char *argv[])
   positionAlloc->SetAttribute("MinY", DoubleValue(0.0));
   positionAlloc->SetAttribute("DeltaX", DoubleValue(30.0));
   positionAlloc->SetAttribute("DeltaY", DoubleValue(30.0));
-  positionAlloc->SetAttribute("GridWidth", UintegerValue(3));
+  positionAlloc->SetAttribute("GridWidth", UintegerValue(nNodes <= 9 ? 3 : std::ceil(std::sqrt(nNodes))));
   positionAlloc->SetAttribute("LayoutType", StringValue("RowFirst"));
   
   mobility.SetPositionAllocator(positionAlloc);
@@ -102,18 +129,26 @@ main(int argc, char *argv[])
   NS_LOG_INFO("Creating and configuring the FRTA routing helper");
   // Create and configure the FRTA routing helper
   FrtaRoutingHelper frtaRouting;
+  frtaRouting.SetTypeId(protocolType);
+  frtaRouting.Set("TxPowerControl", BooleanValue(txPowerControl));
   frtaRouting.SetUpdateInterval(Seconds(30.0));
   
   NS_LOG_INFO("Installing internet stack with FRTA routing");
-  // Install internet stack with FRTA routing
-  InternetStackHelper stack;
-  stack.SetRoutingHelper(frtaRouting);
-  stack.Install(nodes);
+  // Install internet stack with FRTA routing in a single bulk pass
+  frtaRouting.Install(nodes);
+  NS_LOG_INFO("FRTA install took " << frtaRouting.GetInstallDuration() << "s");
 
   NS_LOG_INFO("Assigning IP addresses");
   // Assign IP addresses
   Ipv4AddressHelper address;
-  address.SetBase("10.1.1.0", "255.255.255.0");
+  if (nNodes < 255)
+  {
+    address.SetBase("10.1.1.0", "255.255.255.0");
+  }
+  else
+  {
+    address.SetBase("10.1.0.0", "255.255.0.0");
+  }
   Ipv4InterfaceContainer interfaces = address.Assign(devices);
 
   NS_LOG_INFO("Setting up server application");
@@ -178,6 +213,21 @@ main(int argc, char *argv[])
   // Enable pcap tracing
   wifiPhy.EnablePcap("frta-routing", devices);
 
+  if (!restoreFile.empty())
+  {
+    NS_LOG_INFO("Restoring warm-start snapshot from " << restoreFile);
+    FrtaRoutingHelper::RestoreSnapshot(restoreFile, nodes);
+  }
+  if (snapshotTime > 0.0)
+  {
+    FrtaRoutingHelper::ScheduleSnapshot(Seconds(snapshotTime), snapshotFile, nodes);
+  }
+  if (routeDumpInterval > 0.0)
+  {
+    FrtaRoutingHelper::DumpAllRoutesEvery(Seconds(routeDumpInterval), Seconds(routeDumpInterval),
+                                          "frta-routes.csv");
+  }
+
   NS_LOG_INFO("Running simulation");
   // Run simulation
   Simulator::Stop(Seconds(20.0));
@@ -1,19 +1,45 @@
 #include "frta-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/udp-l4-protocol.h"
+#include "ns3/uinteger.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/string.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/txop.h"
+#include "ns3/wifi-mac-queue.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE("FrtaRoutingHelper");
 
-FrtaRoutingHelper::FrtaRoutingHelper() : m_updateInterval(Seconds(30.0))
+FrtaRoutingHelper::FrtaRoutingHelper()
+  : m_controlQueueDisc(false),
+    m_installDuration(0.0)
 {
   NS_LOG_FUNCTION(this);
+  m_agentFactory.SetTypeId("ns3::FrtaDefaultRoutingProtocol");
 }
 
 FrtaRoutingHelper::FrtaRoutingHelper(const FrtaRoutingHelper &o)
-  : m_updateInterval(o.m_updateInterval)
+  : m_agentFactory(o.m_agentFactory),
+    m_controlQueueDisc(o.m_controlQueueDisc),
+    m_installDuration(o.m_installDuration)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -38,18 +64,342 @@ FrtaRoutingHelper::Create(Ptr<Node> node) const
     node->AggregateObject(udp);
   }
   
-  Ptr<FrtaRoutingProtocol> protocol = CreateObject<FrtaRoutingProtocol>();
-  protocol->SetUpdateInterval(m_updateInterval);
+  Ptr<FrtaRoutingProtocol> protocol = m_agentFactory.Create<FrtaRoutingProtocol>();
   
   node->AggregateObject(protocol);
   return protocol;
 }
 
+void
+FrtaRoutingHelper::Set(std::string name, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION(this << name);
+  m_agentFactory.Set(name, value);
+}
+
+void
+FrtaRoutingHelper::SetTypeId(std::string tid)
+{
+  NS_LOG_FUNCTION(this << tid);
+  TypeId type = TypeId::LookupByName(tid);
+  NS_ABORT_MSG_UNLESS(type.IsChildOf(FrtaRoutingProtocol::GetTypeId()) && type.HasConstructor(),
+                      tid << " is not an FRTA routing protocol");
+  m_agentFactory.SetTypeId(tid);
+}
+
 void
 FrtaRoutingHelper::SetUpdateInterval(Time interval)
 {
   NS_LOG_FUNCTION(this << interval);
-  m_updateInterval = interval;
+  m_agentFactory.Set("UpdateInterval", TimeValue(interval));
+}
+
+void
+FrtaRoutingHelper::Install(NodeContainer nodes)
+{
+  NS_LOG_FUNCTION(this << nodes.GetN());
+  
+  auto start = std::chrono::steady_clock::now();
+  
+  m_agentFactory.Set("ExpectedNodes", UintegerValue(nodes.GetN()));
+  
+  InternetStackHelper stack;
+  stack.SetRoutingHelper(*this);
+  stack.Install(nodes);
+  
+  if (m_controlQueueDisc)
+  {
+    NetDeviceContainer devices;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+      for (uint32_t i = 0; i < (*it)->GetNDevices(); i++)
+      {
+        Ptr<NetDevice> device = (*it)->GetDevice(i);
+        if (!DynamicCast<LoopbackNetDevice>(device))
+        {
+          devices.Add(device);
+        }
+      }
+    }
+    InstallControlQueueDisc(devices);
+  }
+  
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  m_installDuration = elapsed.count();
+  
+  NS_LOG_INFO("Installed FRTA routing on " << nodes.GetN() << " nodes in "
+              << m_installDuration << "s");
+}
+
+void
+FrtaRoutingHelper::SetControlQueueDisc(bool enable)
+{
+  NS_LOG_FUNCTION(this << enable);
+  m_controlQueueDisc = enable;
+}
+
+void
+FrtaRoutingHelper::InstallControlQueueDisc(NetDeviceContainer devices, uint32_t macQueueSize)
+{
+  NS_LOG_FUNCTION(devices.GetN() << macQueueSize);
+  
+  // Priorities 6 and 7 go to band 0, everything else to band 1
+  TrafficControlHelper tch;
+  uint16_t handle = tch.SetRootQueueDisc("ns3::PrioQueueDisc", "Priomap",
+                                         StringValue("1 1 1 1 1 1 0 0 1 1 1 1 1 1 1 1"));
+  TrafficControlHelper::ClassIdList classes = tch.AddQueueDiscClasses(handle, 2, "ns3::QueueDiscClass");
+  tch.AddChildQueueDisc(handle, classes[0], "ns3::FifoQueueDisc");
+  tch.AddChildQueueDisc(handle, classes[1], "ns3::FifoQueueDisc");
+  
+  for (auto it = devices.Begin(); it != devices.End(); ++it)
+  {
+    Ptr<TrafficControlLayer> tc = (*it)->GetNode()->GetObject<TrafficControlLayer>();
+    if (tc && tc->GetRootQueueDiscOnDevice(*it))
+    {
+      tch.Uninstall(*it);
+    }
+    tch.Install(*it);
+    
+    // Wi-Fi stops the queue disc once its MAC queue is full
+    Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice>(*it);
+    if (wifiDevice && !wifiDevice->GetMac()->GetQosSupported())
+    {
+      wifiDevice->GetMac()->GetTxop()->GetWifiMacQueue()->SetMaxSize(
+          QueueSize(QueueSizeUnit::PACKETS, macQueueSize));
+    }
+  }
+}
+
+double
+FrtaRoutingHelper::GetInstallDuration() const
+{
+  return m_installDuration;
+}
+
+void
+FrtaRoutingHelper::ScheduleSnapshot(Time when, std::string path, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION(when << path);
+  Simulator::Schedule(when, &FrtaRoutingHelper::DoWriteSnapshot, path, nodes);
+}
+
+void
+FrtaRoutingHelper::DoWriteSnapshot(std::string path, NodeContainer nodes)
+{
+  WriteSnapshot(path, nodes);
+}
+
+bool
+FrtaRoutingHelper::WriteSnapshot(std::string path, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION(path);
+  
+  FrtaSnapshotWriter writer;
+  writer.WriteU32(FrtaSnapshotWriter::MAGIC);
+  writer.WriteU32(FrtaSnapshotWriter::VERSION);
+  writer.WriteDouble(Simulator::Now().GetSeconds());
+  
+  uint32_t count = 0;
+  for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+  {
+    if ((*it)->GetObject<FrtaRoutingProtocol>())
+    {
+      count++;
+    }
+  }
+  writer.WriteU32(count);
+  
+  for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+  {
+    Ptr<FrtaRoutingProtocol> protocol = (*it)->GetObject<FrtaRoutingProtocol>();
+    if (!protocol)
+    {
+      continue;
+    }
+    FrtaSnapshotWriter record;
+    protocol->SaveState(record);
+    writer.WriteU32((*it)->GetId());
+    writer.WriteRecord(record);
+  }
+  
+  bool ok = writer.WriteToFile(path);
+  NS_LOG_INFO("Wrote FRTA snapshot of " << count << " nodes (" << writer.GetSize()
+              << " bytes) to " << path << " at " << Simulator::Now().GetSeconds() << "s");
+  return ok;
+}
+
+bool
+FrtaRoutingHelper::RestoreSnapshot(std::string path, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION(path);
+  
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    NS_LOG_WARN("Cannot open snapshot file " << path);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+  void* mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED)
+  {
+    NS_LOG_WARN("Cannot map snapshot file " << path);
+    return false;
+  }
+  
+  std::unordered_map<uint32_t, Ptr<FrtaRoutingProtocol>> protocols;
+  protocols.reserve(nodes.GetN());
+  for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+  {
+    Ptr<FrtaRoutingProtocol> protocol = (*it)->GetObject<FrtaRoutingProtocol>();
+    if (protocol)
+    {
+      protocols[(*it)->GetId()] = protocol;
+    }
+  }
+  
+  FrtaSnapshotReader reader(static_cast<const uint8_t*>(mapped), st.st_size);
+  bool ok = reader.ReadU32() == FrtaSnapshotWriter::MAGIC &&
+            reader.ReadU32() == FrtaSnapshotWriter::VERSION;
+  double takenAt = reader.ReadDouble();
+  uint32_t count = reader.ReadU32();
+  uint32_t restored = 0;
+  
+  for (uint32_t i = 0; ok && i < count; i++)
+  {
+    uint32_t nodeId = reader.ReadU32();
+    FrtaSnapshotReader record = reader.ReadRecord();
+    if (!reader.IsOk())
+    {
+      ok = false;
+      break;
+    }
+    auto it = protocols.find(nodeId);
+    if (it == protocols.end())
+    {
+      continue;
+    }
+    ok = it->second->RestoreState(record);
+    restored++;
+  }
+  ok = ok && reader.IsOk();
+  
+  munmap(mapped, st.st_size);
+  
+  if (ok)
+  {
+    NS_LOG_INFO("Restored FRTA state of " << restored << " nodes from " << path
+                << " (taken at " << takenAt << "s)");
+  }
+  else
+  {
+    NS_LOG_WARN("Snapshot " << path << " is invalid or truncated");
+  }
+  return ok;
+}
+
+bool
+FrtaRoutingHelper::ResolveRoute(Ptr<Node> node, Ipv4Address destination,
+                                FrtaRoutingProtocol::RouteResolvedCallback callback, Time timeout)
+{
+  NS_LOG_FUNCTION(node << destination << timeout);
+  Ptr<FrtaRoutingProtocol> protocol = node->GetObject<FrtaRoutingProtocol>();
+  if (!protocol)
+  {
+    callback(destination, true);
+    return true;
+  }
+  return protocol->ResolveRoute(destination, callback, timeout);
+}
+
+void
+FrtaRoutingHelper::JoinGroup(NodeContainer nodes, Ipv4Address group)
+{
+  NS_LOG_FUNCTION(group);
+  for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+  {
+    Ptr<FrtaRoutingProtocol> protocol = (*it)->GetObject<FrtaRoutingProtocol>();
+    if (protocol)
+    {
+      protocol->JoinGroup(group);
+    }
+  }
+}
+
+int64_t
+FrtaRoutingHelper::AssignStreams(NodeContainer nodes, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+  {
+    Ptr<FrtaRoutingProtocol> protocol = (*it)->GetObject<FrtaRoutingProtocol>();
+    if (protocol)
+    {
+      currentStream += protocol->AssignStreams(currentStream);
+    }
+  }
+  return currentStream - stream;
+}
+
+void
+FrtaRoutingHelper::DumpAllRoutes(Time when, std::string path)
+{
+  NS_LOG_FUNCTION(when << path);
+  Simulator::Schedule(when, &FrtaRoutingHelper::DoDumpAllRoutes, path);
+}
+
+void
+FrtaRoutingHelper::DumpAllRoutesEvery(Time start, Time interval, std::string path)
+{
+  NS_LOG_FUNCTION(start << interval << path);
+  Simulator::Schedule(start, &FrtaRoutingHelper::DoDumpAllRoutesEvery, interval, path);
+}
+
+void
+FrtaRoutingHelper::DoDumpAllRoutesEvery(Time interval, std::string path)
+{
+  DoDumpAllRoutes(path);
+  Simulator::Schedule(interval, &FrtaRoutingHelper::DoDumpAllRoutesEvery, interval, path);
+}
+
+void
+FrtaRoutingHelper::DoDumpAllRoutes(std::string path)
+{
+  NS_LOG_FUNCTION(path);
+  
+  std::ofstream file(path, std::ios::out | std::ios::app);
+  if (!file)
+  {
+    NS_LOG_WARN("Cannot open route dump file " << path);
+    return;
+  }
+  
+  // Rows of all nodes are formatted into one buffer and written at once
+  std::ostringstream buffer;
+  if (file.tellp() == 0)
+  {
+    buffer << "time,node,destination,next_hop,hops,trust,age,sequence,collision_probability\n";
+  }
+  
+  std::ostringstream prefix;
+  prefix << Simulator::Now().GetSeconds() << ',';
+  
+  for (auto it = NodeList::Begin(); it != NodeList::End(); ++it)
+  {
+    Ptr<FrtaRoutingProtocol> protocol = (*it)->GetObject<FrtaRoutingProtocol>();
+    if (protocol)
+    {
+      protocol->WriteRouteCache(buffer, prefix.str());
+    }
+  }
+  
+  file << buffer.str();
 }
 
-} // namespace ns3
\ No newline at end of file
+} // namespace ns3
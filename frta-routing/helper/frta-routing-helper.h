@@ -2,6 +2,9 @@
 #define FRTA_ROUTING_HELPER_H
 
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
 #include "ns3/frta-routing-protocol.h"
 
 namespace ns3 {
@@ -26,13 +29,173 @@ public:
    */
   virtual Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const;
   
+  /**
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   *
+   * Set an attribute on each ns3::FrtaRoutingProtocol created by this helper.
+   */
+  void Set(std::string name, const AttributeValue &value);
+  
+  /**
+   * \param tid the TypeId of the protocol to create, e.g.
+   * "ns3::FrtaConservativeRoutingProtocol" to use another trust model
+   *
+   * The type must derive from ns3::FrtaRoutingProtocol; the default is
+   * ns3::FrtaDefaultRoutingProtocol. Attributes already set are kept.
+   */
+  void SetTypeId(std::string tid);
+
   /**
    * \param updateInterval the interval between periodic updates
    */
   void SetUpdateInterval(Time interval);
 
+  /**
+   * \param enable whether Install() puts control packets ahead of data
+   *
+   * When enabled, Install() replaces the root queue disc of every device with
+   * the one from InstallControlQueueDisc(). Install() must then be called
+   * before addresses are assigned, as usual.
+   */
+  void SetControlQueueDisc(bool enable);
+
+  /**
+   * \brief Serve FRTA control packets ahead of data on some devices
+   * \param devices the devices to install on
+   * \param macQueueSize packets the MAC queue of a non-QoS Wi-Fi device may hold
+   *
+   * Installs a two-band ns3::PrioQueueDisc whose first band holds packets of
+   * socket priority 6 and 7, the priority FRTA gives its control packets
+   * (see the ControlPriority attribute). Route replies and errors then no
+   * longer wait behind queued data. A root queue disc already on a device is
+   * replaced.
+   *
+   * The queue disc only orders packets that queue in it, not in the device.
+   * The single MAC queue of a non-QoS Wi-Fi device, 500 packets by default,
+   * is therefore shrunk to macQueueSize so that the backlog builds up above
+   * it. QoS Wi-Fi devices keep their MAC queues: there the same priority
+   * selects the voice access category, whose EDCA parameters already send
+   * control packets first. Other devices need a small transmit queue of
+   * their own for the queue disc to take effect.
+   */
+  static void InstallControlQueueDisc(NetDeviceContainer devices, uint32_t macQueueSize = 2);
+  
+  /**
+   * \brief Install the internet stack with FRTA routing on all nodes in one pass
+   * \param nodes the nodes to install on
+   *
+   * Per-node protocol state is pre-sized for the size of the container. The
+   * routing table of each node is initialized once, when the simulation
+   * starts and addresses have been assigned. The wall-clock time spent is
+   * available from GetInstallDuration().
+   */
+  void Install(NodeContainer nodes);
+  
+  /**
+   * \returns the wall-clock duration of the last Install() call, in seconds
+   */
+  double GetInstallDuration() const;
+
+  /**
+   * \brief Schedule a warm-start snapshot of FRTA state
+   * \param when the simulation time at which the snapshot is taken
+   * \param path the snapshot file to write
+   * \param nodes the nodes whose state is saved
+   *
+   * The snapshot holds each node's route cache, trust table, packet counts
+   * and collision statistics, and can be loaded into a later run with
+   * RestoreSnapshot().
+   */
+  static void ScheduleSnapshot(Time when, std::string path, NodeContainer nodes);
+
+  /**
+   * \brief Write a warm-start snapshot of FRTA state immediately
+   * \param path the snapshot file to write
+   * \param nodes the nodes whose state is saved
+   * \returns true if the snapshot was written
+   */
+  static bool WriteSnapshot(std::string path, NodeContainer nodes);
+
+  /**
+   * \brief Restore FRTA state from a warm-start snapshot
+   * \param path the snapshot file to read
+   * \param nodes the nodes to restore, matched to records by node id
+   * \returns true if the snapshot was valid and fully read
+   *
+   * Call after the stack is installed and before Simulator::Run(). The file
+   * is memory-mapped, and records of nodes not in the container are skipped.
+   * Entry ages are preserved, so restored routes expire as they would have
+   * in the run that took the snapshot.
+   */
+  static bool RestoreSnapshot(std::string path, NodeContainer nodes);
+
+  /**
+   * \brief Wait for a route before sending, e.g. from Application::StartApplication()
+   * \param node the sending node
+   * \param destination the destination to resolve
+   * \param callback invoked with the destination and whether a route is available
+   * \param timeout how long to wait for a route
+   * \returns true if the callback was invoked before returning
+   *
+   * An application can start its burst from the callback instead of probing
+   * while discovery runs:
+   * \code
+   *   FrtaRoutingHelper::ResolveRoute(GetNode(), m_peer,
+   *                                   MakeCallback(&MyApp::RouteResolved, this), Seconds(5));
+   * \endcode
+   * A node without FRTA has nothing to wait for; the callback is invoked at
+   * once with true.
+   */
+  static bool ResolveRoute(Ptr<Node> node, Ipv4Address destination,
+                           FrtaRoutingProtocol::RouteResolvedCallback callback, Time timeout);
+
+  /**
+   * \brief Make nodes receive the traffic of a multicast group
+   * \param nodes the members of the group
+   * \param group the multicast group
+   *
+   * Requires the Multicast attribute; nodes without FRTA are skipped.
+   */
+  static void JoinGroup(NodeContainer nodes, Ipv4Address group);
+
+  /**
+   * \brief Use fixed random variable streams on FRTA nodes
+   * \param nodes the nodes whose protocol is assigned streams
+   * \param stream first stream index to use
+   * \returns the number of stream indices assigned
+   *
+   * Nodes without FRTA are skipped. Call after Install().
+   */
+  static int64_t AssignStreams(NodeContainer nodes, int64_t stream);
+
+  /**
+   * \brief Dump the route cache of every FRTA node to a CSV file
+   * \param when the simulation time at which the dump is taken
+   * \param path the output file
+   *
+   * Rows are appended; the column header is written when the file is empty.
+   * Columns are time, node, destination, next hop, hops, trust, age,
+   * sequence number and next-hop collision probability.
+   */
+  static void DumpAllRoutes(Time when, std::string path);
+
+  /**
+   * \brief Dump the route cache of every FRTA node periodically
+   * \param start the simulation time of the first dump
+   * \param interval the interval between dumps
+   * \param path the output file
+   */
+  static void DumpAllRoutesEvery(Time start, Time interval, std::string path);
+
 private:
-  Time m_updateInterval;
+  static void DoDumpAllRoutes(std::string path);
+  static void DoDumpAllRoutesEvery(Time interval, std::string path);
+  static void DoWriteSnapshot(std::string path, NodeContainer nodes);
+
+  ObjectFactory m_agentFactory; //!< Factory for the routing protocol instances
+  bool m_controlQueueDisc;      //!< Install the control priority queue disc
+  double m_installDuration;     //!< Wall-clock duration of the last bulk install
 };
 
 } // namespace ns3
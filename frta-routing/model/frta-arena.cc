@@ -0,0 +1,112 @@
+#include "frta-arena.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaArena");
+
+FrtaArena::OverflowResource::OverflowResource()
+  : m_bytes(0),
+    m_overflows(0)
+{
+}
+
+void*
+FrtaArena::OverflowResource::do_allocate(size_t bytes, size_t alignment)
+{
+  m_bytes += bytes;
+  m_overflows++;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void
+FrtaArena::OverflowResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool
+FrtaArena::OverflowResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+
+FrtaArena::FrtaArena(size_t initialSize)
+  : m_buffer(initialSize),
+    m_depth(0)
+{
+  m_resource.reset(new std::pmr::monotonic_buffer_resource(m_buffer.data(), m_buffer.size(),
+                                                           &m_overflow));
+}
+
+std::pmr::memory_resource*
+FrtaArena::GetResource()
+{
+  return this;
+}
+
+void*
+FrtaArena::do_allocate(size_t bytes, size_t alignment)
+{
+  return m_resource->allocate(bytes, alignment);
+}
+
+void
+FrtaArena::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+  // Memory is reclaimed all at once by Reset()
+  m_resource->deallocate(p, bytes, alignment);
+}
+
+bool
+FrtaArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+  return this == &other;
+}
+
+void
+FrtaArena::Reset()
+{
+  if (m_overflow.m_bytes == 0)
+  {
+    m_resource->release();
+    return;
+  }
+
+  // Grow the buffer so the largest handler seen so far fits without overflowing
+  size_t size = m_buffer.size() + m_overflow.m_bytes;
+  NS_LOG_LOGIC("Growing scratch arena from " << m_buffer.size() << " to " << size << " bytes");
+  m_resource.reset();
+  m_overflow.m_bytes = 0;
+  m_buffer.assign(size, std::byte(0));
+  m_resource.reset(new std::pmr::monotonic_buffer_resource(m_buffer.data(), m_buffer.size(),
+                                                           &m_overflow));
+}
+
+size_t
+FrtaArena::GetCapacity() const
+{
+  return m_buffer.size();
+}
+
+uint64_t
+FrtaArena::GetOverflows() const
+{
+  return m_overflow.m_overflows;
+}
+
+FrtaArena::Scope::Scope(FrtaArena& arena)
+  : m_arena(arena)
+{
+  m_arena.m_depth++;
+}
+
+FrtaArena::Scope::~Scope()
+{
+  if (--m_arena.m_depth == 0)
+  {
+    m_arena.Reset();
+  }
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+#ifndef FRTA_ARENA_H
+#define FRTA_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Monotonic scratch arena for short-lived control plane temporaries
+ *
+ * Containers built on GetResource() only bump a pointer when they allocate
+ * and never free individually; the whole arena is released when the
+ * outermost Scope ends. Whenever a handler outgrows the initial buffer the
+ * overflow is taken from the heap and the buffer is enlarged on the next
+ * reset, so steady-state handlers stop touching the allocator.
+ */
+class FrtaArena : public std::pmr::memory_resource
+{
+public:
+  /**
+   * \param initialSize Size in bytes of the initial buffer
+   */
+  explicit FrtaArena(size_t initialSize = 4096);
+
+  /**
+   * \return the memory resource to build scratch containers on; it stays
+   * valid for the lifetime of the arena
+   */
+  std::pmr::memory_resource* GetResource();
+
+  /**
+   * \brief Release everything allocated from the arena
+   *
+   * Must not be called while scratch containers are alive; prefer Scope.
+   */
+  void Reset();
+
+  /**
+   * \return the current size in bytes of the initial buffer
+   */
+  size_t GetCapacity() const;
+
+  /**
+   * \return the number of allocations that overflowed to the heap
+   */
+  uint64_t GetOverflows() const;
+
+  /**
+   * \brief Marks a handler invocation; the arena is reset when the
+   * outermost scope ends, so nested handlers share the same scratch memory
+   */
+  class Scope
+  {
+  public:
+    explicit Scope(FrtaArena& arena);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    FrtaArena& m_arena;  //!< Arena released when the outermost scope ends
+  };
+
+private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+  /**
+   * \brief Heap upstream that records how much the arena overflowed
+   */
+  class OverflowResource : public std::pmr::memory_resource
+  {
+  public:
+    OverflowResource();
+    size_t m_bytes;       //!< Bytes allocated since the last reset
+    uint64_t m_overflows; //!< Total number of overflow allocations
+
+  private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+  };
+
+  std::vector<std::byte> m_buffer;                            //!< Initial buffer
+  OverflowResource m_overflow;                                //!< Upstream of the arena
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> m_resource;  //!< Bump allocator
+  uint32_t m_depth;                                           //!< Number of open scopes
+};
+
+} // namespace ns3
+
+#endif /* FRTA_ARENA_H */
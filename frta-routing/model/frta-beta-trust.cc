@@ -0,0 +1,107 @@
+#include "frta-beta-trust.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaBetaTrust");
+
+FrtaBetaTrust::FrtaBetaTrust()
+  : m_halfLife(Seconds(300))
+{
+}
+
+void
+FrtaBetaTrust::SetHalfLife(Time halfLife)
+{
+  m_halfLife = halfLife;
+}
+
+void
+FrtaBetaTrust::SetCapacity(uint32_t capacity, FrtaEvictionPolicy policy)
+{
+  m_evidence.SetEvictionPolicy(policy, [this](const Ipv4Address&, const Evidence& evidence) {
+    return (evidence.alpha + evidence.beta) * Decay(evidence.updated);
+  });
+  m_evidence.SetCapacity(capacity);
+}
+
+double
+FrtaBetaTrust::Decay(Time updated) const
+{
+  if (m_halfLife.IsZero())
+  {
+    return 1.0;
+  }
+  return std::exp2(-(Simulator::Now() - updated).GetSeconds() / m_halfLife.GetSeconds());
+}
+
+void
+FrtaBetaTrust::Observe(Ipv4Address peer, double positive, double negative)
+{
+  NS_LOG_FUNCTION(this << peer << positive << negative);
+  Evidence& evidence = m_evidence[peer];
+  double decay = Decay(evidence.updated);
+  evidence.alpha = evidence.alpha * decay + positive;
+  evidence.beta = evidence.beta * decay + negative;
+  evidence.updated = Simulator::Now();
+}
+
+void
+FrtaBetaTrust::GetEvidence(Ipv4Address peer, double& alpha, double& beta) const
+{
+  auto it = m_evidence.find(peer);
+  if (it == m_evidence.end())
+  {
+    alpha = 0;
+    beta = 0;
+    return;
+  }
+  double decay = Decay(it->second.updated);
+  alpha = it->second.alpha * decay;
+  beta = it->second.beta * decay;
+}
+
+double
+FrtaBetaTrust::GetExpectedTrust(Ipv4Address peer) const
+{
+  double alpha;
+  double beta;
+  GetEvidence(peer, alpha, beta);
+  return (alpha + 1) / (alpha + beta + 2);
+}
+
+double
+FrtaBetaTrust::GetConfidence(Ipv4Address peer) const
+{
+  double alpha;
+  double beta;
+  GetEvidence(peer, alpha, beta);
+  double a = alpha + 1;
+  double b = beta + 1;
+  double variance = a * b / ((a + b) * (a + b) * (a + b + 1));
+  return std::max(0.0, 1 - std::sqrt(12 * variance));
+}
+
+double
+FrtaBetaTrust::GetScore(Ipv4Address peer, double prior) const
+{
+  double confidence = GetConfidence(peer);
+  return confidence * GetExpectedTrust(peer) + (1 - confidence) * prior;
+}
+
+uint64_t
+FrtaBetaTrust::GetEvictions() const
+{
+  return m_evidence.GetEvictions();
+}
+
+void
+FrtaBetaTrust::Clear()
+{
+  m_evidence.clear();
+}
+
+} // namespace ns3
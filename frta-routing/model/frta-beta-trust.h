@@ -0,0 +1,92 @@
+#ifndef FRTA_BETA_TRUST_H
+#define FRTA_BETA_TRUST_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \brief Beta-reputation trust engine
+ *
+ * Keeps, per peer, the positive (alpha) and negative (beta) evidence
+ * observed about it. Evidence decays exponentially with a configurable
+ * half-life, so old behavior counts less than recent behavior. The
+ * expected trust is the mean of Beta(alpha + 1, beta + 1) and the
+ * confidence is 1 - sqrt(12 * variance), 0 for a peer without evidence
+ * and approaching 1 as evidence accumulates. Observations and queries
+ * are O(1); decay is applied lazily from the time of the last observation.
+ */
+class FrtaBetaTrust
+{
+public:
+  FrtaBetaTrust();
+
+  /**
+   * \param halfLife Time after which evidence counts half, 0 for no decay
+   */
+  void SetHalfLife(Time halfLife);
+
+  /**
+   * \param capacity Maximum number of peers, 0 for unbounded
+   * \param policy Eviction policy; the least valuable peer has the least evidence
+   */
+  void SetCapacity(uint32_t capacity, FrtaEvictionPolicy policy);
+
+  /**
+   * \brief Add evidence about a peer
+   * \param peer The peer observed
+   * \param positive Positive evidence, typically 1 for a success
+   * \param negative Negative evidence, typically 1 for a failure
+   */
+  void Observe(Ipv4Address peer, double positive, double negative);
+
+  /**
+   * \return the expected trust of a peer, 0.5 without evidence
+   */
+  double GetExpectedTrust(Ipv4Address peer) const;
+
+  /**
+   * \return the confidence in the expected trust of a peer, within [0, 1]
+   */
+  double GetConfidence(Ipv4Address peer) const;
+
+  /**
+   * \return the expected trust weighted by its confidence, falling back to
+   * a prior for peers with little evidence
+   */
+  double GetScore(Ipv4Address peer, double prior) const;
+
+  uint64_t GetEvictions() const;
+  void Clear();
+
+private:
+  /**
+   * \brief Evidence about one peer
+   */
+  struct Evidence
+  {
+    double alpha = 0;  //!< Positive evidence at the time of the last update
+    double beta = 0;   //!< Negative evidence at the time of the last update
+    Time updated;      //!< Time of the last update
+  };
+
+  /**
+   * \return the factor by which evidence decayed since an update
+   */
+  double Decay(Time updated) const;
+
+  /**
+   * \brief Get the decayed evidence of a peer, zero if unknown
+   */
+  void GetEvidence(Ipv4Address peer, double& alpha, double& beta) const;
+
+  FrtaBoundedMap<Ipv4Address, Evidence, Ipv4AddressHash> m_evidence;  //!< Evidence by peer
+  Time m_halfLife;                                                    //!< Evidence half-life
+};
+
+} // namespace ns3
+
+#endif /* FRTA_BETA_TRUST_H */
@@ -0,0 +1,250 @@
+#ifndef FRTA_BOUNDED_MAP_H
+#define FRTA_BOUNDED_MAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \brief Eviction policy of a FrtaBoundedMap
+ */
+enum FrtaEvictionPolicy
+{
+  FRTA_EVICT_LRU,            //!< Evict the least recently used entry
+  FRTA_EVICT_LEAST_VALUABLE  //!< Evict the entry with the lowest value score
+};
+
+/**
+ * \brief Hash map with an optional capacity and eviction policy
+ *
+ * Provides the subset of the std::unordered_map interface used by the FRTA
+ * state tables. Entries are kept in recency order: insertion, operator[]
+ * and non-const find() move an entry to the front. When an insertion makes
+ * the map exceed its capacity, one entry is evicted and counted: the least
+ * recently used one, or with FRTA_EVICT_LEAST_VALUABLE the lowest scoring
+ * of the few least recently used ones. Scoring only a sample keeps an
+ * insertion into a full map O(1); scores depend on the current time and
+ * change in place, so they could not be kept ordered in a heap anyway. A
+ * capacity of 0 leaves the map unbounded.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FrtaBoundedMap
+{
+public:
+  typedef std::pair<const Key, Value> value_type;
+  typedef typename std::list<value_type>::iterator iterator;
+  typedef typename std::list<value_type>::const_iterator const_iterator;
+  typedef std::function<double(const Key&, const Value&)> ValueFunction;
+
+  static const uint32_t DEFAULT_EVICTION_SAMPLES = 8;  //!< Entries scored per eviction
+
+  FrtaBoundedMap()
+    : m_capacity(0),
+      m_policy(FRTA_EVICT_LRU),
+      m_samples(DEFAULT_EVICTION_SAMPLES),
+      m_evictions(0)
+  {
+  }
+
+  /**
+   * \brief Set the maximum number of entries, evicting as needed
+   * \param capacity Maximum number of entries, 0 for unbounded
+   */
+  void SetCapacity(uint32_t capacity)
+  {
+    m_capacity = capacity;
+    while (m_capacity > 0 && m_items.size() > m_capacity)
+    {
+      Evict(m_items.end());
+    }
+  }
+
+  uint32_t GetCapacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * \brief Set the eviction policy
+   * \param policy The policy
+   * \param value Score of an entry, required for FRTA_EVICT_LEAST_VALUABLE
+   * \param samples Least recently used entries scored per eviction, at least 1
+   */
+  void SetEvictionPolicy(FrtaEvictionPolicy policy, ValueFunction value = ValueFunction(),
+                         uint32_t samples = DEFAULT_EVICTION_SAMPLES)
+  {
+    m_policy = policy;
+    m_value = value;
+    m_samples = std::max<uint32_t>(samples, 1);
+  }
+
+  /**
+   * \return the number of entries evicted so far
+   */
+  uint64_t GetEvictions() const
+  {
+    return m_evictions;
+  }
+
+  Value& operator[](const Key& key)
+  {
+    auto it = m_index.find(key);
+    if (it != m_index.end())
+    {
+      Touch(it->second);
+      return it->second->second;
+    }
+    m_items.emplace_front(key, Value());
+    m_index.emplace(key, m_items.begin());
+    iterator inserted = m_items.begin();
+    if (m_capacity > 0 && m_items.size() > m_capacity)
+    {
+      Evict(inserted);
+    }
+    return inserted->second;
+  }
+
+  iterator find(const Key& key)
+  {
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+      return m_items.end();
+    }
+    Touch(it->second);
+    return it->second;
+  }
+
+  const_iterator find(const Key& key) const
+  {
+    auto it = m_index.find(key);
+    return (it != m_index.end()) ? const_iterator(it->second) : m_items.end();
+  }
+
+  size_t count(const Key& key) const
+  {
+    return m_index.count(key);
+  }
+
+  size_t erase(const Key& key)
+  {
+    auto it = m_index.find(key);
+    if (it == m_index.end())
+    {
+      return 0;
+    }
+    m_items.erase(it->second);
+    m_index.erase(it);
+    return 1;
+  }
+
+  iterator erase(iterator pos)
+  {
+    m_index.erase(pos->first);
+    return m_items.erase(pos);
+  }
+
+  void clear()
+  {
+    m_items.clear();
+    m_index.clear();
+  }
+
+  void reserve(size_t n)
+  {
+    m_index.reserve(n);
+  }
+
+  size_t size() const
+  {
+    return m_items.size();
+  }
+
+  bool empty() const
+  {
+    return m_items.empty();
+  }
+
+  iterator begin()
+  {
+    return m_items.begin();
+  }
+
+  iterator end()
+  {
+    return m_items.end();
+  }
+
+  const_iterator begin() const
+  {
+    return m_items.begin();
+  }
+
+  const_iterator end() const
+  {
+    return m_items.end();
+  }
+
+private:
+  void Touch(iterator it)
+  {
+    m_items.splice(m_items.begin(), m_items, it);
+  }
+
+  /**
+   * \brief Evict one entry, never the one given as protected
+   * \param keep Entry that must survive, end() if none
+   */
+  void Evict(iterator keep)
+  {
+    iterator victim = std::prev(m_items.end());
+    if (victim == keep)
+    {
+      --victim;
+    }
+    if (m_policy == FRTA_EVICT_LEAST_VALUABLE && m_value)
+    {
+      // Score the least recently used entries only, walking from the back
+      double lowest = std::numeric_limits<double>::max();
+      uint32_t scored = 0;
+      for (iterator it = std::prev(m_items.end()); scored < m_samples; --it)
+      {
+        if (it != keep)
+        {
+          double value = m_value(it->first, it->second);
+          if (value < lowest)
+          {
+            lowest = value;
+            victim = it;
+          }
+          scored++;
+        }
+        if (it == m_items.begin())
+        {
+          break;
+        }
+      }
+    }
+    erase(victim);
+    m_evictions++;
+  }
+
+  std::list<value_type> m_items;                        //!< Entries, most recently used first
+  std::unordered_map<Key, iterator, Hash> m_index;      //!< Key to entry lookup
+  uint32_t m_capacity;                                  //!< Maximum entries, 0 for unbounded
+  FrtaEvictionPolicy m_policy;                          //!< Eviction policy
+  ValueFunction m_value;                                //!< Entry score for least-valuable eviction
+  uint32_t m_samples;                                   //!< Entries scored per least-valuable eviction
+  uint64_t m_evictions;                                 //!< Number of evicted entries
+};
+
+} // namespace ns3
+
+#endif /* FRTA_BOUNDED_MAP_H */
@@ -12,7 +12,8 @@ FrtaCollisionDetector::FrtaCollisionDetector()
     : m_collisionProbabilityCache(0.0),
       m_cacheValid(false),
       m_successCount(0),
-      m_totalCount(0)
+      m_totalCount(0),
+      m_scratch(std::pmr::get_default_resource())
 {
   NS_LOG_FUNCTION(this);
 }
@@ -29,21 +30,25 @@ FrtaCollisionDetector::DetectPotentialCollision(Ptr<const Packet> packet,
 {
   NS_LOG_FUNCTION(this << sender << receiver);
   
-  // Get transmission stats for sender
-  auto& senderStats = m_transmissionStats[sender];
+  // Check collision history for this link
+  auto linkIt = m_collisionCounts.find(std::make_pair(sender, receiver));
   
-  // Check if sender has transmitted too frequently
-  if (Simulator::Now() - senderStats.lastTransmission < MicroSeconds(100))
+  // If collision count is high, consider it risky
+  if (linkIt != m_collisionCounts.end() && linkIt->second > 5)
   {
     return true;
   }
   
-  // Check collision history for this link
-  auto linkPair = std::make_pair(sender, receiver);
-  auto collisionCount = m_collisionCounts[linkPair];
+  // Get transmission stats for sender
+  auto statsIt = m_transmissionStats.find(sender);
+  if (statsIt == m_transmissionStats.end())
+  {
+    return false;
+  }
+  const TransmissionStats& senderStats = statsIt->second;
   
-  // If collision count is high, consider it risky
-  if (collisionCount > 5)
+  // Check if sender has transmitted too frequently
+  if (Simulator::Now() - senderStats.lastTransmission < MicroSeconds(100))
   {
     return true;
   }
@@ -86,17 +91,18 @@ FrtaCollisionDetector::UpdateTransmissionStats(Ipv4Address sender, bool success)
   m_cacheValid = false;
 }
 
-std::vector<Ipv4Address>
-FrtaCollisionDetector::GetOptimalPath(const std::vector<std::vector<Ipv4Address>>& paths)
+FrtaPath
+FrtaCollisionDetector::GetOptimalPath(const FrtaPathList& paths)
 {
   NS_LOG_FUNCTION(this);
 
-  if (paths.empty())
+  if (paths.Empty())
   {
-    return std::vector<Ipv4Address>();
+    return FrtaPath();
   }
 
-  std::vector<double> pathProbabilities;
+  std::pmr::vector<double> pathProbabilities(m_scratch);
+  pathProbabilities.reserve(paths.Size());
   for (const auto& path : paths)
   {
     pathProbabilities.push_back(CalculatePathCollisionProbability(path));
@@ -129,12 +135,47 @@ FrtaCollisionDetector::GetCollisionProbability()
   return m_collisionProbabilityCache;
 }
 
+void
+FrtaCollisionDetector::SetMaxEntries(uint32_t maxEntries, FrtaEvictionPolicy policy)
+{
+  NS_LOG_FUNCTION(this << maxEntries << policy);
+  
+  // Least valuable entries are those backed by the fewest observations
+  m_transmissionStats.SetEvictionPolicy(policy, [](const Ipv4Address&, const TransmissionStats& stats) {
+    return static_cast<double>(stats.packetCount);
+  });
+  m_collisionCounts.SetEvictionPolicy(policy, [](const Link&, uint32_t count) {
+    return static_cast<double>(count);
+  });
+  m_transmissionStats.SetCapacity(maxEntries);
+  m_collisionCounts.SetCapacity(maxEntries);
+}
+
+uint64_t
+FrtaCollisionDetector::GetEvictions() const
+{
+  return m_transmissionStats.GetEvictions() + m_collisionCounts.GetEvictions();
+}
+
+void
+FrtaCollisionDetector::SetScratchResource(std::pmr::memory_resource* resource)
+{
+  m_scratch = resource;
+}
+
+double
+FrtaCollisionDetector::GetLinkCollisionProbability(Ipv4Address node) const
+{
+  auto it = m_transmissionStats.find(node);
+  return (it != m_transmissionStats.end()) ? it->second.collisionProbability : 0.0;
+}
+
 double
-FrtaCollisionDetector::CalculatePathCollisionProbability(const std::vector<Ipv4Address>& path)
+FrtaCollisionDetector::CalculatePathCollisionProbability(const FrtaPath& path)
 {
   NS_LOG_FUNCTION(this);
 
-  if (path.empty())
+  if (path.Empty())
   {
     return 1.0; // Empty path has 100% collision probability
   }
@@ -142,10 +183,66 @@ FrtaCollisionDetector::CalculatePathCollisionProbability(const std::vector<Ipv4A
   // Basic implementation: probability increases with path length
   // More sophisticated implementations could consider node density, traffic patterns, etc.
   double baseProb = GetCollisionProbability();
-  double pathLength = static_cast<double>(path.size());
+  double pathLength = static_cast<double>(path.Size());
   
   // Collision probability increases with path length but is capped at 1.0
   return std::min(1.0, baseProb * (1.0 + std::log(pathLength)));
 }
 
+void
+FrtaCollisionDetector::SaveState(FrtaSnapshotWriter& writer) const
+{
+  NS_LOG_FUNCTION(this);
+
+  writer.WriteU32(m_successCount);
+  writer.WriteU32(m_totalCount);
+
+  writer.WriteU32(m_transmissionStats.size());
+  for (const auto& entry : m_transmissionStats)
+  {
+    writer.WriteAddress(entry.first);
+    writer.WriteAge(entry.second.lastTransmission);
+    writer.WriteU32(entry.second.packetCount);
+    writer.WriteDouble(entry.second.collisionProbability);
+  }
+
+  writer.WriteU32(m_collisionCounts.size());
+  for (const auto& entry : m_collisionCounts)
+  {
+    writer.WriteAddress(entry.first.first);
+    writer.WriteAddress(entry.first.second);
+    writer.WriteU32(entry.second);
+  }
+}
+
+bool
+FrtaCollisionDetector::RestoreState(FrtaSnapshotReader& reader)
+{
+  NS_LOG_FUNCTION(this);
+
+  m_successCount = reader.ReadU32();
+  m_totalCount = reader.ReadU32();
+  m_cacheValid = false;
+
+  uint32_t nStats = reader.ReadU32();
+  for (uint32_t i = 0; i < nStats && reader.IsOk(); i++)
+  {
+    Ipv4Address sender = reader.ReadAddress();
+    TransmissionStats& stats = m_transmissionStats[sender];
+    stats.lastTransmission = reader.ReadAge();
+    stats.packetCount = reader.ReadU32();
+    stats.collisionProbability = reader.ReadDouble();
+  }
+
+  uint32_t nLinks = reader.ReadU32();
+  for (uint32_t i = 0; i < nLinks && reader.IsOk(); i++)
+  {
+    Ipv4Address sender = reader.ReadAddress();
+    Ipv4Address receiver = reader.ReadAddress();
+    m_collisionCounts[std::make_pair(sender, receiver)] = reader.ReadU32();
+  }
+
+  return reader.IsOk();
+}
+
 } // namespace ns3 
\ No newline at end of file
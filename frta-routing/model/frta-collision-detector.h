@@ -5,8 +5,12 @@
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
+#include "frta-snapshot.h"
+#include "frta-bounded-map.h"
+#include "frta-path.h"
 #include <vector>
 #include <map>
+#include <memory_resource>
 
 namespace ns3 {
 
@@ -29,10 +33,10 @@ public:
 
   /**
    * \brief Get the optimal path from available paths based on collision probability
-   * \param paths Vector of available paths, where each path is a vector of IPv4 addresses
+   * \param paths Available paths to the same destination
    * \return The optimal path with minimum collision probability
    */
-  std::vector<Ipv4Address> GetOptimalPath(const std::vector<std::vector<Ipv4Address>>& paths);
+  FrtaPath GetOptimalPath(const FrtaPathList& paths);
 
   /**
    * \brief Update transmission statistics
@@ -47,6 +51,13 @@ public:
    */
   double GetCollisionProbability();
 
+  /**
+   * \brief Get the collision probability estimated for transmissions of one node
+   * \param node The node address
+   * \return Collision probability as a value between 0 and 1, 0 if unknown
+   */
+  double GetLinkCollisionProbability(Ipv4Address node) const;
+
   /**
    * \brief Detect potential collision for a packet transmission
    * \param packet The packet to be transmitted
@@ -58,18 +69,50 @@ public:
                                Ipv4Address sender,
                                Ipv4Address receiver);
 
+  /**
+   * \brief Append the collision statistics to a warm-start snapshot
+   * \param writer The snapshot being built
+   */
+  void SaveState(FrtaSnapshotWriter& writer) const;
+
+  /**
+   * \brief Restore collision statistics from a warm-start snapshot
+   * \param reader The snapshot being read
+   * \return true if the statistics were read completely
+   */
+  bool RestoreState(FrtaSnapshotReader& reader);
+
+  /**
+   * \brief Bound the per-node and per-link statistics tables
+   * \param maxEntries Maximum entries per table, 0 for unbounded
+   * \param policy Which entry to evict when a table is full
+   */
+  void SetMaxEntries(uint32_t maxEntries, FrtaEvictionPolicy policy);
+
+  /**
+   * \return the number of statistics entries evicted so far
+   */
+  uint64_t GetEvictions() const;
+
+  /**
+   * \brief Set the memory resource used for scratch containers during path scoring
+   * \param resource The resource, typically a per-protocol FrtaArena
+   */
+  void SetScratchResource(std::pmr::memory_resource* resource);
+
 private:
   /**
    * \brief Calculate collision probability for a specific path
-   * \param path Vector of IPv4 addresses representing the path
+   * \param path The path
    * \return Collision probability for the path
    */
-  double CalculatePathCollisionProbability(const std::vector<Ipv4Address>& path);
+  double CalculatePathCollisionProbability(const FrtaPath& path);
 
   double m_collisionProbabilityCache; //!< Cached collision probability
   bool m_cacheValid;                  //!< Whether the cache is valid
   uint32_t m_successCount;            //!< Number of successful transmissions
   uint32_t m_totalCount;              //!< Total number of transmission attempts
+  std::pmr::memory_resource* m_scratch; //!< Resource for scratch containers
 
   // New members for transmission statistics
   struct TransmissionStats {
@@ -77,8 +120,15 @@ private:
     uint32_t packetCount;
     double collisionProbability;
   };
-  std::map<Ipv4Address, TransmissionStats> m_transmissionStats;
-  std::map<std::pair<Ipv4Address, Ipv4Address>, uint32_t> m_collisionCounts;
+  typedef std::pair<Ipv4Address, Ipv4Address> Link;
+  struct LinkHash {
+    size_t operator()(const Link& link) const
+    {
+      return (static_cast<size_t>(link.first.Get()) << 32) ^ link.second.Get();
+    }
+  };
+  FrtaBoundedMap<Ipv4Address, TransmissionStats, Ipv4AddressHash> m_transmissionStats;
+  FrtaBoundedMap<Link, uint32_t, LinkHash> m_collisionCounts;
 };
 
 } // namespace ns3
@@ -0,0 +1,303 @@
+#include "frta-dtn.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4-header.h"
+#include "frta-fingerprint-cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaDtn");
+
+//-----------------------------------------------------------------------------
+// FrtaBundleStore
+//-----------------------------------------------------------------------------
+
+FrtaBundleStore::FrtaBundleStore()
+  : m_capacity(256),
+    m_dropped(0)
+{
+}
+
+void
+FrtaBundleStore::SetCapacity(uint32_t capacity)
+{
+  m_capacity = capacity;
+}
+
+void
+FrtaBundleStore::Add(const FrtaBundle& bundle)
+{
+  NS_LOG_FUNCTION(this << bundle.destination);
+  
+  // Neighbors acknowledge custody by the fingerprint of the packet; a bundle
+  // offered again after a lost acknowledgement is already held
+  Ipv4Header header;
+  bundle.packet->PeekHeader(header);
+  uint64_t id = FrtaFingerprintCache::Fingerprint(header);
+  if (std::any_of(m_bundles.begin(), m_bundles.end(),
+                  [id](const FrtaBundle& held) { return held.id == id; }))
+  {
+    return;
+  }
+  if (m_capacity > 0 && m_bundles.size() >= m_capacity)
+  {
+    auto victim = std::min_element(m_bundles.begin(), m_bundles.end(),
+                                   [](const FrtaBundle& a, const FrtaBundle& b)
+                                   { return a.expires < b.expires; });
+    if (victim->expires > bundle.expires)
+    {
+      NS_LOG_LOGIC("Store full, dropping new bundle for " << bundle.destination);
+      m_dropped++;
+      return;
+    }
+    NS_LOG_LOGIC("Store full, dropping bundle for " << victim->destination);
+    *victim = m_bundles.back();
+    m_bundles.pop_back();
+    m_dropped++;
+  }
+  m_bundles.push_back(bundle);
+  m_bundles.back().id = id;
+  m_bundles.back().offerExpires = Time();
+}
+
+uint32_t
+FrtaBundleStore::Expire()
+{
+  Time now = Simulator::Now();
+  auto end = std::remove_if(m_bundles.begin(), m_bundles.end(),
+                            [now](const FrtaBundle& bundle) { return bundle.expires <= now; });
+  uint32_t expired = m_bundles.end() - end;
+  m_bundles.erase(end, m_bundles.end());
+  return expired;
+}
+
+std::vector<FrtaBundle>
+FrtaBundleStore::TakeIf(std::function<bool(const FrtaBundle&)> predicate)
+{
+  std::vector<FrtaBundle> taken;
+  auto end = std::stable_partition(m_bundles.begin(), m_bundles.end(),
+                                   [&predicate](const FrtaBundle& bundle)
+                                   { return !predicate(bundle); });
+  taken.assign(end, m_bundles.end());
+  m_bundles.erase(end, m_bundles.end());
+  return taken;
+}
+
+std::vector<FrtaBundle>
+FrtaBundleStore::Offer(std::function<bool(const FrtaBundle&)> predicate, Ipv4Address neighbor,
+                       Time until)
+{
+  Time now = Simulator::Now();
+  std::vector<FrtaBundle> offered;
+  for (auto& bundle : m_bundles)
+  {
+    if (bundle.offerExpires <= now && predicate(bundle))
+    {
+      bundle.offeredTo = neighbor;
+      bundle.offerExpires = until;
+      offered.push_back(bundle);
+    }
+  }
+  return offered;
+}
+
+bool
+FrtaBundleStore::Release(uint64_t id, Ipv4Address neighbor)
+{
+  // A late acceptance still releases the bundle: the neighbor holds it
+  auto it = std::find_if(m_bundles.begin(), m_bundles.end(),
+                         [id, neighbor](const FrtaBundle& bundle)
+                         { return bundle.id == id && bundle.offeredTo == neighbor; });
+  if (it == m_bundles.end())
+  {
+    return false;
+  }
+  *it = m_bundles.back();
+  m_bundles.pop_back();
+  return true;
+}
+
+uint32_t
+FrtaBundleStore::GetN() const
+{
+  return m_bundles.size();
+}
+
+uint64_t
+FrtaBundleStore::GetDropped() const
+{
+  return m_dropped;
+}
+
+void
+FrtaBundleStore::Clear()
+{
+  m_bundles.clear();
+}
+
+void
+FrtaBundleStore::SaveState(FrtaSnapshotWriter& writer) const
+{
+  Time now = Simulator::Now();
+  writer.WriteU32(m_bundles.size());
+  std::vector<uint8_t> bytes;
+  for (const auto& bundle : m_bundles)
+  {
+    bytes.resize(bundle.packet->GetSize());
+    bundle.packet->CopyData(bytes.data(), bytes.size());
+    writer.WriteAddress(bundle.destination);
+    writer.WriteU64(std::max<int64_t>(0, (bundle.expires - now).GetNanoSeconds()));
+    writer.WriteU32(bundle.custody);
+    writer.WriteBytes(bytes.data(), bytes.size());
+  }
+}
+
+bool
+FrtaBundleStore::RestoreState(FrtaSnapshotReader& reader)
+{
+  Time now = Simulator::Now();
+  uint32_t nBundles = reader.ReadU32();
+  for (uint32_t i = 0; i < nBundles && reader.IsOk(); i++)
+  {
+    FrtaBundle bundle;
+    bundle.destination = reader.ReadAddress();
+    bundle.expires = now + NanoSeconds(reader.ReadU64());
+    bundle.custody = reader.ReadU32();
+    std::vector<uint8_t> bytes = reader.ReadBytes();
+    if (!reader.IsOk())
+    {
+      break;
+    }
+    bundle.packet = Create<Packet>(bytes.data(), bytes.size());
+    Add(bundle);
+  }
+  return reader.IsOk();
+}
+
+//-----------------------------------------------------------------------------
+// FrtaDeliveryPredictability
+//-----------------------------------------------------------------------------
+
+constexpr double FrtaDeliveryPredictability::P_INIT;
+constexpr double FrtaDeliveryPredictability::BETA;
+constexpr double FrtaDeliveryPredictability::GAMMA;
+
+FrtaDeliveryPredictability::FrtaDeliveryPredictability()
+  : m_agingUnit(Seconds(1))
+{
+  m_predictability.SetCapacity(256);
+  m_predictability.SetEvictionPolicy(FRTA_EVICT_LEAST_VALUABLE,
+                                     [](const Ipv4Address&, const double& p) { return p; });
+}
+
+void
+FrtaDeliveryPredictability::SetSelf(Ipv4Address self)
+{
+  m_self = self;
+}
+
+void
+FrtaDeliveryPredictability::SetAgingUnit(Time unit)
+{
+  m_agingUnit = unit;
+}
+
+void
+FrtaDeliveryPredictability::SetCapacity(uint32_t capacity)
+{
+  m_predictability.SetCapacity(capacity);
+}
+
+void
+FrtaDeliveryPredictability::Encounter(Ipv4Address neighbor)
+{
+  Age();
+  double& p = m_predictability[neighbor];
+  p += (1 - p) * P_INIT;
+  NS_LOG_LOGIC("Encountered " << neighbor << ", predictability " << p);
+}
+
+void
+FrtaDeliveryPredictability::Transit(Ipv4Address neighbor,
+                                    const DeliveryPredictabilityHeader& beacon)
+{
+  double pNeighbor = Get(neighbor);
+  for (uint32_t i = 0; i < beacon.GetNEntries(); i++)
+  {
+    Ipv4Address destination = beacon.GetDestination(i);
+    if (destination == m_self || destination == neighbor)
+    {
+      continue;
+    }
+    double transitive = pNeighbor * beacon.GetPredictability(i) * BETA;
+    auto it = m_predictability.find(destination);
+    if (it == m_predictability.end())
+    {
+      m_predictability[destination] = transitive;
+    }
+    else if (transitive > it->second)
+    {
+      it->second = transitive;
+    }
+  }
+}
+
+void
+FrtaDeliveryPredictability::Age()
+{
+  Time now = Simulator::Now();
+  if (m_agingUnit.IsZero() || now - m_lastAged < m_agingUnit)
+  {
+    return;
+  }
+  double units = (now - m_lastAged).GetSeconds() / m_agingUnit.GetSeconds();
+  double factor = std::pow(GAMMA, units);
+  for (auto& entry : m_predictability)
+  {
+    entry.second *= factor;
+  }
+  m_lastAged = now;
+}
+
+double
+FrtaDeliveryPredictability::Get(Ipv4Address destination) const
+{
+  auto it = m_predictability.find(destination);
+  return it != m_predictability.end() ? it->second : 0.0;
+}
+
+void
+FrtaDeliveryPredictability::Fill(DeliveryPredictabilityHeader& beacon) const
+{
+  std::vector<std::pair<double, Ipv4Address>> entries;
+  entries.reserve(m_predictability.size());
+  for (const auto& entry : m_predictability)
+  {
+    entries.emplace_back(entry.second, entry.first);
+  }
+  uint32_t n = std::min<uint32_t>(entries.size(), DeliveryPredictabilityHeader::MAX_ENTRIES);
+  std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                    [](const std::pair<double, Ipv4Address>& a,
+                       const std::pair<double, Ipv4Address>& b)
+                    { return a.first > b.first; });
+  for (uint32_t i = 0; i < n; i++)
+  {
+    beacon.AddEntry(entries[i].second, entries[i].first);
+  }
+}
+
+uint32_t
+FrtaDeliveryPredictability::GetN() const
+{
+  return m_predictability.size();
+}
+
+void
+FrtaDeliveryPredictability::Clear()
+{
+  m_predictability.clear();
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+#ifndef FRTA_DTN_H
+#define FRTA_DTN_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include "frta-routing-header.h"
+#include "frta-snapshot.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Counters of the delay-tolerant layer
+ */
+struct FrtaDtnStats
+{
+  uint64_t stored = 0;     //!< Packets taken into the bundle store
+  uint64_t handedOff = 0;  //!< Bundles whose custody an encountered neighbor accepted
+  uint64_t released = 0;   //!< Bundles delivered or sent once a route appeared
+  uint64_t expired = 0;    //!< Bundles dropped when their lifetime ran out
+  uint64_t dropped = 0;    //!< Bundles evicted from a full store
+};
+
+/**
+ * \brief A packet held by the delay-tolerant layer
+ */
+struct FrtaBundle
+{
+  Ptr<Packet> packet;                     //!< The packet, with its IPv4 header
+  Ipv4Address destination;                //!< Final destination
+  Time expires;                           //!< Time after which the bundle is dropped
+  uint32_t custody;                       //!< Custody transfers so far
+  uint64_t id = 0;                        //!< Fingerprint of the packet, set by the store
+  Ipv4Address offeredTo = Ipv4Address();  //!< Neighbor the bundle was last offered to
+  Time offerExpires = Seconds(0);         //!< Time until which the offer awaits acceptance
+};
+
+/**
+ * \brief Bounded store of the bundles a node carries
+ *
+ * When the store is full, the bundle closest to expiry is dropped to make
+ * room. A bundle handed to a neighbor stays in the store until the neighbor
+ * accepts custody of it, and is offered again if it does not. The store can
+ * be saved to and restored from a snapshot, so that bundles survive a warm
+ * restart.
+ */
+class FrtaBundleStore
+{
+public:
+  FrtaBundleStore();
+
+  /**
+   * \param capacity Maximum number of bundles, 0 for unbounded
+   */
+  void SetCapacity(uint32_t capacity);
+
+  /**
+   * \brief Store a bundle, dropping the one closest to expiry if full
+   */
+  void Add(const FrtaBundle& bundle);
+
+  /**
+   * \brief Drop the bundles whose lifetime ran out
+   * \return the number of bundles dropped
+   */
+  uint32_t Expire();
+
+  /**
+   * \brief Remove and return the bundles accepted by a predicate
+   */
+  std::vector<FrtaBundle> TakeIf(std::function<bool(const FrtaBundle&)> predicate);
+
+  /**
+   * \brief Offer the bundles accepted by a predicate to a neighbor
+   * \param until Time until which the neighbor may accept custody
+   * \return copies of the bundles offered
+   *
+   * Bundles with an offer still pending are not offered again.
+   */
+  std::vector<FrtaBundle> Offer(std::function<bool(const FrtaBundle&)> predicate,
+                                Ipv4Address neighbor, Time until);
+
+  /**
+   * \brief Remove a bundle whose custody a neighbor accepted
+   * \return true if the bundle was held and offered to that neighbor
+   */
+  bool Release(uint64_t id, Ipv4Address neighbor);
+
+  uint32_t GetN() const;
+
+  /**
+   * \return the number of bundles dropped to make room
+   */
+  uint64_t GetDropped() const;
+
+  void Clear();
+
+  void SaveState(FrtaSnapshotWriter& writer) const;
+  bool RestoreState(FrtaSnapshotReader& reader);
+
+private:
+  std::vector<FrtaBundle> m_bundles;  //!< Stored bundles
+  uint32_t m_capacity;                //!< Maximum number of bundles
+  uint64_t m_dropped;                 //!< Bundles dropped to make room
+};
+
+/**
+ * \brief PRoPHET delivery predictabilities of one node
+ *
+ * The predictability of meeting a node grows with each encounter, decays
+ * with time, and is inherited transitively from the predictabilities of
+ * encountered neighbors.
+ */
+class FrtaDeliveryPredictability
+{
+public:
+  static constexpr double P_INIT = 0.75;  //!< Encounter increment
+  static constexpr double BETA = 0.25;    //!< Transitivity scaling
+  static constexpr double GAMMA = 0.98;   //!< Aging factor per time unit
+
+  FrtaDeliveryPredictability();
+
+  /**
+   * \param self The address of this node, never stored
+   */
+  void SetSelf(Ipv4Address self);
+
+  /**
+   * \param unit Time after which predictabilities decay by GAMMA
+   */
+  void SetAgingUnit(Time unit);
+
+  /**
+   * \param capacity Maximum number of destinations, 0 for unbounded
+   */
+  void SetCapacity(uint32_t capacity);
+
+  /**
+   * \brief Update the predictability of a neighbor just encountered
+   */
+  void Encounter(Ipv4Address neighbor);
+
+  /**
+   * \brief Inherit predictabilities through a neighbor from its beacon
+   */
+  void Transit(Ipv4Address neighbor, const DeliveryPredictabilityHeader& beacon);
+
+  /**
+   * \brief Decay all predictabilities by the time elapsed since the last call
+   */
+  void Age();
+
+  /**
+   * \return the predictability of delivering to a destination
+   */
+  double Get(Ipv4Address destination) const;
+
+  /**
+   * \brief Fill a beacon with the highest predictabilities
+   */
+  void Fill(DeliveryPredictabilityHeader& beacon) const;
+
+  uint32_t GetN() const;
+  void Clear();
+
+private:
+  FrtaBoundedMap<Ipv4Address, double, Ipv4AddressHash> m_predictability;  //!< Predictability by destination
+  Ipv4Address m_self;                                                     //!< Address of this node
+  Time m_agingUnit;                                                       //!< Time unit of GAMMA
+  Time m_lastAged;                                                        //!< Time of the last Age()
+};
+
+} // namespace ns3
+
+#endif /* FRTA_DTN_H */
@@ -0,0 +1,81 @@
+#include "frta-fingerprint-cache.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaFingerprintCache");
+
+FrtaFingerprintCache::FrtaFingerprintCache()
+  : m_lifetime(Seconds(3)),
+    m_duplicates(0)
+{
+  m_seen.SetCapacity(1024);
+}
+
+uint64_t
+FrtaFingerprintCache::Fingerprint(const Ipv4Header& header)
+{
+  // FNV-1a over the fields that identify a packet end to end
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  uint64_t fields[] = {header.GetSource().Get(), header.GetDestination().Get(),
+                       header.GetProtocol(), header.GetIdentification(),
+                       header.GetFragmentOffset()};
+  for (uint64_t field : fields)
+  {
+    hash = (hash ^ field) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void
+FrtaFingerprintCache::SetLifetime(Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+void
+FrtaFingerprintCache::SetCapacity(uint32_t capacity)
+{
+  m_seen.SetCapacity(capacity);
+}
+
+bool
+FrtaFingerprintCache::Contains(uint64_t fingerprint) const
+{
+  auto it = m_seen.find(fingerprint);
+  return it != m_seen.end() && Simulator::Now() - it->second < m_lifetime;
+}
+
+bool
+FrtaFingerprintCache::Insert(uint64_t fingerprint)
+{
+  if (Contains(fingerprint))
+  {
+    NS_LOG_LOGIC("Duplicate packet " << fingerprint);
+    m_duplicates++;
+    return false;
+  }
+  m_seen[fingerprint] = Simulator::Now();
+  return true;
+}
+
+uint32_t
+FrtaFingerprintCache::GetN() const
+{
+  return m_seen.size();
+}
+
+uint64_t
+FrtaFingerprintCache::GetDuplicates() const
+{
+  return m_duplicates;
+}
+
+void
+FrtaFingerprintCache::Clear()
+{
+  m_seen.clear();
+}
+
+} // namespace ns3
@@ -0,0 +1,63 @@
+#ifndef FRTA_FINGERPRINT_CACHE_H
+#define FRTA_FINGERPRINT_CACHE_H
+
+#include "ns3/ipv4-header.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \brief Remembers recently seen data packets to suppress duplicates
+ *
+ * Packets are identified by a fingerprint of the IPv4 header fields that
+ * stay the same along the path. A fingerprint is forgotten after its
+ * lifetime, or earlier when the cache is full.
+ */
+class FrtaFingerprintCache
+{
+public:
+  FrtaFingerprintCache();
+
+  /**
+   * \return the fingerprint of a packet, from its source, destination,
+   * protocol, identification and fragment offset
+   */
+  static uint64_t Fingerprint(const Ipv4Header& header);
+
+  /**
+   * \param lifetime Time for which a fingerprint is remembered
+   */
+  void SetLifetime(Time lifetime);
+
+  /**
+   * \param capacity Maximum number of fingerprints, 0 for unbounded
+   */
+  void SetCapacity(uint32_t capacity);
+
+  /**
+   * \return true if the fingerprint was seen within its lifetime
+   */
+  bool Contains(uint64_t fingerprint) const;
+
+  /**
+   * \brief Record a fingerprint
+   * \return true if it was not seen within its lifetime, false if the
+   * packet is a duplicate
+   */
+  bool Insert(uint64_t fingerprint);
+
+  uint32_t GetN() const;
+  uint64_t GetDuplicates() const;
+  void Clear();
+
+private:
+  FrtaBoundedMap<uint64_t, Time> m_seen;  //!< Time each fingerprint was first seen
+  Time m_lifetime;                        //!< Time a fingerprint is remembered
+  uint64_t m_duplicates;                  //!< Duplicates reported by Insert()
+};
+
+} // namespace ns3
+
+#endif /* FRTA_FINGERPRINT_CACHE_H */
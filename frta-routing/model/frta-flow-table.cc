@@ -0,0 +1,186 @@
+#include "frta-flow-table.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaFlowTable");
+
+FrtaFlowTable::FrtaFlowTable()
+  : m_flowletGap(MilliSeconds(50)),
+    m_idleTimeout(Seconds(10)),
+    m_repins(0)
+{
+}
+
+uint64_t
+FrtaFlowTable::HashFlow(Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                        uint16_t sourcePort, uint16_t destinationPort)
+{
+  // FNV-1a over the tuple fields
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  uint64_t fields[] = {source.Get(), destination.Get(), protocol, sourcePort, destinationPort};
+  for (uint64_t field : fields)
+  {
+    hash = (hash ^ field) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void
+FrtaFlowTable::SetFlowletGap(Time gap)
+{
+  m_flowletGap = gap;
+}
+
+void
+FrtaFlowTable::SetIdleTimeout(Time timeout)
+{
+  m_idleTimeout = timeout;
+}
+
+void
+FrtaFlowTable::SetMaxEntries(uint32_t maxEntries)
+{
+  m_flows.SetCapacity(maxEntries);
+}
+
+Ipv4Address
+FrtaFlowTable::SelectLeastLoaded(const Ipv4Address* candidates, uint32_t nCandidates) const
+{
+  Ipv4Address best = candidates[0];
+  uint64_t bestBytes = GetNextHopBytes(best);
+  for (uint32_t i = 1; i < nCandidates; i++)
+  {
+    uint64_t bytes = GetNextHopBytes(candidates[i]);
+    if (bytes < bestBytes)
+    {
+      best = candidates[i];
+      bestBytes = bytes;
+    }
+  }
+  return best;
+}
+
+Ipv4Address
+FrtaFlowTable::Select(uint64_t flow, uint32_t bytes, const Ipv4Address* candidates,
+                      uint32_t nCandidates)
+{
+  NS_ASSERT(nCandidates > 0);
+  Time now = Simulator::Now();
+
+  auto it = m_flows.find(flow);
+  if (it == m_flows.end())
+  {
+    FrtaFlowEntry& entry = m_flows[flow];
+    entry.nextHop = SelectLeastLoaded(candidates, nCandidates);
+    entry.bytes = 0;
+    entry.packets = 0;
+    entry.repins = 0;
+    it = m_flows.find(flow);
+  }
+  else
+  {
+    FrtaFlowEntry& entry = it->second;
+    bool usable = false;
+    for (uint32_t i = 0; i < nCandidates && !usable; i++)
+    {
+      usable = candidates[i] == entry.nextHop;
+    }
+    if (!usable || now - entry.lastSeen > m_flowletGap)
+    {
+      Ipv4Address nextHop = SelectLeastLoaded(candidates, nCandidates);
+      if (nextHop != entry.nextHop)
+      {
+        NS_LOG_LOGIC("Flow " << flow << " moves from " << entry.nextHop << " to " << nextHop
+                     << (usable ? " after a flowlet gap" : " after a path failure"));
+        entry.nextHop = nextHop;
+        entry.repins++;
+        m_repins++;
+      }
+    }
+  }
+
+  FrtaFlowEntry& entry = it->second;
+  entry.lastSeen = now;
+  entry.bytes += bytes;
+  entry.packets++;
+  FrtaNextHopLoad& load = m_nextHopLoads[entry.nextHop];
+  load.bytes = GetDecayedBytes(load, now) + bytes;
+  load.lastUpdate = now;
+  return entry.nextHop;
+}
+
+void
+FrtaFlowTable::Expire()
+{
+  Time now = Simulator::Now();
+  for (auto it = m_flows.begin(); it != m_flows.end();)
+  {
+    if (now - it->second.lastSeen > m_idleTimeout)
+    {
+      it = m_flows.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  for (auto it = m_nextHopLoads.begin(); it != m_nextHopLoads.end();)
+  {
+    if (GetDecayedBytes(it->second, now) < 1)
+    {
+      it = m_nextHopLoads.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+const FrtaFlowEntry*
+FrtaFlowTable::Find(uint64_t flow) const
+{
+  auto it = m_flows.find(flow);
+  return (it != m_flows.end()) ? &it->second : nullptr;
+}
+
+uint64_t
+FrtaFlowTable::GetNextHopBytes(Ipv4Address nextHop) const
+{
+  auto it = m_nextHopLoads.find(nextHop);
+  return (it != m_nextHopLoads.end()) ? GetDecayedBytes(it->second, Simulator::Now()) : 0;
+}
+
+double
+FrtaFlowTable::GetDecayedBytes(const FrtaNextHopLoad& load, Time now) const
+{
+  if (m_idleTimeout.IsZero())
+  {
+    return load.bytes;
+  }
+  return load.bytes * std::exp2(-(now - load.lastUpdate).GetSeconds() / m_idleTimeout.GetSeconds());
+}
+
+uint32_t
+FrtaFlowTable::GetNFlows() const
+{
+  return m_flows.size();
+}
+
+uint64_t
+FrtaFlowTable::GetRepins() const
+{
+  return m_repins;
+}
+
+void
+FrtaFlowTable::Clear()
+{
+  m_flows.clear();
+  m_nextHopLoads.clear();
+}
+
+} // namespace ns3
@@ -0,0 +1,117 @@
+#ifndef FRTA_FLOW_TABLE_H
+#define FRTA_FLOW_TABLE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include <cstdint>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \brief State of one flow pinned to a next hop
+ */
+struct FrtaFlowEntry
+{
+  Ipv4Address nextHop;  //!< Next hop the flow is pinned to
+  Time lastSeen;        //!< Time of the last packet of the flow
+  uint64_t bytes;       //!< Bytes sent by the flow
+  uint32_t packets;     //!< Packets sent by the flow
+  uint32_t repins;      //!< Number of times the flow moved to another next hop
+};
+
+/**
+ * \brief Recent load carried through one next hop
+ */
+struct FrtaNextHopLoad
+{
+  double bytes;      //!< Bytes sent, decayed to lastUpdate
+  Time lastUpdate;   //!< Time bytes was last decayed
+};
+
+/**
+ * \brief Pins flows to next hops so that multipath forwarding does not
+ * reorder packets within a flow
+ *
+ * Flows are identified by a hash of their 5-tuple. A flow keeps its next
+ * hop for its lifetime and only moves when that next hop stops being a
+ * usable candidate, or when the flow has been idle longer than the flowlet
+ * gap, so that packets sent after the gap cannot overtake earlier ones on
+ * a faster path. A flow that moves, or a new flow, goes to the candidate
+ * that has carried the fewest bytes recently: the load of a next hop
+ * halves every idle timeout. Idle flows and unloaded next hops age out.
+ */
+class FrtaFlowTable
+{
+public:
+  FrtaFlowTable();
+
+  /**
+   * \brief Hash a 5-tuple into a flow identifier
+   */
+  static uint64_t HashFlow(Ipv4Address source, Ipv4Address destination, uint8_t protocol,
+                           uint16_t sourcePort, uint16_t destinationPort);
+
+  /**
+   * \param gap Idle time after which a flow may move to another next hop;
+   * should exceed the delay difference between the paths
+   */
+  void SetFlowletGap(Time gap);
+
+  /**
+   * \param timeout Idle time after which a flow entry is removed, also the
+   * half-life of the load of a next hop
+   */
+  void SetIdleTimeout(Time timeout);
+
+  /**
+   * \param maxEntries Maximum number of flows, 0 for unbounded
+   */
+  void SetMaxEntries(uint32_t maxEntries);
+
+  /**
+   * \brief Select the next hop for a packet and account for it
+   * \param flow Flow identifier from HashFlow()
+   * \param bytes Size of the packet
+   * \param candidates Usable next hops, preferred first
+   * \param nCandidates Number of candidates, at least 1
+   * \return The next hop the flow is pinned to
+   */
+  Ipv4Address Select(uint64_t flow, uint32_t bytes, const Ipv4Address* candidates,
+                     uint32_t nCandidates);
+
+  /**
+   * \brief Remove flows idle for longer than the idle timeout, and next
+   * hops whose load has decayed away
+   */
+  void Expire();
+
+  /**
+   * \return the flow entry, or nullptr if the flow is unknown
+   */
+  const FrtaFlowEntry* Find(uint64_t flow) const;
+
+  /**
+   * \return the bytes recently carried through a next hop by pinned flows
+   */
+  uint64_t GetNextHopBytes(Ipv4Address nextHop) const;
+
+  uint32_t GetNFlows() const;
+  uint64_t GetRepins() const;
+  void Clear();
+
+private:
+  Ipv4Address SelectLeastLoaded(const Ipv4Address* candidates, uint32_t nCandidates) const;
+  double GetDecayedBytes(const FrtaNextHopLoad& load, Time now) const;
+
+  FrtaBoundedMap<uint64_t, FrtaFlowEntry> m_flows;                           //!< Flows by identifier
+  std::unordered_map<Ipv4Address, FrtaNextHopLoad, Ipv4AddressHash> m_nextHopLoads; //!< Load per next hop
+  Time m_flowletGap;     //!< Idle time after which a flow may move
+  Time m_idleTimeout;    //!< Idle time after which a flow is removed
+  uint64_t m_repins;     //!< Flows moved to another next hop
+};
+
+} // namespace ns3
+
+#endif /* FRTA_FLOW_TABLE_H */
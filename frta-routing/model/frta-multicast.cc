@@ -0,0 +1,214 @@
+#include "frta-multicast.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaMulticastTable");
+
+FrtaMulticastTable::FrtaMulticastTable()
+  : m_lifetime(Seconds(3))
+{
+}
+
+void
+FrtaMulticastTable::SetLifetime(Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+uint64_t
+FrtaMulticastTable::Key(Ipv4Address source, Ipv4Address group)
+{
+  return (static_cast<uint64_t>(source.Get()) << 32) | group.Get();
+}
+
+bool
+FrtaMulticastTable::HasDownstream(const FrtaMulticastTree& tree)
+{
+  for (const auto& neighbor : tree.downstream)
+  {
+    if (neighbor.second > Simulator::Now())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+FrtaMulticastTable::Join(Ipv4Address group)
+{
+  NS_LOG_FUNCTION(this << group);
+  m_members.insert(group);
+}
+
+void
+FrtaMulticastTable::Leave(Ipv4Address group)
+{
+  NS_LOG_FUNCTION(this << group);
+  m_members.erase(group);
+}
+
+bool
+FrtaMulticastTable::IsMember(Ipv4Address group) const
+{
+  return m_members.count(group) > 0;
+}
+
+bool
+FrtaMulticastTable::NoteSending(Ipv4Address group)
+{
+  auto inserted = m_sending.emplace(group, Simulator::Now());
+  bool idle = !inserted.second && Simulator::Now() - inserted.first->second >= m_lifetime;
+  inserted.first->second = Simulator::Now();
+  return inserted.second || idle;
+}
+
+std::vector<Ipv4Address>
+FrtaMulticastTable::GetSendingGroups()
+{
+  std::vector<Ipv4Address> groups;
+  for (auto it = m_sending.begin(); it != m_sending.end();)
+  {
+    if (Simulator::Now() - it->second >= m_lifetime)
+    {
+      it = m_sending.erase(it);
+      continue;
+    }
+    groups.push_back(it->first);
+    ++it;
+  }
+  return groups;
+}
+
+bool
+FrtaMulticastTable::Query(Ipv4Address source, Ipv4Address group, uint32_t sequence,
+                          Ipv4Address neighbor, uint8_t hopCount, double trust)
+{
+  NS_LOG_FUNCTION(this << source << group << sequence << neighbor << trust);
+  
+  auto inserted = m_trees.emplace(Key(source, group), FrtaMulticastTree());
+  FrtaMulticastTree& tree = inserted.first->second;
+  bool stale = Simulator::Now() - tree.queried >= m_lifetime;
+  if (inserted.second || sequence > tree.sequence || stale)
+  {
+    tree.source = source;
+    tree.group = group;
+    tree.upstream = neighbor;
+    tree.sequence = sequence;
+    tree.hopCount = hopCount;
+    tree.trust = trust;
+    tree.queried = Simulator::Now();
+    return true;
+  }
+  if (sequence == tree.sequence &&
+      (trust > tree.trust || (trust == tree.trust && hopCount < tree.hopCount)))
+  {
+    tree.upstream = neighbor;
+    tree.hopCount = hopCount;
+    tree.trust = trust;
+  }
+  return false;
+}
+
+const FrtaMulticastTree*
+FrtaMulticastTable::Find(Ipv4Address source, Ipv4Address group) const
+{
+  auto it = m_trees.find(Key(source, group));
+  return it != m_trees.end() ? &it->second : nullptr;
+}
+
+std::vector<const FrtaMulticastTree*>
+FrtaMulticastTable::GetTrees(Ipv4Address group) const
+{
+  std::vector<const FrtaMulticastTree*> trees;
+  for (const auto& entry : m_trees)
+  {
+    if (entry.second.group == group)
+    {
+      trees.push_back(&entry.second);
+    }
+  }
+  return trees;
+}
+
+bool
+FrtaMulticastTable::AddDownstream(Ipv4Address source, Ipv4Address group, Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION(this << source << group << neighbor);
+  
+  // A source is joined without having heard its own query
+  auto inserted = m_trees.emplace(Key(source, group), FrtaMulticastTree());
+  FrtaMulticastTree& tree = inserted.first->second;
+  if (inserted.second)
+  {
+    tree.source = source;
+    tree.group = group;
+    tree.sequence = 0;
+    tree.hopCount = 0;
+    tree.trust = 0;
+    tree.queried = Simulator::Now();
+  }
+  bool forwarder = HasDownstream(tree);
+  tree.downstream[neighbor] = Simulator::Now() + m_lifetime;
+  return !forwarder;
+}
+
+bool
+FrtaMulticastTable::RemoveDownstream(Ipv4Address source, Ipv4Address group, Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION(this << source << group << neighbor);
+  
+  auto it = m_trees.find(Key(source, group));
+  if (it == m_trees.end() || it->second.downstream.erase(neighbor) == 0)
+  {
+    return false;
+  }
+  return !HasDownstream(it->second);
+}
+
+bool
+FrtaMulticastTable::IsForwarder(Ipv4Address source, Ipv4Address group) const
+{
+  auto it = m_trees.find(Key(source, group));
+  return it != m_trees.end() && HasDownstream(it->second);
+}
+
+void
+FrtaMulticastTable::Expire()
+{
+  Time now = Simulator::Now();
+  for (auto it = m_trees.begin(); it != m_trees.end();)
+  {
+    auto& downstream = it->second.downstream;
+    for (auto neighbor = downstream.begin(); neighbor != downstream.end();)
+    {
+      neighbor = neighbor->second <= now ? downstream.erase(neighbor) : std::next(neighbor);
+    }
+    if (downstream.empty() && now - it->second.queried >= m_lifetime)
+    {
+      it = m_trees.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+uint32_t
+FrtaMulticastTable::GetN() const
+{
+  return m_trees.size();
+}
+
+void
+FrtaMulticastTable::Clear()
+{
+  m_trees.clear();
+  m_members.clear();
+  m_sending.clear();
+}
+
+} // namespace ns3
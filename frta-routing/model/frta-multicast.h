@@ -0,0 +1,123 @@
+#ifndef FRTA_MULTICAST_H
+#define FRTA_MULTICAST_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief State of one node in the forwarding tree of a (source, group) pair
+ */
+struct FrtaMulticastTree
+{
+  Ipv4Address source;     //!< Source of the group traffic
+  Ipv4Address group;      //!< Multicast group
+  Ipv4Address upstream;   //!< Neighbor on the most trusted reverse path to the source
+  uint32_t sequence;      //!< Latest query round of the source
+  uint8_t hopCount;       //!< Hops to the source through the upstream neighbor
+  double trust;           //!< Trust of the reverse path through the upstream neighbor
+  Time queried;           //!< Time the latest query round was first heard
+  std::unordered_map<Ipv4Address, Time, Ipv4AddressHash> downstream;  //!< Expiry by joined neighbor
+};
+
+/**
+ * \brief Group membership and per-group forwarding state of one node
+ *
+ * A source floods a query for each group it sends to, once per query
+ * interval. Every node keeps the neighbor the query arrived from over the
+ * most trusted path as its upstream neighbor. Members, and nodes with
+ * members downstream, join towards their upstream neighbor, so the nodes
+ * joined by some neighbor form the forwarding tree of the source. State
+ * not refreshed within its lifetime is dropped, pruning the tree.
+ */
+class FrtaMulticastTable
+{
+public:
+  FrtaMulticastTable();
+
+  /**
+   * \param lifetime Time for which queries and joins remain valid
+   */
+  void SetLifetime(Time lifetime);
+
+  void Join(Ipv4Address group);
+  void Leave(Ipv4Address group);
+  bool IsMember(Ipv4Address group) const;
+
+  /**
+   * \brief Note that this node sent to a group
+   * \return true if it had not sent to the group within the lifetime
+   */
+  bool NoteSending(Ipv4Address group);
+
+  /**
+   * \return the groups this node sent to within the lifetime; the others
+   * are forgotten
+   */
+  std::vector<Ipv4Address> GetSendingGroups();
+
+  /**
+   * \brief Record a query received from a neighbor
+   * \param trust Trust of the reverse path through the neighbor
+   * \return true if the query starts a new round, which is then flooded on
+   *
+   * Within a round, a more trusted path, or an equally trusted shorter one,
+   * replaces the upstream neighbor.
+   */
+  bool Query(Ipv4Address source, Ipv4Address group, uint32_t sequence, Ipv4Address neighbor,
+             uint8_t hopCount, double trust);
+
+  /**
+   * \return the tree of a (source, group) pair, or nullptr if unknown
+   */
+  const FrtaMulticastTree* Find(Ipv4Address source, Ipv4Address group) const;
+
+  /**
+   * \return the trees of a group this node knows of
+   */
+  std::vector<const FrtaMulticastTree*> GetTrees(Ipv4Address group) const;
+
+  /**
+   * \brief Record or refresh the join of a downstream neighbor
+   * \return true if this node just became a forwarder of the tree
+   */
+  bool AddDownstream(Ipv4Address source, Ipv4Address group, Ipv4Address neighbor);
+
+  /**
+   * \brief Remove a downstream neighbor that left
+   * \return true if this node is no longer a forwarder of the tree
+   */
+  bool RemoveDownstream(Ipv4Address source, Ipv4Address group, Ipv4Address neighbor);
+
+  /**
+   * \return true if some neighbor joined the tree through this node
+   */
+  bool IsForwarder(Ipv4Address source, Ipv4Address group) const;
+
+  /**
+   * \brief Drop expired joins, and trees neither queried nor joined
+   * within the lifetime
+   */
+  void Expire();
+
+  uint32_t GetN() const;
+  void Clear();
+
+private:
+  static uint64_t Key(Ipv4Address source, Ipv4Address group);
+  static bool HasDownstream(const FrtaMulticastTree& tree);
+
+  std::unordered_map<uint64_t, FrtaMulticastTree> m_trees;  //!< Trees by (source, group)
+  std::unordered_set<Ipv4Address, Ipv4AddressHash> m_members;  //!< Groups joined locally
+  std::unordered_map<Ipv4Address, Time, Ipv4AddressHash> m_sending;  //!< Last send by group
+  Time m_lifetime;  //!< Validity of queries and joins
+};
+
+} // namespace ns3
+
+#endif /* FRTA_MULTICAST_H */
@@ -0,0 +1,180 @@
+#include "frta-network-coding.h"
+#include "ns3/log.h"
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaNetworkCoder");
+
+FrtaNetworkCoder::FrtaNetworkCoder()
+  : m_lifetime(Seconds(1)),
+    m_capacity(256)
+{
+  SetLifetime(m_lifetime);
+  SetCapacity(m_capacity);
+}
+
+void
+FrtaNetworkCoder::SetLifetime(Time lifetime)
+{
+  m_lifetime = lifetime;
+  m_held.SetLifetime(lifetime);
+  for (auto& neighbor : m_neighbors)
+  {
+    neighbor.second.SetLifetime(lifetime);
+  }
+}
+
+void
+FrtaNetworkCoder::SetCapacity(uint32_t capacity)
+{
+  m_capacity = capacity;
+  m_packets.SetCapacity(capacity);
+  m_held.SetCapacity(capacity);
+  for (auto& neighbor : m_neighbors)
+  {
+    neighbor.second.SetCapacity(capacity);
+  }
+}
+
+void
+FrtaNetworkCoder::Remember(const Ipv4Header& header, Ptr<const Packet> payload)
+{
+  uint64_t fingerprint = FrtaFingerprintCache::Fingerprint(header);
+  if (!m_held.Insert(fingerprint))
+  {
+    return;
+  }
+  m_packets[fingerprint] = payload;
+  if (m_unreported.size() == ReceptionReportHeader::MAX_REPORTS)
+  {
+    m_unreported.erase(m_unreported.begin());
+  }
+  m_unreported.push_back(fingerprint);
+}
+
+void
+FrtaNetworkCoder::NoteNeighborHas(Ipv4Address neighbor, uint64_t fingerprint)
+{
+  auto inserted = m_neighbors.try_emplace(neighbor);
+  FrtaFingerprintCache& held = inserted.first->second;
+  if (inserted.second)
+  {
+    held.SetLifetime(m_lifetime);
+    held.SetCapacity(m_capacity);
+  }
+  held.Insert(fingerprint);
+}
+
+bool
+FrtaNetworkCoder::NeighborHas(Ipv4Address neighbor, uint64_t fingerprint) const
+{
+  auto it = m_neighbors.find(neighbor);
+  return it != m_neighbors.end() && it->second.Contains(fingerprint);
+}
+
+void
+FrtaNetworkCoder::TakeReport(ReceptionReportHeader& report)
+{
+  for (uint64_t fingerprint : m_unreported)
+  {
+    report.AddFingerprint(fingerprint);
+  }
+  m_unreported.clear();
+}
+
+void
+FrtaNetworkCoder::ProcessReport(Ipv4Address neighbor, const ReceptionReportHeader& report)
+{
+  NS_LOG_FUNCTION(this << neighbor << report.GetNFingerprints());
+  for (uint32_t i = 0; i < report.GetNFingerprints(); i++)
+  {
+    NoteNeighborHas(neighbor, report.GetFingerprint(i));
+  }
+}
+
+Ptr<Packet>
+FrtaNetworkCoder::Encode(const Ptr<const Packet>* payloads, uint32_t nPayloads)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; i < nPayloads; i++)
+  {
+    length = std::max(length, payloads[i]->GetSize());
+  }
+  std::vector<uint8_t> coded(length, 0);
+  std::vector<uint8_t> native(length);
+  for (uint32_t i = 0; i < nPayloads; i++)
+  {
+    uint32_t size = payloads[i]->CopyData(native.data(), length);
+    for (uint32_t b = 0; b < size; b++)
+    {
+      coded[b] ^= native[b];
+    }
+  }
+  m_stats.codedTransmissions++;
+  m_stats.codedNatives += nPayloads;
+  return Create<Packet>(coded.data(), length);
+}
+
+Ptr<Packet>
+FrtaNetworkCoder::Decode(const CodedPacketHeader& header, Ptr<const Packet> coded,
+                         Ipv4Address self, uint32_t& index)
+{
+  NS_LOG_FUNCTION(this << self);
+
+  for (index = 0; index < header.GetNNatives(); index++)
+  {
+    if (header.GetNative(index).nextHop == self)
+    {
+      break;
+    }
+  }
+  if (index == header.GetNNatives())
+  {
+    return nullptr;
+  }
+
+  uint32_t length = coded->GetSize();
+  std::vector<uint8_t> decoded(length);
+  std::vector<uint8_t> native(length);
+  coded->CopyData(decoded.data(), length);
+  for (uint32_t i = 0; i < header.GetNNatives(); i++)
+  {
+    if (i == index)
+    {
+      continue;
+    }
+    uint64_t fingerprint = header.GetNative(i).fingerprint;
+    auto it = m_packets.find(fingerprint);
+    if (it == m_packets.end() || !m_held.Contains(fingerprint))
+    {
+      NS_LOG_LOGIC("Missing native " << fingerprint << " to decode");
+      m_stats.undecodable++;
+      return nullptr;
+    }
+    uint32_t size = it->second->CopyData(native.data(), length);
+    for (uint32_t b = 0; b < size; b++)
+    {
+      decoded[b] ^= native[b];
+    }
+  }
+  m_stats.decoded++;
+  return Create<Packet>(decoded.data(), std::min<uint32_t>(header.GetNative(index).length, length));
+}
+
+const FrtaCodingStats&
+FrtaNetworkCoder::GetStats() const
+{
+  return m_stats;
+}
+
+void
+FrtaNetworkCoder::Clear()
+{
+  m_packets.clear();
+  m_held.Clear();
+  m_neighbors.clear();
+  m_unreported.clear();
+}
+
+} // namespace ns3
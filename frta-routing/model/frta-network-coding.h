@@ -0,0 +1,117 @@
+#ifndef FRTA_NETWORK_CODING_H
+#define FRTA_NETWORK_CODING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include "frta-fingerprint-cache.h"
+#include "frta-routing-header.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Counters of the network coding layer
+ */
+struct FrtaCodingStats
+{
+  uint64_t codedTransmissions = 0;  //!< Coded packets sent, each one a coding opportunity taken
+  uint64_t codedNatives = 0;        //!< Native packets carried by coded packets
+  uint64_t decoded = 0;             //!< Natives recovered from received coded packets
+  uint64_t undecodable = 0;         //!< Coded packets missing a native needed to decode
+};
+
+/**
+ * \brief COPE-style inter-flow network coding state of one node
+ *
+ * Keeps the payloads of the data packets this node recently sent or
+ * received, so that it can decode an XOR of several of them, and what each
+ * neighbor is known to hold, learned from its reception reports and from
+ * the packets it transmitted to this node. A relay XORs natives bound for
+ * different next hops into one broadcast when every next hop already holds
+ * all the natives but its own.
+ */
+class FrtaNetworkCoder
+{
+public:
+  FrtaNetworkCoder();
+
+  /**
+   * \param lifetime Time for which packets and neighbor knowledge are kept
+   */
+  void SetLifetime(Time lifetime);
+
+  /**
+   * \param capacity Maximum number of packets kept, and of fingerprints kept
+   * per neighbor
+   */
+  void SetCapacity(uint32_t capacity);
+
+  /**
+   * \brief Keep a data packet this node sent or received for decoding, and
+   * report it in the next reception report
+   * \param header The IPv4 header of the packet
+   * \param payload The packet without its IPv4 header
+   */
+  void Remember(const Ipv4Header& header, Ptr<const Packet> payload);
+
+  /**
+   * \brief Record that a neighbor holds a packet
+   */
+  void NoteNeighborHas(Ipv4Address neighbor, uint64_t fingerprint);
+
+  /**
+   * \return true if a neighbor is known to hold a packet
+   */
+  bool NeighborHas(Ipv4Address neighbor, uint64_t fingerprint) const;
+
+  /**
+   * \brief Move the packets remembered since the last report into a report
+   */
+  void TakeReport(ReceptionReportHeader& report);
+
+  /**
+   * \brief Record the packets a neighbor reported
+   */
+  void ProcessReport(Ipv4Address neighbor, const ReceptionReportHeader& report);
+
+  /**
+   * \brief XOR native payloads, padded to the longest
+   * \param payloads The native payloads
+   * \param nPayloads Number of payloads
+   * \return the coded payload
+   */
+  Ptr<Packet> Encode(const Ptr<const Packet>* payloads, uint32_t nPayloads);
+
+  /**
+   * \brief Recover the native meant for a node from a coded packet
+   * \param header The header of the coded packet
+   * \param coded The coded payload
+   * \param self The decoding node
+   * \param index Set to the position of the recovered native in the header
+   * \return the native payload, or nullptr if no native is meant for this
+   * node or another native is not held
+   */
+  Ptr<Packet> Decode(const CodedPacketHeader& header, Ptr<const Packet> coded, Ipv4Address self,
+                     uint32_t& index);
+
+  const FrtaCodingStats& GetStats() const;
+  void Clear();
+
+private:
+  FrtaBoundedMap<uint64_t, Ptr<const Packet>> m_packets;  //!< Payloads by fingerprint
+  FrtaFingerprintCache m_held;                            //!< Fingerprints of m_packets still valid
+  std::unordered_map<Ipv4Address, FrtaFingerprintCache, Ipv4AddressHash> m_neighbors;  //!< Held by each neighbor
+  std::vector<uint64_t> m_unreported;  //!< Remembered since the last report
+  Time m_lifetime;                     //!< Time packets and knowledge are kept
+  uint32_t m_capacity;                 //!< Packets kept, and fingerprints per neighbor
+  FrtaCodingStats m_stats;
+};
+
+} // namespace ns3
+
+#endif /* FRTA_NETWORK_CODING_H */
@@ -0,0 +1,96 @@
+#include "frta-packet-pool.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaPacketPool");
+
+FrtaPacketPool::FrtaPacketPool()
+  : m_capacity(0),
+    m_bufferSize(0),
+    m_next(0),
+    m_hits(0),
+    m_misses(0)
+{
+}
+
+void
+FrtaPacketPool::SetCapacity(uint32_t capacity, uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION(this << capacity << bufferSize);
+  m_capacity = capacity;
+  m_bufferSize = bufferSize;
+  if (m_packets.size() > m_capacity)
+  {
+    m_packets.resize(m_capacity);
+  }
+  m_packets.reserve(m_capacity);
+  while (m_packets.size() < m_capacity)
+  {
+    m_packets.push_back(CreatePacket());
+  }
+  m_next = 0;
+}
+
+Ptr<Packet>
+FrtaPacketPool::CreatePacket() const
+{
+  // Grow the buffer once, then give the bytes back as headroom so that
+  // headers added later fit without reallocation. The bytes must be real:
+  // the zero-filled payload of Create<Packet>(size) is never allocated.
+  std::vector<uint8_t> bytes(m_bufferSize);
+  Ptr<Packet> packet = Create<Packet>(bytes.data(), m_bufferSize);
+  packet->RemoveAtStart(m_bufferSize);
+  return packet;
+}
+
+Ptr<Packet>
+FrtaPacketPool::Acquire()
+{
+  for (uint32_t i = 0; i < m_packets.size(); i++)
+  {
+    Ptr<Packet>& packet = m_packets[m_next];
+    m_next = (m_next + 1) % m_packets.size();
+
+    // Only the pool holds a reference once the packet has left the stack
+    if (packet->GetReferenceCount() == 1)
+    {
+      packet->RemoveAtStart(packet->GetSize());
+      packet->RemoveAllPacketTags();
+      packet->RemoveAllByteTags();
+      packet->SetNixVector(nullptr);
+      m_hits++;
+      return packet;
+    }
+  }
+  m_misses++;
+  return CreatePacket();
+}
+
+void
+FrtaPacketPool::Clear()
+{
+  m_packets.clear();
+  m_next = 0;
+}
+
+uint64_t
+FrtaPacketPool::GetHits() const
+{
+  return m_hits;
+}
+
+uint64_t
+FrtaPacketPool::GetMisses() const
+{
+  return m_misses;
+}
+
+double
+FrtaPacketPool::GetHitRate() const
+{
+  uint64_t total = m_hits + m_misses;
+  return total > 0 ? static_cast<double>(m_hits) / total : 0.0;
+}
+
+} // namespace ns3
@@ -0,0 +1,69 @@
+#ifndef FRTA_PACKET_POOL_H
+#define FRTA_PACKET_POOL_H
+
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+#include <cstdint>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Pool of pre-sized packets recycled for FRTA control transmissions
+ *
+ * A pooled packet is handed out again once every other reference to the
+ * Packet object has been dropped. It is then emptied of headers, trailers
+ * and tags, keeping the buffer it already owns. When no pooled packet is
+ * free a fresh one is created and counted as a miss.
+ *
+ * Only the Packet object is certain to be recycled. Lower layers send
+ * copies that share the buffer, and one still queued or retransmitted by
+ * the MAC forces the next header added to the pooled packet into a new
+ * buffer; so does a message larger than the headroom. The hit rate is thus
+ * an upper bound on the buffer allocations saved, which ns-3 partly saves
+ * anyway through its own buffer free list.
+ */
+class FrtaPacketPool
+{
+public:
+  FrtaPacketPool();
+
+  /**
+   * \brief Set the number of pooled packets
+   * \param capacity Maximum number of pooled packets, 0 disables pooling
+   * \param bufferSize Bytes of headroom reserved in each pooled packet
+   */
+  void SetCapacity(uint32_t capacity, uint32_t bufferSize);
+
+  /**
+   * \return an empty packet, recycled when possible
+   */
+  Ptr<Packet> Acquire();
+
+  /**
+   * \brief Drop all pooled packets
+   */
+  void Clear();
+
+  uint64_t GetHits() const;
+  uint64_t GetMisses() const;
+
+  /**
+   * \return the fraction of acquisitions served with a recycled Packet object
+   */
+  double GetHitRate() const;
+
+private:
+  Ptr<Packet> CreatePacket() const;
+
+  std::vector<Ptr<Packet>> m_packets;  //!< Pooled packets
+  uint32_t m_capacity;                 //!< Maximum number of pooled packets
+  uint32_t m_bufferSize;               //!< Headroom reserved in each pooled packet
+  uint32_t m_next;                     //!< Next slot to examine
+  uint64_t m_hits;                     //!< Acquisitions served from the pool
+  uint64_t m_misses;                   //!< Acquisitions that created a packet
+};
+
+} // namespace ns3
+
+#endif /* FRTA_PACKET_POOL_H */
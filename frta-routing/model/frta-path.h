@@ -0,0 +1,341 @@
+#ifndef FRTA_PATH_H
+#define FRTA_PATH_H
+
+#include "ns3/ipv4-address.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Compile-time limit on the number of hops of an FRTA path
+ */
+static const uint32_t FRTA_MAX_HOP_COUNT = 10;
+
+/**
+ * \brief Compile-time limit on the number of alternative paths kept per destination
+ */
+static const uint32_t FRTA_MAX_PATHS = 5;
+
+/**
+ * \brief Maps node addresses to dense integer identifiers
+ *
+ * Identifiers are assigned in order of first use and never reused, so they
+ * can index flat arrays and be stored compactly in paths. The map is kept
+ * bounded by Trim(), which starts it afresh once most identifiers are no
+ * longer needed.
+ */
+class FrtaNodeIdMap
+{
+public:
+  FrtaNodeIdMap()
+    : m_evictions(0)
+  {
+  }
+
+  /**
+   * \brief Get the identifier of an address, assigning one if needed
+   * \param address The node address
+   * \return The dense identifier
+   */
+  uint32_t GetId(Ipv4Address address)
+  {
+    auto it = m_ids.find(address);
+    if (it != m_ids.end())
+    {
+      return it->second;
+    }
+    uint32_t id = m_addresses.size();
+    m_ids.emplace(address, id);
+    m_addresses.push_back(address);
+    return id;
+  }
+
+  /**
+   * \brief Look up the identifier of an address without assigning one
+   * \param address The node address
+   * \param id Set to the identifier if found
+   * \return true if the address has an identifier
+   */
+  bool Lookup(Ipv4Address address, uint32_t& id) const
+  {
+    auto it = m_ids.find(address);
+    if (it == m_ids.end())
+    {
+      return false;
+    }
+    id = it->second;
+    return true;
+  }
+
+  /**
+   * \param id A dense identifier
+   * \return The address the identifier was assigned to
+   */
+  Ipv4Address GetAddress(uint32_t id) const
+  {
+    return m_addresses[id];
+  }
+
+  /**
+   * \return the number of identifiers assigned so far
+   */
+  uint32_t GetN() const
+  {
+    return m_addresses.size();
+  }
+
+  void Reserve(uint32_t n)
+  {
+    m_ids.reserve(n);
+    m_addresses.reserve(n);
+  }
+
+  /**
+   * \brief Forget all identifiers if more than twice as many are assigned as in use
+   * \param live Number of addresses still in use
+   * \return true if the map was cleared, which invalidates every path built from it
+   */
+  bool Trim(uint32_t live)
+  {
+    if (m_addresses.size() <= 2 * static_cast<size_t>(live))
+    {
+      return false;
+    }
+    m_evictions += m_addresses.size();
+    m_ids.clear();
+    m_addresses.clear();
+    return true;
+  }
+
+  /**
+   * \return the number of identifiers forgotten by Trim() so far
+   */
+  uint64_t GetEvictions() const
+  {
+    return m_evictions;
+  }
+
+private:
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_ids;  //!< Address to identifier
+  std::vector<Ipv4Address> m_addresses;                              //!< Identifier to address
+  uint64_t m_evictions;                                              //!< Identifiers forgotten by Trim()
+};
+
+/**
+ * \brief Fixed-capacity path of dense node identifiers
+ *
+ * A path holds its source, intermediate hops and destination inline, so
+ * building and copying paths never allocates. The hash of every prefix is
+ * maintained as nodes are appended, making GetHash() and PopBack() O(1).
+ *
+ * \tparam MaxHops Maximum number of hops; the path holds up to MaxHops + 1 nodes
+ */
+template <uint32_t MaxHops>
+class FrtaPathT
+{
+public:
+  static const uint32_t CAPACITY = MaxHops + 1;  //!< Maximum number of nodes
+
+  FrtaPathT()
+    : m_size(0)
+  {
+    m_hashes[0] = 0xcbf29ce484222325ULL;
+  }
+
+  /**
+   * \brief Append a node
+   * \param id Dense identifier of the node
+   * \return false if the path is already at its hop limit
+   */
+  bool PushBack(uint32_t id)
+  {
+    if (m_size == CAPACITY)
+    {
+      return false;
+    }
+    m_nodes[m_size] = id;
+    m_hashes[m_size + 1] = (m_hashes[m_size] ^ id) * 0x100000001b3ULL;
+    m_size++;
+    return true;
+  }
+
+  void PopBack()
+  {
+    m_size--;
+  }
+
+  void Clear()
+  {
+    m_size = 0;
+  }
+
+  uint32_t Size() const
+  {
+    return m_size;
+  }
+
+  bool Empty() const
+  {
+    return m_size == 0;
+  }
+
+  bool Full() const
+  {
+    return m_size == CAPACITY;
+  }
+
+  /**
+   * \return the number of hops, one less than the number of nodes
+   */
+  uint32_t GetHopCount() const
+  {
+    return m_size > 0 ? m_size - 1 : 0;
+  }
+
+  bool Contains(uint32_t id) const
+  {
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+      if (m_nodes[i] == id)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  uint32_t operator[](uint32_t i) const
+  {
+    return m_nodes[i];
+  }
+
+  uint32_t Back() const
+  {
+    return m_nodes[m_size - 1];
+  }
+
+  const uint32_t* begin() const
+  {
+    return m_nodes.data();
+  }
+
+  const uint32_t* end() const
+  {
+    return m_nodes.data() + m_size;
+  }
+
+  uint64_t GetHash() const
+  {
+    return m_hashes[m_size];
+  }
+
+  bool operator==(const FrtaPathT& other) const
+  {
+    if (m_size != other.m_size || GetHash() != other.GetHash())
+    {
+      return false;
+    }
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+      if (m_nodes[i] != other.m_nodes[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(const FrtaPathT& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  std::array<uint32_t, CAPACITY> m_nodes;      //!< Node identifiers, source first
+  std::array<uint64_t, CAPACITY + 1> m_hashes; //!< FNV-1a hash of each prefix
+  uint32_t m_size;                             //!< Number of nodes in the path
+};
+
+/**
+ * \brief Hash functor returning the precomputed hash of a path
+ */
+struct FrtaPathHash
+{
+  template <uint32_t MaxHops>
+  size_t operator()(const FrtaPathT<MaxHops>& path) const
+  {
+    return path.GetHash();
+  }
+};
+
+/**
+ * \brief Fixed-capacity set of alternative paths
+ */
+template <typename Path, uint32_t MaxPaths>
+class FrtaPathSet
+{
+public:
+  FrtaPathSet()
+    : m_size(0)
+  {
+  }
+
+  /**
+   * \brief Add a path
+   * \param path The path to add
+   * \return false if the set is full
+   */
+  bool Add(const Path& path)
+  {
+    if (m_size == MaxPaths)
+    {
+      return false;
+    }
+    m_paths[m_size++] = path;
+    return true;
+  }
+
+  uint32_t Size() const
+  {
+    return m_size;
+  }
+
+  bool Empty() const
+  {
+    return m_size == 0;
+  }
+
+  bool Full() const
+  {
+    return m_size == MaxPaths;
+  }
+
+  const Path& operator[](uint32_t i) const
+  {
+    return m_paths[i];
+  }
+
+  const Path* begin() const
+  {
+    return m_paths.data();
+  }
+
+  const Path* end() const
+  {
+    return m_paths.data() + m_size;
+  }
+
+private:
+  std::array<Path, MaxPaths> m_paths;  //!< Stored paths
+  uint32_t m_size;                     //!< Number of stored paths
+};
+
+typedef FrtaPathT<FRTA_MAX_HOP_COUNT> FrtaPath;                 //!< Path bounded by the FRTA hop limit
+typedef FrtaPathSet<FrtaPath, FRTA_MAX_PATHS> FrtaPathList;     //!< Alternative paths to one destination
+
+} // namespace ns3
+
+#endif /* FRTA_PATH_H */
@@ -0,0 +1,230 @@
+#include "frta-recommendation-trust.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaRecommendationTrust");
+
+constexpr double FrtaRecommendationTrust::RESTART;
+constexpr double FrtaRecommendationTrust::TOLERANCE;
+
+FrtaRecommendationTrust::FrtaRecommendationTrust()
+  : m_self(0),
+    m_lifetime(Seconds(10)),
+    m_dirty(false),
+    m_dangling(0),
+    m_cursor(0),
+    m_iterations(0),
+    m_converged(false)
+{
+}
+
+void
+FrtaRecommendationTrust::SetSelf(Ipv4Address self)
+{
+  m_self = m_ids.GetId(self);
+}
+
+void
+FrtaRecommendationTrust::SetLifetime(Time lifetime)
+{
+  m_lifetime = lifetime;
+}
+
+void
+FrtaRecommendationTrust::SetOpinions(Ipv4Address truster, const Opinions& opinions)
+{
+  NS_LOG_FUNCTION(this << truster << opinions.size());
+  uint32_t id = m_ids.GetId(truster);
+  Row& row = m_rows[id];
+  row.opinions.clear();
+  row.opinions.reserve(opinions.size());
+  for (const auto& opinion : opinions)
+  {
+    uint32_t trusted = m_ids.GetId(opinion.first);
+    if (trusted != id)
+    {
+      row.opinions.emplace_back(trusted, opinion.second);
+    }
+  }
+  row.updated = Simulator::Now();
+  m_dirty = true;
+}
+
+void
+FrtaRecommendationTrust::Rebuild()
+{
+  Time now = Simulator::Now();
+  for (auto it = m_rows.begin(); it != m_rows.end();)
+  {
+    if (it->first != m_self && now - it->second.updated >= m_lifetime)
+    {
+      it = m_rows.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  
+  uint32_t n = m_ids.GetN();
+  m_rowStart.assign(n + 1, 0);
+  for (const auto& row : m_rows)
+  {
+    m_rowStart[row.first + 1] = row.second.opinions.size();
+  }
+  for (uint32_t i = 0; i < n; i++)
+  {
+    m_rowStart[i + 1] += m_rowStart[i];
+  }
+  m_columns.resize(m_rowStart[n]);
+  m_weights.resize(m_rowStart[n]);
+  m_opinions.resize(m_rowStart[n]);
+  for (const auto& row : m_rows)
+  {
+    double sum = 0;
+    for (const auto& opinion : row.second.opinions)
+    {
+      sum += opinion.second;
+    }
+    uint32_t entry = m_rowStart[row.first];
+    for (const auto& opinion : row.second.opinions)
+    {
+      m_columns[entry] = opinion.first;
+      m_weights[entry] = sum > 0 ? opinion.second / sum : 0;
+      m_opinions[entry] = opinion.second;
+      entry++;
+    }
+  }
+  
+  // Warm start from the previous reputation; new nodes start at zero
+  if (m_reputation.empty())
+  {
+    m_reputation.assign(n, 0);
+    m_reputation[m_self] = 1;
+  }
+  m_reputation.resize(n, 0);
+  m_next.assign(n, 0);
+  m_weightedTrust.assign(n, 0);
+  m_weightSum.assign(n, 0);
+  m_estimates.resize(n, -1);
+  m_dangling = 0;
+  m_dirty = false;
+  m_converged = false;
+}
+
+uint32_t
+FrtaRecommendationTrust::Step(uint32_t budget)
+{
+  uint32_t work = 0;
+  if (m_rowStart.empty() && !m_dirty)
+  {
+    return work;
+  }
+  while (work < budget && !(m_converged && !m_dirty))
+  {
+    if (m_cursor == 0 && m_dirty)
+    {
+      Rebuild();
+      work += m_columns.size();
+    }
+    uint32_t n = m_rowStart.size() - 1;
+    for (; m_cursor < n && work < budget; m_cursor++)
+    {
+      double reputation = m_reputation[m_cursor];
+      uint32_t begin = m_rowStart[m_cursor];
+      uint32_t end = m_rowStart[m_cursor + 1];
+      if (begin == end)
+      {
+        m_dangling += reputation;
+      }
+      for (uint32_t entry = begin; entry < end; entry++)
+      {
+        uint32_t trusted = m_columns[entry];
+        m_next[trusted] += reputation * m_weights[entry];
+        m_weightedTrust[trusted] += reputation * m_opinions[entry];
+        m_weightSum[trusted] += reputation;
+      }
+      work += 1 + end - begin;
+    }
+    if (m_cursor == n)
+    {
+      FinishIteration();
+    }
+  }
+  return work;
+}
+
+void
+FrtaRecommendationTrust::FinishIteration()
+{
+  // Reputation that flows nowhere returns to this node with the restart
+  uint32_t n = m_next.size();
+  double change = 0;
+  for (uint32_t i = 0; i < n; i++)
+  {
+    double next = (1 - RESTART) * m_next[i];
+    if (i == m_self)
+    {
+      next += RESTART + (1 - RESTART) * m_dangling;
+    }
+    change += std::abs(next - m_reputation[i]);
+    m_reputation[i] = next;
+    m_estimates[i] = m_weightSum[i] > 0 ? m_weightedTrust[i] / m_weightSum[i] : -1;
+  }
+  std::fill(m_next.begin(), m_next.end(), 0);
+  std::fill(m_weightedTrust.begin(), m_weightedTrust.end(), 0);
+  std::fill(m_weightSum.begin(), m_weightSum.end(), 0);
+  m_dangling = 0;
+  m_cursor = 0;
+  m_iterations++;
+  m_converged = change < TOLERANCE;
+  NS_LOG_LOGIC("Iteration " << m_iterations << " changed reputation by " << change);
+}
+
+bool
+FrtaRecommendationTrust::GetTrust(Ipv4Address node, double& trust) const
+{
+  uint32_t id;
+  if (!m_ids.Lookup(node, id) || id >= m_estimates.size() || m_estimates[id] < 0)
+  {
+    return false;
+  }
+  trust = m_estimates[id];
+  return true;
+}
+
+bool
+FrtaRecommendationTrust::IsConverged() const
+{
+  return m_converged;
+}
+
+uint32_t
+FrtaRecommendationTrust::GetIterations() const
+{
+  return m_iterations;
+}
+
+void
+FrtaRecommendationTrust::Clear()
+{
+  m_rows.clear();
+  m_rowStart.clear();
+  m_columns.clear();
+  m_weights.clear();
+  m_opinions.clear();
+  m_reputation.clear();
+  m_next.clear();
+  m_weightedTrust.clear();
+  m_weightSum.clear();
+  m_estimates.clear();
+  m_cursor = 0;
+  m_dirty = false;
+  m_converged = false;
+}
+
+} // namespace ns3
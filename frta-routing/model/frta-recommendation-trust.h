@@ -0,0 +1,113 @@
+#ifndef FRTA_RECOMMENDATION_TRUST_H
+#define FRTA_RECOMMENDATION_TRUST_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "frta-path.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief EigenTrust-style transitive trust from the opinions of neighbors
+ *
+ * The local trust graph holds the direct trust this node and its neighbors
+ * have in other nodes, as shared in their trust vectors. A personalized
+ * power iteration, restarting at this node, turns it into the reputation
+ * of every node as a recommender. The recommended trust of a node is the
+ * reputation-weighted mean of the opinions about it, so nodes this node
+ * never observed are judged by the collective experience of the network.
+ *
+ * Nodes are mapped to dense identifiers and the graph is stored as a CSR
+ * matrix, rebuilt at iteration boundaries after opinions change. The
+ * iteration is incremental: Step() resumes where the previous call stopped
+ * and visits at most a given number of matrix entries.
+ */
+class FrtaRecommendationTrust
+{
+public:
+  static constexpr double RESTART = 0.15;    //!< Weight of this node in each iteration
+  static constexpr double TOLERANCE = 1e-4;  //!< L1 change at which the iteration has converged
+
+  /**
+   * \brief Opinions of one node: the nodes it trusts, and how much
+   */
+  typedef std::vector<std::pair<Ipv4Address, double>> Opinions;
+
+  FrtaRecommendationTrust();
+
+  /**
+   * \param self The address of this node, where the iteration restarts
+   */
+  void SetSelf(Ipv4Address self);
+
+  /**
+   * \param lifetime Time after which the opinions of a neighbor are dropped
+   */
+  void SetLifetime(Time lifetime);
+
+  /**
+   * \brief Replace the opinions of a node
+   */
+  void SetOpinions(Ipv4Address truster, const Opinions& opinions);
+
+  /**
+   * \brief Advance the iteration
+   * \param budget Maximum number of matrix entries to visit
+   * \return the number of entries visited
+   */
+  uint32_t Step(uint32_t budget);
+
+  /**
+   * \brief Get the recommended trust of a node
+   * \return false if no one shared an opinion about the node yet
+   */
+  bool GetTrust(Ipv4Address node, double& trust) const;
+
+  bool IsConverged() const;
+  uint32_t GetIterations() const;
+  void Clear();
+
+private:
+  /**
+   * \brief Opinions shared by one node
+   */
+  struct Row
+  {
+    std::vector<std::pair<uint32_t, double>> opinions;  //!< Trust by node identifier
+    Time updated;                                       //!< Time the opinions were shared
+  };
+
+  void Rebuild();
+  void FinishIteration();
+
+  FrtaNodeIdMap m_ids;                    //!< Dense identifiers of all nodes mentioned
+  std::unordered_map<uint32_t, Row> m_rows;  //!< Opinions by truster
+  uint32_t m_self;                        //!< Identifier of this node
+  Time m_lifetime;                        //!< Lifetime of the opinions of a neighbor
+  bool m_dirty;                           //!< Whether opinions changed since the last rebuild
+
+  // Row-normalized trust graph in CSR form; row i lists the nodes i trusts
+  std::vector<uint32_t> m_rowStart;       //!< Offset of each row, plus the end
+  std::vector<uint32_t> m_columns;        //!< Trusted node of each entry
+  std::vector<double> m_weights;          //!< Normalized trust of each entry
+  std::vector<double> m_opinions;         //!< Raw trust of each entry
+
+  // Iteration state
+  std::vector<double> m_reputation;       //!< Recommender reputation, sums to 1
+  std::vector<double> m_next;             //!< Reputation being accumulated
+  std::vector<double> m_weightedTrust;    //!< Reputation-weighted opinions per node
+  std::vector<double> m_weightSum;        //!< Reputation of those with an opinion per node
+  std::vector<double> m_estimates;        //!< Recommended trust per node, negative if none
+  double m_dangling;                      //!< Reputation of nodes without opinions
+  uint32_t m_cursor;                      //!< Next row to visit
+  uint32_t m_iterations;                  //!< Completed iterations
+  bool m_converged;                       //!< Whether the last iteration converged
+};
+
+} // namespace ns3
+
+#endif /* FRTA_RECOMMENDATION_TRUST_H */
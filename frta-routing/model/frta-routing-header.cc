@@ -1,6 +1,7 @@
 #include "frta-routing-header.h"
 #include "ns3/log.h"
 #include "ns3/address-utils.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -56,7 +57,7 @@ uint32_t
 FrtaHeader::Deserialize(Buffer::Iterator start)
 {
   uint8_t type = start.ReadU8();
-  if (type >= 1 && type <= 4)  // Valid message types
+  if (type >= FRTA_ROUTE_REQUEST && type <= FRTA_CUSTODY_ACK)  // Valid message types
   {
     m_type = (MessageType)type;
   }
@@ -71,7 +72,7 @@ FrtaHeader::Deserialize(Buffer::Iterator start)
 void
 FrtaHeader::SetMessageType(MessageType type)
 {
-  NS_ASSERT(type >= FRTA_ROUTE_REQUEST && type <= FRTA_TRUST_UPDATE);
+  NS_ASSERT(type >= FRTA_ROUTE_REQUEST && type <= FRTA_CUSTODY_ACK);
   m_type = type;
 }
 
@@ -114,13 +115,14 @@ RouteRequestHeader::Print(std::ostream &os) const
 {
   os << "DestAddr=" << m_destination
      << " SrcAddr=" << m_source
-     << " HopCount=" << m_hopCount;
+     << " HopCount=" << m_hopCount
+     << " Channels=" << m_channels.size();
 }
 
 uint32_t
 RouteRequestHeader::GetSerializedSize(void) const
 {
-  return 8 + 8 + 4;  // Two IPv4 addresses + hop count
+  return 8 + 8 + 4 + 1 + m_channels.size();  // Two IPv4 addresses + hop count + channels
 }
 
 void
@@ -129,6 +131,11 @@ RouteRequestHeader::Serialize(Buffer::Iterator start) const
   start.WriteHtonU32(m_destination.Get());
   start.WriteHtonU32(m_source.Get());
   start.WriteHtonU32(m_hopCount);
+  start.WriteU8(m_channels.size());
+  for (uint8_t channel : m_channels)
+  {
+    start.WriteU8(channel);
+  }
 }
 
 uint32_t
@@ -137,6 +144,11 @@ RouteRequestHeader::Deserialize(Buffer::Iterator start)
   m_destination.Set(start.ReadNtohU32());
   m_source.Set(start.ReadNtohU32());
   m_hopCount = start.ReadNtohU32();
+  m_channels.resize(std::min<uint32_t>(start.ReadU8(), MAX_CHANNELS));
+  for (auto& channel : m_channels)
+  {
+    channel = start.ReadU8();
+  }
   return GetSerializedSize();
 }
 
@@ -176,11 +188,28 @@ RouteRequestHeader::GetHopCount(void) const
   return m_hopCount;
 }
 
+bool
+RouteRequestHeader::AddChannel(uint8_t channel)
+{
+  if (m_channels.size() >= MAX_CHANNELS)
+  {
+    return false;
+  }
+  m_channels.push_back(channel);
+  return true;
+}
+
+const std::vector<uint8_t>&
+RouteRequestHeader::GetChannels(void) const
+{
+  return m_channels;
+}
+
 //-----------------------------------------------------------------------------
 // RouteReplyHeader
 //-----------------------------------------------------------------------------
 
-RouteReplyHeader::RouteReplyHeader() : m_trust(0.0)
+RouteReplyHeader::RouteReplyHeader() : m_trust(0.0), m_hopCount(0)
 {
 }
 
@@ -209,13 +238,16 @@ RouteReplyHeader::Print(std::ostream &os) const
 {
   os << "DestAddr=" << m_destination
      << " NextHop=" << m_nextHop
-     << " Trust=" << m_trust;
+     << " Trust=" << m_trust
+     << " Target=" << m_target
+     << " HopCount=" << m_hopCount
+     << " Channels=" << m_channels.size();
 }
 
 uint32_t
 RouteReplyHeader::GetSerializedSize(void) const
 {
-  return 8 + 8 + 8;  // Two IPv4 addresses + trust value
+  return 8 + 8 + 8 + 4 + 4 + 1 + m_channels.size();  // Two IPv4 addresses + trust value + target + hop count + channels
 }
 
 void
@@ -225,6 +257,13 @@ RouteReplyHeader::Serialize(Buffer::Iterator start) const
   start.WriteHtonU32(m_nextHop.Get());
   uint64_t trust = *reinterpret_cast<const uint64_t*>(&m_trust);
   start.WriteHtonU64(trust);
+  start.WriteHtonU32(m_target.Get());
+  start.WriteHtonU32(m_hopCount);
+  start.WriteU8(m_channels.size());
+  for (uint8_t channel : m_channels)
+  {
+    start.WriteU8(channel);
+  }
 }
 
 uint32_t
@@ -234,6 +273,13 @@ RouteReplyHeader::Deserialize(Buffer::Iterator start)
   m_nextHop.Set(start.ReadNtohU32());
   uint64_t trust = start.ReadNtohU64();
   m_trust = *reinterpret_cast<double*>(&trust);
+  m_target.Set(start.ReadNtohU32());
+  m_hopCount = start.ReadNtohU32();
+  m_channels.resize(std::min<uint32_t>(start.ReadU8(), MAX_CHANNELS));
+  for (auto& channel : m_channels)
+  {
+    channel = start.ReadU8();
+  }
   return GetSerializedSize();
 }
 
@@ -255,6 +301,18 @@ RouteReplyHeader::SetTrust(double trust)
   m_trust = trust;
 }
 
+void
+RouteReplyHeader::SetTarget(Ipv4Address target)
+{
+  m_target = target;
+}
+
+void
+RouteReplyHeader::SetHopCount(uint32_t hopCount)
+{
+  m_hopCount = hopCount;
+}
+
 Ipv4Address
 RouteReplyHeader::GetDestination(void) const
 {
@@ -273,6 +331,31 @@ RouteReplyHeader::GetTrust(void) const
   return m_trust;
 }
 
+Ipv4Address
+RouteReplyHeader::GetTarget(void) const
+{
+  return m_target;
+}
+
+uint32_t
+RouteReplyHeader::GetHopCount(void) const
+{
+  return m_hopCount;
+}
+
+void
+RouteReplyHeader::SetChannels(const std::vector<uint8_t>& channels)
+{
+  m_channels.assign(channels.begin(),
+                    channels.begin() + std::min<size_t>(channels.size(), MAX_CHANNELS));
+}
+
+const std::vector<uint8_t>&
+RouteReplyHeader::GetChannels(void) const
+{
+  return m_channels;
+}
+
 //-----------------------------------------------------------------------------
 // RouteAdvertisementHeader
 //-----------------------------------------------------------------------------
@@ -385,4 +468,1228 @@ RouteAdvertisementHeader::GetHopCount(void) const
   return m_hopCount;
 }
 
-} // namespace ns3 
\ No newline at end of file
+//-----------------------------------------------------------------------------
+// CodedPacketHeader
+//-----------------------------------------------------------------------------
+
+CodedPacketHeader::CodedPacketHeader()
+{
+}
+
+CodedPacketHeader::~CodedPacketHeader()
+{
+}
+
+TypeId
+CodedPacketHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::CodedPacketHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<CodedPacketHeader>();
+  return tid;
+}
+
+TypeId
+CodedPacketHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+CodedPacketHeader::Print(std::ostream &os) const
+{
+  os << "Natives=" << m_natives.size();
+  for (const auto& native : m_natives)
+  {
+    os << " [NextHop=" << native.nextHop
+       << " Length=" << native.length
+       << " " << native.header.GetSource() << ">" << native.header.GetDestination() << "]";
+  }
+}
+
+uint32_t
+CodedPacketHeader::GetSerializedSize(void) const
+{
+  uint32_t size = 1;  // Number of natives
+  for (const auto& native : m_natives)
+  {
+    size += 4 + 8 + 2 + native.header.GetSerializedSize();  // Next hop + fingerprint + length + IPv4 header
+  }
+  return size;
+}
+
+void
+CodedPacketHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_natives.size());
+  for (const auto& native : m_natives)
+  {
+    start.WriteHtonU32(native.nextHop.Get());
+    start.WriteHtonU64(native.fingerprint);
+    start.WriteHtonU16(native.length);
+    native.header.Serialize(start);
+    start.Next(native.header.GetSerializedSize());
+  }
+}
+
+uint32_t
+CodedPacketHeader::Deserialize(Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  uint32_t nNatives = std::min<uint32_t>(i.ReadU8(), MAX_NATIVES);
+  m_natives.resize(nNatives);
+  for (auto& native : m_natives)
+  {
+    native.nextHop.Set(i.ReadNtohU32());
+    native.fingerprint = i.ReadNtohU64();
+    native.length = i.ReadNtohU16();
+    i.Next(native.header.Deserialize(i));
+  }
+  return i.GetDistanceFrom(start);
+}
+
+bool
+CodedPacketHeader::AddNative(const Native& native)
+{
+  if (m_natives.size() >= MAX_NATIVES)
+  {
+    return false;
+  }
+  m_natives.push_back(native);
+  return true;
+}
+
+uint32_t
+CodedPacketHeader::GetNNatives(void) const
+{
+  return m_natives.size();
+}
+
+const CodedPacketHeader::Native&
+CodedPacketHeader::GetNative(uint32_t i) const
+{
+  return m_natives[i];
+}
+
+//-----------------------------------------------------------------------------
+// ReceptionReportHeader
+//-----------------------------------------------------------------------------
+
+ReceptionReportHeader::ReceptionReportHeader()
+{
+}
+
+ReceptionReportHeader::~ReceptionReportHeader()
+{
+}
+
+TypeId
+ReceptionReportHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::ReceptionReportHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<ReceptionReportHeader>();
+  return tid;
+}
+
+TypeId
+ReceptionReportHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+ReceptionReportHeader::Print(std::ostream &os) const
+{
+  os << "Reports=" << m_fingerprints.size();
+}
+
+uint32_t
+ReceptionReportHeader::GetSerializedSize(void) const
+{
+  return 1 + 8 * m_fingerprints.size();  // Count + fingerprints
+}
+
+void
+ReceptionReportHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_fingerprints.size());
+  for (uint64_t fingerprint : m_fingerprints)
+  {
+    start.WriteHtonU64(fingerprint);
+  }
+}
+
+uint32_t
+ReceptionReportHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nFingerprints = std::min<uint32_t>(start.ReadU8(), MAX_REPORTS);
+  m_fingerprints.resize(nFingerprints);
+  for (auto& fingerprint : m_fingerprints)
+  {
+    fingerprint = start.ReadNtohU64();
+  }
+  return GetSerializedSize();
+}
+
+bool
+ReceptionReportHeader::AddFingerprint(uint64_t fingerprint)
+{
+  if (m_fingerprints.size() >= MAX_REPORTS)
+  {
+    return false;
+  }
+  m_fingerprints.push_back(fingerprint);
+  return true;
+}
+
+uint32_t
+ReceptionReportHeader::GetNFingerprints(void) const
+{
+  return m_fingerprints.size();
+}
+
+uint64_t
+ReceptionReportHeader::GetFingerprint(uint32_t i) const
+{
+  return m_fingerprints[i];
+}
+
+//-----------------------------------------------------------------------------
+// AggregateHeader
+//-----------------------------------------------------------------------------
+
+AggregateHeader::AggregateHeader()
+{
+}
+
+AggregateHeader::~AggregateHeader()
+{
+}
+
+TypeId
+AggregateHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::AggregateHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<AggregateHeader>();
+  return tid;
+}
+
+TypeId
+AggregateHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+AggregateHeader::Print(std::ostream &os) const
+{
+  os << "Packets=" << m_lengths.size();
+}
+
+uint32_t
+AggregateHeader::GetSerializedSize(void) const
+{
+  return 1 + 2 * m_lengths.size();  // Count + lengths
+}
+
+void
+AggregateHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_lengths.size());
+  for (uint16_t length : m_lengths)
+  {
+    start.WriteHtonU16(length);
+  }
+}
+
+uint32_t
+AggregateHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nPackets = std::min<uint32_t>(start.ReadU8(), MAX_PACKETS);
+  m_lengths.resize(nPackets);
+  for (auto& length : m_lengths)
+  {
+    length = start.ReadNtohU16();
+  }
+  return GetSerializedSize();
+}
+
+bool
+AggregateHeader::AddPacket(uint16_t length)
+{
+  if (m_lengths.size() >= MAX_PACKETS)
+  {
+    return false;
+  }
+  m_lengths.push_back(length);
+  return true;
+}
+
+uint32_t
+AggregateHeader::GetNPackets(void) const
+{
+  return m_lengths.size();
+}
+
+uint16_t
+AggregateHeader::GetLength(uint32_t i) const
+{
+  return m_lengths[i];
+}
+
+//-----------------------------------------------------------------------------
+// BundleHeader
+//-----------------------------------------------------------------------------
+
+BundleHeader::BundleHeader() : m_lifetime(0), m_custody(0)
+{
+}
+
+BundleHeader::~BundleHeader()
+{
+}
+
+TypeId
+BundleHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::BundleHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<BundleHeader>();
+  return tid;
+}
+
+TypeId
+BundleHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+BundleHeader::Print(std::ostream &os) const
+{
+  os << "Lifetime=" << m_lifetime << "ms Custody=" << m_custody;
+}
+
+uint32_t
+BundleHeader::GetSerializedSize(void) const
+{
+  return 4 + 4;  // Lifetime + custody count
+}
+
+void
+BundleHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU32(m_lifetime);
+  start.WriteHtonU32(m_custody);
+}
+
+uint32_t
+BundleHeader::Deserialize(Buffer::Iterator start)
+{
+  m_lifetime = start.ReadNtohU32();
+  m_custody = start.ReadNtohU32();
+  return GetSerializedSize();
+}
+
+void
+BundleHeader::SetLifetime(Time lifetime)
+{
+  m_lifetime = std::max<int64_t>(0, lifetime.GetMilliSeconds());
+}
+
+void
+BundleHeader::SetCustody(uint32_t custody)
+{
+  m_custody = custody;
+}
+
+Time
+BundleHeader::GetLifetime(void) const
+{
+  return MilliSeconds(m_lifetime);
+}
+
+uint32_t
+BundleHeader::GetCustody(void) const
+{
+  return m_custody;
+}
+
+//-----------------------------------------------------------------------------
+// DeliveryPredictabilityHeader
+//-----------------------------------------------------------------------------
+
+DeliveryPredictabilityHeader::DeliveryPredictabilityHeader()
+{
+}
+
+DeliveryPredictabilityHeader::~DeliveryPredictabilityHeader()
+{
+}
+
+TypeId
+DeliveryPredictabilityHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::DeliveryPredictabilityHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<DeliveryPredictabilityHeader>();
+  return tid;
+}
+
+TypeId
+DeliveryPredictabilityHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+DeliveryPredictabilityHeader::Print(std::ostream &os) const
+{
+  os << "Entries=" << m_entries.size();
+}
+
+uint32_t
+DeliveryPredictabilityHeader::GetSerializedSize(void) const
+{
+  return 1 + 6 * m_entries.size();  // Count + (address, predictability) pairs
+}
+
+void
+DeliveryPredictabilityHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_entries.size());
+  for (const auto& entry : m_entries)
+  {
+    start.WriteHtonU32(entry.first.Get());
+    start.WriteHtonU16(entry.second);
+  }
+}
+
+uint32_t
+DeliveryPredictabilityHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nEntries = std::min<uint32_t>(start.ReadU8(), MAX_ENTRIES);
+  m_entries.resize(nEntries);
+  for (auto& entry : m_entries)
+  {
+    entry.first.Set(start.ReadNtohU32());
+    entry.second = start.ReadNtohU16();
+  }
+  return GetSerializedSize();
+}
+
+bool
+DeliveryPredictabilityHeader::AddEntry(Ipv4Address destination, double predictability)
+{
+  if (m_entries.size() >= MAX_ENTRIES)
+  {
+    return false;
+  }
+  double clamped = std::min(1.0, std::max(0.0, predictability));
+  m_entries.emplace_back(destination, static_cast<uint16_t>(clamped * 65535 + 0.5));
+  return true;
+}
+
+uint32_t
+DeliveryPredictabilityHeader::GetNEntries(void) const
+{
+  return m_entries.size();
+}
+
+Ipv4Address
+DeliveryPredictabilityHeader::GetDestination(uint32_t i) const
+{
+  return m_entries[i].first;
+}
+
+double
+DeliveryPredictabilityHeader::GetPredictability(uint32_t i) const
+{
+  return m_entries[i].second / 65535.0;
+}
+
+double
+DeliveryPredictabilityHeader::Find(Ipv4Address destination) const
+{
+  for (uint32_t i = 0; i < m_entries.size(); i++)
+  {
+    if (m_entries[i].first == destination)
+    {
+      return GetPredictability(i);
+    }
+  }
+  return 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// TrustVectorHeader
+//-----------------------------------------------------------------------------
+
+TrustVectorHeader::TrustVectorHeader()
+{
+}
+
+TrustVectorHeader::~TrustVectorHeader()
+{
+}
+
+TypeId
+TrustVectorHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::TrustVectorHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<TrustVectorHeader>();
+  return tid;
+}
+
+TypeId
+TrustVectorHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+TrustVectorHeader::Print(std::ostream &os) const
+{
+  os << "Entries=" << m_entries.size();
+}
+
+uint32_t
+TrustVectorHeader::GetSerializedSize(void) const
+{
+  return 1 + 6 * m_entries.size();  // Count + (address, trust) pairs
+}
+
+void
+TrustVectorHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_entries.size());
+  for (const auto& entry : m_entries)
+  {
+    start.WriteHtonU32(entry.first.Get());
+    start.WriteHtonU16(entry.second);
+  }
+}
+
+uint32_t
+TrustVectorHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nEntries = std::min<uint32_t>(start.ReadU8(), MAX_ENTRIES);
+  m_entries.resize(nEntries);
+  for (auto& entry : m_entries)
+  {
+    entry.first.Set(start.ReadNtohU32());
+    entry.second = start.ReadNtohU16();
+  }
+  return GetSerializedSize();
+}
+
+bool
+TrustVectorHeader::AddEntry(Ipv4Address node, double trust)
+{
+  if (m_entries.size() >= MAX_ENTRIES)
+  {
+    return false;
+  }
+  double clamped = std::min(1.0, std::max(0.0, trust));
+  m_entries.emplace_back(node, static_cast<uint16_t>(clamped * 65535 + 0.5));
+  return true;
+}
+
+uint32_t
+TrustVectorHeader::GetNEntries(void) const
+{
+  return m_entries.size();
+}
+
+Ipv4Address
+TrustVectorHeader::GetNode(uint32_t i) const
+{
+  return m_entries[i].first;
+}
+
+double
+TrustVectorHeader::GetTrust(uint32_t i) const
+{
+  return m_entries[i].second / 65535.0;
+}
+
+//-----------------------------------------------------------------------------
+// TrustDigestHeader
+//-----------------------------------------------------------------------------
+
+TrustDigestHeader::TrustDigestHeader()
+{
+  m_hashes.fill(0);
+}
+
+TrustDigestHeader::~TrustDigestHeader()
+{
+}
+
+TypeId
+TrustDigestHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::TrustDigestHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<TrustDigestHeader>();
+  return tid;
+}
+
+TypeId
+TrustDigestHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+TrustDigestHeader::Print(std::ostream &os) const
+{
+  os << "Buckets=" << BUCKETS;
+}
+
+uint32_t
+TrustDigestHeader::GetSerializedSize(void) const
+{
+  return 4 * BUCKETS;  // One hash per bucket
+}
+
+void
+TrustDigestHeader::Serialize(Buffer::Iterator start) const
+{
+  for (uint32_t hash : m_hashes)
+  {
+    start.WriteHtonU32(hash);
+  }
+}
+
+uint32_t
+TrustDigestHeader::Deserialize(Buffer::Iterator start)
+{
+  for (uint32_t& hash : m_hashes)
+  {
+    hash = start.ReadNtohU32();
+  }
+  return GetSerializedSize();
+}
+
+void
+TrustDigestHeader::SetHash(uint32_t bucket, uint32_t hash)
+{
+  m_hashes[bucket] = hash;
+}
+
+uint32_t
+TrustDigestHeader::GetHash(uint32_t bucket) const
+{
+  return m_hashes[bucket];
+}
+
+//-----------------------------------------------------------------------------
+// TrustRequestHeader
+//-----------------------------------------------------------------------------
+
+TrustRequestHeader::TrustRequestHeader() : m_buckets(0)
+{
+}
+
+TrustRequestHeader::~TrustRequestHeader()
+{
+}
+
+TypeId
+TrustRequestHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::TrustRequestHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<TrustRequestHeader>();
+  return tid;
+}
+
+TypeId
+TrustRequestHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+TrustRequestHeader::Print(std::ostream &os) const
+{
+  os << "Buckets=0x" << std::hex << m_buckets << std::dec;
+}
+
+uint32_t
+TrustRequestHeader::GetSerializedSize(void) const
+{
+  return 2;  // Bucket mask
+}
+
+void
+TrustRequestHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU16(m_buckets);
+}
+
+uint32_t
+TrustRequestHeader::Deserialize(Buffer::Iterator start)
+{
+  m_buckets = start.ReadNtohU16();
+  return GetSerializedSize();
+}
+
+void
+TrustRequestHeader::SetBuckets(uint16_t buckets)
+{
+  m_buckets = buckets;
+}
+
+uint16_t
+TrustRequestHeader::GetBuckets(void) const
+{
+  return m_buckets;
+}
+
+//-----------------------------------------------------------------------------
+// TrustUpdateHeader
+//-----------------------------------------------------------------------------
+
+TrustUpdateHeader::TrustUpdateHeader()
+{
+}
+
+TrustUpdateHeader::~TrustUpdateHeader()
+{
+}
+
+TypeId
+TrustUpdateHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::TrustUpdateHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<TrustUpdateHeader>();
+  return tid;
+}
+
+TypeId
+TrustUpdateHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+TrustUpdateHeader::Print(std::ostream &os) const
+{
+  os << "Records=" << m_records.size();
+}
+
+uint32_t
+TrustUpdateHeader::GetSerializedSize(void) const
+{
+  return 1 + 14 * m_records.size();  // Count + (subject, origin, version, trust) records
+}
+
+void
+TrustUpdateHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_records.size());
+  for (const auto& record : m_records)
+  {
+    start.WriteHtonU32(record.subject.Get());
+    start.WriteHtonU32(record.origin.Get());
+    start.WriteHtonU32(record.version);
+    start.WriteHtonU16(record.trust);
+  }
+}
+
+uint32_t
+TrustUpdateHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nRecords = std::min<uint32_t>(start.ReadU8(), MAX_RECORDS);
+  m_records.resize(nRecords);
+  for (auto& record : m_records)
+  {
+    record.subject.Set(start.ReadNtohU32());
+    record.origin.Set(start.ReadNtohU32());
+    record.version = start.ReadNtohU32();
+    record.trust = start.ReadNtohU16();
+  }
+  return GetSerializedSize();
+}
+
+bool
+TrustUpdateHeader::AddRecord(const FrtaTrustRecord& record)
+{
+  if (m_records.size() >= MAX_RECORDS)
+  {
+    return false;
+  }
+  m_records.push_back(record);
+  return true;
+}
+
+uint32_t
+TrustUpdateHeader::GetNRecords(void) const
+{
+  return m_records.size();
+}
+
+const FrtaTrustRecord&
+TrustUpdateHeader::GetRecord(uint32_t i) const
+{
+  return m_records[i];
+}
+
+//-----------------------------------------------------------------------------
+// MulticastQueryHeader
+//-----------------------------------------------------------------------------
+
+MulticastQueryHeader::MulticastQueryHeader()
+  : m_sequence(0),
+    m_hopCount(0),
+    m_trust(0)
+{
+}
+
+MulticastQueryHeader::~MulticastQueryHeader()
+{
+}
+
+TypeId
+MulticastQueryHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MulticastQueryHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<MulticastQueryHeader>();
+  return tid;
+}
+
+TypeId
+MulticastQueryHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+MulticastQueryHeader::Print(std::ostream &os) const
+{
+  os << "Group=" << m_group << " Source=" << m_source << " Sequence=" << m_sequence
+     << " HopCount=" << static_cast<uint32_t>(m_hopCount) << " Trust=" << GetTrust();
+}
+
+uint32_t
+MulticastQueryHeader::GetSerializedSize(void) const
+{
+  return 4 + 4 + 4 + 1 + 2;  // Group + source + sequence + hop count + trust
+}
+
+void
+MulticastQueryHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU32(m_group.Get());
+  start.WriteHtonU32(m_source.Get());
+  start.WriteHtonU32(m_sequence);
+  start.WriteU8(m_hopCount);
+  start.WriteHtonU16(m_trust);
+}
+
+uint32_t
+MulticastQueryHeader::Deserialize(Buffer::Iterator start)
+{
+  m_group.Set(start.ReadNtohU32());
+  m_source.Set(start.ReadNtohU32());
+  m_sequence = start.ReadNtohU32();
+  m_hopCount = start.ReadU8();
+  m_trust = start.ReadNtohU16();
+  return GetSerializedSize();
+}
+
+void
+MulticastQueryHeader::SetGroup(Ipv4Address group)
+{
+  m_group = group;
+}
+
+void
+MulticastQueryHeader::SetSource(Ipv4Address source)
+{
+  m_source = source;
+}
+
+void
+MulticastQueryHeader::SetSequence(uint32_t sequence)
+{
+  m_sequence = sequence;
+}
+
+void
+MulticastQueryHeader::SetHopCount(uint8_t hopCount)
+{
+  m_hopCount = hopCount;
+}
+
+void
+MulticastQueryHeader::SetTrust(double trust)
+{
+  double clamped = std::min(1.0, std::max(0.0, trust));
+  m_trust = static_cast<uint16_t>(clamped * 65535 + 0.5);
+}
+
+Ipv4Address
+MulticastQueryHeader::GetGroup(void) const
+{
+  return m_group;
+}
+
+Ipv4Address
+MulticastQueryHeader::GetSource(void) const
+{
+  return m_source;
+}
+
+uint32_t
+MulticastQueryHeader::GetSequence(void) const
+{
+  return m_sequence;
+}
+
+uint8_t
+MulticastQueryHeader::GetHopCount(void) const
+{
+  return m_hopCount;
+}
+
+double
+MulticastQueryHeader::GetTrust(void) const
+{
+  return m_trust / 65535.0;
+}
+
+//-----------------------------------------------------------------------------
+// MulticastJoinHeader
+//-----------------------------------------------------------------------------
+
+MulticastJoinHeader::MulticastJoinHeader() : m_join(1)
+{
+}
+
+MulticastJoinHeader::~MulticastJoinHeader()
+{
+}
+
+TypeId
+MulticastJoinHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::MulticastJoinHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<MulticastJoinHeader>();
+  return tid;
+}
+
+TypeId
+MulticastJoinHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+MulticastJoinHeader::Print(std::ostream &os) const
+{
+  os << (m_join ? "Join" : "Leave") << " Group=" << m_group << " Source=" << m_source;
+}
+
+uint32_t
+MulticastJoinHeader::GetSerializedSize(void) const
+{
+  return 4 + 4 + 1;  // Group + source + join flag
+}
+
+void
+MulticastJoinHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU32(m_group.Get());
+  start.WriteHtonU32(m_source.Get());
+  start.WriteU8(m_join);
+}
+
+uint32_t
+MulticastJoinHeader::Deserialize(Buffer::Iterator start)
+{
+  m_group.Set(start.ReadNtohU32());
+  m_source.Set(start.ReadNtohU32());
+  m_join = start.ReadU8();
+  return GetSerializedSize();
+}
+
+void
+MulticastJoinHeader::SetGroup(Ipv4Address group)
+{
+  m_group = group;
+}
+
+void
+MulticastJoinHeader::SetSource(Ipv4Address source)
+{
+  m_source = source;
+}
+
+void
+MulticastJoinHeader::SetJoin(bool join)
+{
+  m_join = join ? 1 : 0;
+}
+
+Ipv4Address
+MulticastJoinHeader::GetGroup(void) const
+{
+  return m_group;
+}
+
+Ipv4Address
+MulticastJoinHeader::GetSource(void) const
+{
+  return m_source;
+}
+
+bool
+MulticastJoinHeader::IsJoin(void) const
+{
+  return m_join != 0;
+}
+
+//-----------------------------------------------------------------------------
+// ChannelReportHeader
+//-----------------------------------------------------------------------------
+
+ChannelReportHeader::ChannelReportHeader()
+{
+}
+
+ChannelReportHeader::~ChannelReportHeader()
+{
+}
+
+TypeId
+ChannelReportHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::ChannelReportHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<ChannelReportHeader>();
+  return tid;
+}
+
+TypeId
+ChannelReportHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+ChannelReportHeader::Print(std::ostream &os) const
+{
+  os << "Radios=" << m_entries.size();
+}
+
+uint32_t
+ChannelReportHeader::GetSerializedSize(void) const
+{
+  return 1 + 5 * m_entries.size();  // Count + (channel, load) pairs
+}
+
+void
+ChannelReportHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU8(m_entries.size());
+  for (const auto& entry : m_entries)
+  {
+    start.WriteU8(entry.first);
+    start.WriteHtonU32(entry.second);
+  }
+}
+
+uint32_t
+ChannelReportHeader::Deserialize(Buffer::Iterator start)
+{
+  uint32_t nEntries = std::min<uint32_t>(start.ReadU8(), MAX_ENTRIES);
+  m_entries.resize(nEntries);
+  for (auto& entry : m_entries)
+  {
+    entry.first = start.ReadU8();
+    entry.second = start.ReadNtohU32();
+  }
+  return GetSerializedSize();
+}
+
+bool
+ChannelReportHeader::AddEntry(uint8_t channel, uint32_t load)
+{
+  if (m_entries.size() >= MAX_ENTRIES)
+  {
+    return false;
+  }
+  m_entries.emplace_back(channel, load);
+  return true;
+}
+
+uint32_t
+ChannelReportHeader::GetNEntries(void) const
+{
+  return m_entries.size();
+}
+
+uint8_t
+ChannelReportHeader::GetChannel(uint32_t i) const
+{
+  return m_entries[i].first;
+}
+
+uint32_t
+ChannelReportHeader::GetLoad(uint32_t i) const
+{
+  return m_entries[i].second;
+}
+
+//-----------------------------------------------------------------------------
+// OpportunisticAckHeader
+//-----------------------------------------------------------------------------
+
+OpportunisticAckHeader::OpportunisticAckHeader() : m_fingerprint(0)
+{
+}
+
+OpportunisticAckHeader::~OpportunisticAckHeader()
+{
+}
+
+TypeId
+OpportunisticAckHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::OpportunisticAckHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<OpportunisticAckHeader>();
+  return tid;
+}
+
+TypeId
+OpportunisticAckHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+OpportunisticAckHeader::Print(std::ostream &os) const
+{
+  os << "Fingerprint=" << m_fingerprint;
+}
+
+uint32_t
+OpportunisticAckHeader::GetSerializedSize(void) const
+{
+  return 8;  // Fingerprint
+}
+
+void
+OpportunisticAckHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU64(m_fingerprint);
+}
+
+uint32_t
+OpportunisticAckHeader::Deserialize(Buffer::Iterator start)
+{
+  m_fingerprint = start.ReadNtohU64();
+  return GetSerializedSize();
+}
+
+void
+OpportunisticAckHeader::SetFingerprint(uint64_t fingerprint)
+{
+  m_fingerprint = fingerprint;
+}
+
+uint64_t
+OpportunisticAckHeader::GetFingerprint(void) const
+{
+  return m_fingerprint;
+}
+
+//-----------------------------------------------------------------------------
+// CustodyAckHeader
+//-----------------------------------------------------------------------------
+
+CustodyAckHeader::CustodyAckHeader() : m_bundle(0)
+{
+}
+
+CustodyAckHeader::~CustodyAckHeader()
+{
+}
+
+TypeId
+CustodyAckHeader::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::CustodyAckHeader")
+    .SetParent<Header>()
+    .SetGroupName("FrtaRouting")
+    .AddConstructor<CustodyAckHeader>();
+  return tid;
+}
+
+TypeId
+CustodyAckHeader::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+void
+CustodyAckHeader::Print(std::ostream &os) const
+{
+  os << "Bundle=" << m_bundle;
+}
+
+uint32_t
+CustodyAckHeader::GetSerializedSize(void) const
+{
+  return 8;  // Bundle identifier
+}
+
+void
+CustodyAckHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteHtonU64(m_bundle);
+}
+
+uint32_t
+CustodyAckHeader::Deserialize(Buffer::Iterator start)
+{
+  m_bundle = start.ReadNtohU64();
+  return GetSerializedSize();
+}
+
+void
+CustodyAckHeader::SetBundle(uint64_t bundle)
+{
+  m_bundle = bundle;
+}
+
+uint64_t
+CustodyAckHeader::GetBundle(void) const
+{
+  return m_bundle;
+}
+
+} // namespace ns3
@@ -3,6 +3,10 @@
 
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include <array>
+#include <utility>
+#include <vector>
 
 namespace ns3 {
 
@@ -16,7 +20,20 @@ public:
     FRTA_ROUTE_REQUEST  = 1,
     FRTA_ROUTE_REPLY    = 2,
     FRTA_ROUTE_ADVERTISEMENT = 3,
-    FRTA_TRUST_UPDATE   = 4
+    FRTA_TRUST_UPDATE   = 4,
+    FRTA_CODED_PACKET   = 5,
+    FRTA_RECEPTION_REPORT = 6,
+    FRTA_AGGREGATE      = 7,
+    FRTA_BUNDLE         = 8,
+    FRTA_DTN_BEACON     = 9,
+    FRTA_TRUST_VECTOR   = 10,
+    FRTA_TRUST_DIGEST   = 11,
+    FRTA_TRUST_REQUEST  = 12,
+    FRTA_MCAST_QUERY    = 13,
+    FRTA_MCAST_JOIN     = 14,
+    FRTA_CHANNEL_REPORT = 15,
+    FRTA_OPP_ACK        = 16,
+    FRTA_CUSTODY_ACK    = 17
   };
 
   FrtaHeader();
@@ -42,6 +59,8 @@ private:
 class RouteRequestHeader : public Header
 {
 public:
+  static const uint32_t MAX_CHANNELS = 16;  //!< Hop channels per request at most
+
   RouteRequestHeader();
   virtual ~RouteRequestHeader();
 
@@ -60,10 +79,22 @@ public:
   Ipv4Address GetSource(void) const;
   uint32_t GetHopCount(void) const;
 
+  /**
+   * \brief Record the channel of the hop the request is sent on
+   * \return false if the header already holds MAX_CHANNELS channels
+   */
+  bool AddChannel(uint8_t channel);
+
+  /**
+   * \return the channels of the hops traversed so far, in order
+   */
+  const std::vector<uint8_t>& GetChannels(void) const;
+
 private:
   Ipv4Address m_destination;
   Ipv4Address m_source;
   uint32_t m_hopCount;
+  std::vector<uint8_t> m_channels;
 };
 
 /**
@@ -72,6 +103,8 @@ private:
 class RouteReplyHeader : public Header
 {
 public:
+  static const uint32_t MAX_CHANNELS = RouteRequestHeader::MAX_CHANNELS;  //!< Hop channels per reply at most
+
   RouteReplyHeader();
   virtual ~RouteReplyHeader();
 
@@ -85,15 +118,38 @@ public:
   void SetDestination(Ipv4Address destination);
   void SetNextHop(Ipv4Address nextHop);
   void SetTrust(double trust);
+  /**
+   * \brief Set the node the route request asked for
+   * \param target The requested destination; the reply travels to the requester
+   */
+  void SetTarget(Ipv4Address target);
+  /**
+   * \brief Set the hops from the sender of the reply to the target
+   * \param hopCount Hop count of the sender's own route to the target
+   */
+  void SetHopCount(uint32_t hopCount);
 
   Ipv4Address GetDestination(void) const;
   Ipv4Address GetNextHop(void) const;
   double GetTrust(void) const;
+  Ipv4Address GetTarget(void) const;
+  uint32_t GetHopCount(void) const;
+
+  /**
+   * \brief Set the channels of the hops of the discovered path
+   * \param channels Channels as collected by the route request, at most
+   * MAX_CHANNELS are kept
+   */
+  void SetChannels(const std::vector<uint8_t>& channels);
+  const std::vector<uint8_t>& GetChannels(void) const;
 
 private:
   Ipv4Address m_destination;
   Ipv4Address m_nextHop;
   double m_trust;
+  Ipv4Address m_target;
+  uint32_t m_hopCount;
+  std::vector<uint8_t> m_channels;
 };
 
 /**
@@ -128,6 +184,438 @@ private:
   uint32_t m_hopCount;
 };
 
+/**
+ * \brief Header of an XOR of several native data packets
+ *
+ * Lists, for every native, the next hop meant to decode it, its fingerprint
+ * and its IPv4 header with the TTL already decremented. The XOR of the
+ * native payloads, padded to the longest, follows the header.
+ */
+class CodedPacketHeader : public Header
+{
+public:
+  static const uint32_t MAX_NATIVES = 4;  //!< Natives combined at most
+
+  struct Native {
+    Ipv4Address nextHop;   //!< Node that decodes this native
+    uint64_t fingerprint;  //!< FrtaFingerprintCache::Fingerprint() of the native
+    uint16_t length;       //!< Payload length of the native
+    Ipv4Header header;     //!< IPv4 header of the native
+  };
+
+  CodedPacketHeader();
+  virtual ~CodedPacketHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the header already lists MAX_NATIVES natives
+   */
+  bool AddNative(const Native& native);
+  uint32_t GetNNatives(void) const;
+  const Native& GetNative(uint32_t i) const;
+
+private:
+  std::vector<Native> m_natives;
+};
+
+/**
+ * \brief Fingerprints of the data packets a node recently sent or received
+ */
+class ReceptionReportHeader : public Header
+{
+public:
+  static const uint32_t MAX_REPORTS = 64;  //!< Fingerprints per report at most
+
+  ReceptionReportHeader();
+  virtual ~ReceptionReportHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the report already holds MAX_REPORTS fingerprints
+   */
+  bool AddFingerprint(uint64_t fingerprint);
+  uint32_t GetNFingerprints(void) const;
+  uint64_t GetFingerprint(uint32_t i) const;
+
+private:
+  std::vector<uint64_t> m_fingerprints;
+};
+
+/**
+ * \brief Header of several data packets aggregated into one frame
+ *
+ * Lists the length of every packet. The packets follow the header, each
+ * with its IPv4 header.
+ */
+class AggregateHeader : public Header
+{
+public:
+  static const uint32_t MAX_PACKETS = 32;  //!< Packets aggregated at most
+
+  AggregateHeader();
+  virtual ~AggregateHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the header already lists MAX_PACKETS packets
+   */
+  bool AddPacket(uint16_t length);
+  uint32_t GetNPackets(void) const;
+  uint16_t GetLength(uint32_t i) const;
+
+private:
+  std::vector<uint16_t> m_lengths;
+};
+
+/**
+ * \brief Header of a delay-tolerant bundle handed to a neighbor
+ *
+ * The bundled packet, with its IPv4 header, follows the header.
+ */
+class BundleHeader : public Header
+{
+public:
+  BundleHeader();
+  virtual ~BundleHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetLifetime(Time lifetime);
+  void SetCustody(uint32_t custody);
+
+  Time GetLifetime(void) const;
+  uint32_t GetCustody(void) const;
+
+private:
+  uint32_t m_lifetime;  // Remaining lifetime in milliseconds
+  uint32_t m_custody;   // Custody transfers so far
+};
+
+/**
+ * \brief Delivery predictabilities of the sender of a delay-tolerant beacon
+ */
+class DeliveryPredictabilityHeader : public Header
+{
+public:
+  static const uint32_t MAX_ENTRIES = 64;  //!< Predictabilities per beacon at most
+
+  DeliveryPredictabilityHeader();
+  virtual ~DeliveryPredictabilityHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the header already holds MAX_ENTRIES predictabilities
+   */
+  bool AddEntry(Ipv4Address destination, double predictability);
+  uint32_t GetNEntries(void) const;
+  Ipv4Address GetDestination(uint32_t i) const;
+  double GetPredictability(uint32_t i) const;
+
+  /**
+   * \return the predictability for a destination, 0 if not listed
+   */
+  double Find(Ipv4Address destination) const;
+
+private:
+  std::vector<std::pair<Ipv4Address, uint16_t>> m_entries;  // Predictabilities scaled to 16 bits
+};
+
+/**
+ * \brief Direct trust a node has in other nodes, shared as a recommendation
+ */
+class TrustVectorHeader : public Header
+{
+public:
+  static const uint32_t MAX_ENTRIES = 64;  //!< Opinions per vector at most
+
+  TrustVectorHeader();
+  virtual ~TrustVectorHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the header already holds MAX_ENTRIES opinions
+   */
+  bool AddEntry(Ipv4Address node, double trust);
+  uint32_t GetNEntries(void) const;
+  Ipv4Address GetNode(uint32_t i) const;
+  double GetTrust(uint32_t i) const;
+
+private:
+  std::vector<std::pair<Ipv4Address, uint16_t>> m_entries;  // Trust scaled to 16 bits
+};
+
+/**
+ * \brief Latest trust reported for a node, versioned for anti-entropy
+ */
+struct FrtaTrustRecord
+{
+  Ipv4Address subject;  //!< Node the trust is about
+  Ipv4Address origin;   //!< Node that reported it
+  uint32_t version;     //!< Version, higher wins
+  uint16_t trust;       //!< Trust scaled to 16 bits
+};
+
+/**
+ * \brief Hash per bucket of a node's trust table
+ */
+class TrustDigestHeader : public Header
+{
+public:
+  static const uint32_t BUCKETS = 16;  //!< Buckets of a trust table
+
+  TrustDigestHeader();
+  virtual ~TrustDigestHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetHash(uint32_t bucket, uint32_t hash);
+  uint32_t GetHash(uint32_t bucket) const;
+
+private:
+  std::array<uint32_t, BUCKETS> m_hashes;  // Hash of each bucket
+};
+
+/**
+ * \brief Buckets of a trust table requested after a digest mismatch
+ */
+class TrustRequestHeader : public Header
+{
+public:
+  TrustRequestHeader();
+  virtual ~TrustRequestHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetBuckets(uint16_t buckets);
+  uint16_t GetBuckets(void) const;
+
+private:
+  uint16_t m_buckets;  // One bit per requested bucket
+};
+
+/**
+ * \brief Trust records sent in reply to a request or as a full update
+ */
+class TrustUpdateHeader : public Header
+{
+public:
+  static const uint32_t MAX_RECORDS = 64;  //!< Records per message at most
+
+  TrustUpdateHeader();
+  virtual ~TrustUpdateHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \return false if the header already holds MAX_RECORDS records
+   */
+  bool AddRecord(const FrtaTrustRecord& record);
+  uint32_t GetNRecords(void) const;
+  const FrtaTrustRecord& GetRecord(uint32_t i) const;
+
+private:
+  std::vector<FrtaTrustRecord> m_records;  // Records in no particular order
+};
+
+/**
+ * \brief Query flooded by a multicast source to build its forwarding tree
+ */
+class MulticastQueryHeader : public Header
+{
+public:
+  MulticastQueryHeader();
+  virtual ~MulticastQueryHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetGroup(Ipv4Address group);
+  void SetSource(Ipv4Address source);
+  void SetSequence(uint32_t sequence);
+  void SetHopCount(uint8_t hopCount);
+  void SetTrust(double trust);
+
+  Ipv4Address GetGroup(void) const;
+  Ipv4Address GetSource(void) const;
+  uint32_t GetSequence(void) const;
+  uint8_t GetHopCount(void) const;
+  double GetTrust(void) const;
+
+private:
+  Ipv4Address m_group;   // Multicast group
+  Ipv4Address m_source;  // Source of the group traffic
+  uint32_t m_sequence;   // Query round of the source
+  uint8_t m_hopCount;    // Hops from the source
+  uint16_t m_trust;      // Trust of the reverse path, scaled to 16 bits
+};
+
+/**
+ * \brief Join or leave of a multicast tree, sent to the upstream neighbor
+ */
+class MulticastJoinHeader : public Header
+{
+public:
+  MulticastJoinHeader();
+  virtual ~MulticastJoinHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetGroup(Ipv4Address group);
+  void SetSource(Ipv4Address source);
+  void SetJoin(bool join);
+
+  Ipv4Address GetGroup(void) const;
+  Ipv4Address GetSource(void) const;
+  bool IsJoin(void) const;
+
+private:
+  Ipv4Address m_group;   // Multicast group
+  Ipv4Address m_source;  // Source of the tree
+  uint8_t m_join;        // 1 to join, 0 to leave
+};
+
+/**
+ * \brief Channels of the radios of a node and the traffic carried on each
+ */
+class ChannelReportHeader : public Header
+{
+public:
+  static const uint32_t MAX_ENTRIES = 16;  //!< Radios per report at most
+
+  ChannelReportHeader();
+  virtual ~ChannelReportHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  /**
+   * \param channel Channel of a radio
+   * \param load Bytes per second sent and received on the radio
+   * \return false if the header already holds MAX_ENTRIES radios
+   */
+  bool AddEntry(uint8_t channel, uint32_t load);
+  uint32_t GetNEntries(void) const;
+  uint8_t GetChannel(uint32_t i) const;
+  uint32_t GetLoad(uint32_t i) const;
+
+private:
+  std::vector<std::pair<uint8_t, uint32_t>> m_entries;  // Channel and load of each radio
+};
+
+/**
+ * \brief Acknowledgement by the destination of an opportunistically routed
+ * packet
+ *
+ * The destination ranks first among the candidates but never forwards, so
+ * this is what tells the remaining candidates that the packet arrived.
+ */
+class OpportunisticAckHeader : public Header
+{
+public:
+  OpportunisticAckHeader();
+  virtual ~OpportunisticAckHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetFingerprint(uint64_t fingerprint);
+  uint64_t GetFingerprint(void) const;
+
+private:
+  uint64_t m_fingerprint;  // Fingerprint of the delivered packet
+};
+
+/**
+ * \brief Acceptance of custody of a bundle, sent back to the node that
+ * handed it over
+ */
+class CustodyAckHeader : public Header
+{
+public:
+  CustodyAckHeader();
+  virtual ~CustodyAckHeader();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+  virtual void Print(std::ostream &os) const;
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(Buffer::Iterator start) const;
+  virtual uint32_t Deserialize(Buffer::Iterator start);
+
+  void SetBundle(uint64_t bundle);
+  uint64_t GetBundle(void) const;
+
+private:
+  uint64_t m_bundle;  // Identifier of the bundle taken into custody
+};
+
 } // namespace ns3
 
 #endif /* FRTA_ROUTING_HEADER_H */ 
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "frta-routing-protocol.h"
+#include "frta-tx-power-manager.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
 #include "ns3/names.h"
@@ -6,12 +7,25 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/node.h"
+#include "ns3/ipv4-l3-protocol.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/udp-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-mac-header.h"
+#include "ns3/wifi-tx-vector.h"
 #include <fstream>
 #include <algorithm>
 #include <vector>
 #include <set>
 #include <functional>
+#include <limits>
+#include <cmath>
+#include <string>
 
 namespace ns3 {
 
@@ -20,8 +34,6 @@ NS_LOG_COMPONENT_DEFINE("FrtaRoutingProtocol");
 std::ofstream g_protocolLog("frta-protocol.log", std::ios::out | std::ios::app);
 
 // Initialize static members
-const Time FrtaRoutingProtocol::ROUTE_REQUEST_TIMEOUT = Seconds(2.0);
-const Time FrtaRoutingProtocol::ROUTE_CACHE_TIMEOUT = Seconds(30.0);
 
 //-----------------------------------------------------------------------------
 // TrustTag Implementation
@@ -81,99 +93,968 @@ TrustTag::GetTrust(void) const
   return m_trust;
 }
 
+//-----------------------------------------------------------------------------
+// FrtaCandidateTag Implementation
+//-----------------------------------------------------------------------------
+
+NS_OBJECT_ENSURE_REGISTERED(FrtaCandidateTag);
+
+FrtaCandidateTag::FrtaCandidateTag()
+  : m_nCandidates(0)
+{
+}
+
+TypeId
+FrtaCandidateTag::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaCandidateTag")
+    .SetParent<Tag>()
+    .SetGroupName("Internet")
+    .AddConstructor<FrtaCandidateTag>();
+  return tid;
+}
+
+TypeId
+FrtaCandidateTag::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+uint32_t
+FrtaCandidateTag::GetSerializedSize(void) const
+{
+  return sizeof(uint32_t) + sizeof(uint8_t) + m_nCandidates * sizeof(uint32_t);
+}
+
+void
+FrtaCandidateTag::Serialize(TagBuffer i) const
+{
+  i.WriteU32(m_forwarder.Get());
+  i.WriteU8(m_nCandidates);
+  for (uint32_t c = 0; c < m_nCandidates; c++)
+  {
+    i.WriteU32(m_candidates[c].Get());
+  }
+}
+
+void
+FrtaCandidateTag::Deserialize(TagBuffer i)
+{
+  m_forwarder = Ipv4Address(i.ReadU32());
+  m_nCandidates = std::min<uint32_t>(i.ReadU8(), MAX_CANDIDATES);
+  for (uint32_t c = 0; c < m_nCandidates; c++)
+  {
+    m_candidates[c] = Ipv4Address(i.ReadU32());
+  }
+}
+
+void
+FrtaCandidateTag::Print(std::ostream &os) const
+{
+  os << "Forwarder=" << m_forwarder << " Candidates=";
+  for (uint32_t c = 0; c < m_nCandidates; c++)
+  {
+    os << (c ? "," : "") << m_candidates[c];
+  }
+}
+
+void
+FrtaCandidateTag::SetForwarder(Ipv4Address forwarder)
+{
+  m_forwarder = forwarder;
+}
+
+Ipv4Address
+FrtaCandidateTag::GetForwarder(void) const
+{
+  return m_forwarder;
+}
+
+bool
+FrtaCandidateTag::AddCandidate(Ipv4Address candidate)
+{
+  if (m_nCandidates == MAX_CANDIDATES)
+  {
+    return false;
+  }
+  m_candidates[m_nCandidates++] = candidate;
+  return true;
+}
+
+uint32_t
+FrtaCandidateTag::GetNCandidates(void) const
+{
+  return m_nCandidates;
+}
+
+Ipv4Address
+FrtaCandidateTag::GetCandidate(uint32_t i) const
+{
+  return m_candidates[i];
+}
+
+uint32_t
+FrtaCandidateTag::GetRank(Ipv4Address candidate) const
+{
+  uint32_t rank = 0;
+  while (rank < m_nCandidates && m_candidates[rank] != candidate)
+  {
+    rank++;
+  }
+  return rank;
+}
+
+//-----------------------------------------------------------------------------
+// FrtaCodingTag Implementation
+//-----------------------------------------------------------------------------
+
+NS_OBJECT_ENSURE_REGISTERED(FrtaCodingTag);
+
+TypeId
+FrtaCodingTag::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaCodingTag")
+    .SetParent<Tag>()
+    .SetGroupName("Internet")
+    .AddConstructor<FrtaCodingTag>();
+  return tid;
+}
+
+TypeId
+FrtaCodingTag::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+uint32_t
+FrtaCodingTag::GetSerializedSize(void) const
+{
+  return sizeof(uint32_t);
+}
+
+void
+FrtaCodingTag::Serialize(TagBuffer i) const
+{
+  i.WriteU32(m_transmitter.Get());
+}
+
+void
+FrtaCodingTag::Deserialize(TagBuffer i)
+{
+  m_transmitter = Ipv4Address(i.ReadU32());
+}
+
+void
+FrtaCodingTag::Print(std::ostream &os) const
+{
+  os << "Transmitter=" << m_transmitter;
+}
+
+void
+FrtaCodingTag::SetTransmitter(Ipv4Address transmitter)
+{
+  m_transmitter = transmitter;
+}
+
+Ipv4Address
+FrtaCodingTag::GetTransmitter(void) const
+{
+  return m_transmitter;
+}
+
+//-----------------------------------------------------------------------------
+// FrtaDeferredTag Implementation
+//-----------------------------------------------------------------------------
+
+NS_OBJECT_ENSURE_REGISTERED(FrtaDeferredTag);
+
+TypeId
+FrtaDeferredTag::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaDeferredTag")
+    .SetParent<Tag>()
+    .SetGroupName("Internet")
+    .AddConstructor<FrtaDeferredTag>();
+  return tid;
+}
+
+TypeId
+FrtaDeferredTag::GetInstanceTypeId(void) const
+{
+  return GetTypeId();
+}
+
+uint32_t
+FrtaDeferredTag::GetSerializedSize(void) const
+{
+  return 0;
+}
+
+void
+FrtaDeferredTag::Serialize(TagBuffer) const
+{
+}
+
+void
+FrtaDeferredTag::Deserialize(TagBuffer)
+{
+}
+
+void
+FrtaDeferredTag::Print(std::ostream &os) const
+{
+  os << "Deferred";
+}
+
+/**
+ * \brief Read the transport ports of a packet that starts with a TCP or UDP header
+ * \return false for other protocols
+ */
+static bool
+ReadPorts(Ptr<const Packet> p, const Ipv4Header& header, uint16_t& sourcePort,
+          uint16_t& destinationPort)
+{
+  uint8_t ports[4];
+  if ((header.GetProtocol() == 6 || header.GetProtocol() == 17) &&
+      p->CopyData(ports, sizeof(ports)) == sizeof(ports))
+  {
+    sourcePort = (ports[0] << 8) | ports[1];
+    destinationPort = (ports[2] << 8) | ports[3];
+    return true;
+  }
+  return false;
+}
+
+/**
+ * \brief Whether a packet with the given ports is an FRTA control packet
+ *
+ * FRTA sockets send from and to FRTA_PORT, so application traffic to that
+ * port, which comes from an ephemeral port, is still treated as data.
+ */
+static bool
+IsControlPacket(const Ipv4Header& header, uint16_t sourcePort, uint16_t destinationPort)
+{
+  return header.GetProtocol() == 17 && sourcePort == FrtaRoutingProtocol::FRTA_PORT &&
+         destinationPort == FrtaRoutingProtocol::FRTA_PORT;
+}
+
 //-----------------------------------------------------------------------------
 // FrtaRoutingProtocol Implementation
 //-----------------------------------------------------------------------------
 
 NS_OBJECT_ENSURE_REGISTERED(FrtaRoutingProtocol);
 
+template <>
+TypeId
+FrtaDefaultRoutingProtocol::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaDefaultRoutingProtocol")
+                          .SetParent<FrtaRoutingProtocol>()
+                          .SetGroupName("Internet")
+                          .AddConstructor<FrtaDefaultRoutingProtocol>();
+  return tid;
+}
+
+template <>
+TypeId
+FrtaConservativeRoutingProtocol::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaConservativeRoutingProtocol")
+                          .SetParent<FrtaRoutingProtocol>()
+                          .SetGroupName("Internet")
+                          .AddConstructor<FrtaConservativeRoutingProtocol>();
+  return tid;
+}
+
+template <>
+TypeId
+FrtaLenientRoutingProtocol::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaLenientRoutingProtocol")
+                          .SetParent<FrtaRoutingProtocol>()
+                          .SetGroupName("Internet")
+                          .AddConstructor<FrtaLenientRoutingProtocol>();
+  return tid;
+}
+
+NS_OBJECT_ENSURE_REGISTERED(FrtaDefaultRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED(FrtaConservativeRoutingProtocol);
+NS_OBJECT_ENSURE_REGISTERED(FrtaLenientRoutingProtocol);
+
 TypeId
 FrtaRoutingProtocol::GetTypeId(void)
 {
   static TypeId tid = TypeId("ns3::FrtaRoutingProtocol")
                           .SetParent<Ipv4RoutingProtocol>()
                           .SetGroupName("Internet")
-                          .AddConstructor<FrtaRoutingProtocol>();
+                          .AddAttribute("UpdateInterval",
+                                        "Interval between periodic routing updates.",
+                                        TimeValue(Seconds(30.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_updateInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("ExpectedNodes",
+                                        "Expected network size, used to pre-size per-node state.",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_expectedNodes),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MaxRouteCacheEntries",
+                                        "Maximum number of route cache entries (0 = unbounded).",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxRouteCacheEntries),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MaxTrustEntries",
+                                        "Maximum number of trust and packet count entries (0 = unbounded).",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxTrustEntries),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MaxCollisionStatsEntries",
+                                        "Maximum number of per-node and per-link collision "
+                                        "statistics entries (0 = unbounded).",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxCollisionStatsEntries),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("MaxPathCacheEntries",
+                                        "Maximum number of cached paths and path trust values "
+                                        "(0 = unbounded).",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxPathCacheEntries),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("EvictLeastValuable",
+                                        "Evict the least valuable of the few least recently used "
+                                        "entries of a full table instead of the least recently "
+                                        "used one.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_evictLeastValuable),
+                                        MakeBooleanChecker())
+                          .AddAttribute("ControlPacketPoolSize",
+                                        "Number of control packets recycled across transmissions "
+                                        "(0 = allocate every packet).",
+                                        UintegerValue(16),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_packetPoolSize),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("RouteRequestTimeout",
+                                        "Time to wait for a route reply before giving up.",
+                                        TimeValue(Seconds(2.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_routeRequestTimeout),
+                                        MakeTimeChecker())
+                          .AddAttribute("RouteCacheTimeout",
+                                        "Lifetime of a route cache entry.",
+                                        TimeValue(Seconds(30.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_routeCacheTimeout),
+                                        MakeTimeChecker())
+                          .AddAttribute("MaxHopCount",
+                                        "Maximum hops of a forwarded route request or a found path, "
+                                        "bounded by the compile-time path capacity.",
+                                        UintegerValue(FRTA_MAX_HOP_COUNT),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxHopCount),
+                                        MakeUintegerChecker<uint32_t>(1, FRTA_MAX_HOP_COUNT))
+                          .AddAttribute("MinPathTrust",
+                                        "Minimum trust of a route or path considered usable.",
+                                        DoubleValue(0.5),
+                                        MakeDoubleAccessor(&FrtaRoutingProtocol::m_minPathTrust),
+                                        MakeDoubleChecker<double>(0.0, 1.0))
+                          .AddAttribute("MaxPaths",
+                                        "Maximum alternative paths kept per destination.",
+                                        UintegerValue(FRTA_MAX_PATHS),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxPaths),
+                                        MakeUintegerChecker<uint32_t>(1, FRTA_MAX_PATHS))
+                          .AddAttribute("MinJitter",
+                                        "Minimum random delay before forwarding a request or replying.",
+                                        TimeValue(MicroSeconds(0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_minJitter),
+                                        MakeTimeChecker())
+                          .AddAttribute("MaxJitter",
+                                        "Maximum random delay before forwarding a request or replying.",
+                                        TimeValue(MicroSeconds(1000)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_maxJitter),
+                                        MakeTimeChecker())
+                          .AddAttribute("FlowPinning",
+                                        "Pin each flow to one next hop when several are known.",
+                                        BooleanValue(true),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_flowPinning),
+                                        MakeBooleanChecker())
+                          .AddAttribute("FlowletGap",
+                                        "Idle time after which a pinned flow may move to another "
+                                        "next hop; should exceed the delay difference of the paths.",
+                                        TimeValue(MilliSeconds(50)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_flowletGap),
+                                        MakeTimeChecker())
+                          .AddAttribute("FlowIdleTimeout",
+                                        "Idle time after which a flow entry is removed.",
+                                        TimeValue(Seconds(10.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_flowIdleTimeout),
+                                        MakeTimeChecker())
+                          .AddAttribute("MaxFlowEntries",
+                                        "Maximum number of pinned flows (0 = unbounded).",
+                                        UintegerValue(0),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxFlowEntries),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("OpportunisticForwarding",
+                                        "Broadcast multi-hop data packets with a list of candidate "
+                                        "forwarders ranked by trust and path cost.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_opportunistic),
+                                        MakeBooleanChecker())
+                          .AddAttribute("CandidateSlot",
+                                        "Forwarding delay added per candidate rank; should exceed "
+                                        "the time to transmit one data packet.",
+                                        TimeValue(MilliSeconds(2)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_candidateSlot),
+                                        MakeTimeChecker())
+                          .AddAttribute("MaxCandidates",
+                                        "Maximum number of candidate forwarders per packet.",
+                                        UintegerValue(3),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_maxCandidates),
+                                        MakeUintegerChecker<uint32_t>(1, FRTA_MAX_PATHS))
+                          .AddAttribute("NetworkCoding",
+                                        "XOR packets travelling in opposite directions through a "
+                                        "relay into one broadcast.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_networkCoding),
+                                        MakeBooleanChecker())
+                          .AddAttribute("CodingHoldTime",
+                                        "Time a relayed packet waits for a packet it can be coded with.",
+                                        TimeValue(MilliSeconds(5)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_codingHoldTime),
+                                        MakeTimeChecker())
+                          .AddAttribute("ReceptionReportInterval",
+                                        "Interval between beacons reporting the packets a node holds.",
+                                        TimeValue(MilliSeconds(100)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_receptionReportInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("Aggregation",
+                                        "Aggregate small packets relayed to the same next hop into "
+                                        "one frame.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_aggregation),
+                                        MakeBooleanChecker())
+                          .AddAttribute("AggregationDelay",
+                                        "Longest time a relayed packet waits to be aggregated.",
+                                        TimeValue(MilliSeconds(2)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_aggregationDelay),
+                                        MakeTimeChecker())
+                          .AddAttribute("AggregationMaxPacketSize",
+                                        "Largest relayed packet, in bytes without its IPv4 header, "
+                                        "that is aggregated.",
+                                        UintegerValue(200),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_aggregationMaxPacketSize),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("AggregationMaxFrameSize",
+                                        "Largest aggregate frame, in bytes of aggregated packets.",
+                                        UintegerValue(1400),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_aggregationMaxFrameSize),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("DelayTolerant",
+                                        "Store packets of the delay-tolerant class that have no "
+                                        "route and hand them to encountered neighbors.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_delayTolerant),
+                                        MakeBooleanChecker())
+                          .AddAttribute("DelayTolerantDscp",
+                                        "DSCP of the packets that are carried when no route exists.",
+                                        UintegerValue(8),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_dtnDscp),
+                                        MakeUintegerChecker<uint32_t>(0, 63))
+                          .AddAttribute("DtnBeaconInterval",
+                                        "Interval between beacons advertising delivery predictabilities.",
+                                        TimeValue(Seconds(1.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_dtnBeaconInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("DtnBundleLifetime",
+                                        "Time after which a stored packet is dropped.",
+                                        TimeValue(Seconds(300.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_dtnBundleLifetime),
+                                        MakeTimeChecker())
+                          .AddAttribute("DtnMaxCustody",
+                                        "Custody transfers after which a bundle is only handed to "
+                                        "its destination.",
+                                        UintegerValue(10),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_dtnMaxCustody),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("DtnStoreSize",
+                                        "Maximum number of bundles a node carries, 0 for unbounded.",
+                                        UintegerValue(256),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_dtnStoreSize),
+                                        MakeUintegerChecker<uint32_t>())
+                          .AddAttribute("Watchdog",
+                                        "Overhear next hops to verify that they forward the packets "
+                                        "handed to them, and route around those that do not.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_watchdog),
+                                        MakeBooleanChecker())
+                          .AddAttribute("WatchdogTimeout",
+                                        "Time a next hop has to forward a packet.",
+                                        TimeValue(MilliSeconds(200)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_watchdogTimeout),
+                                        MakeTimeChecker())
+                          .AddAttribute("WatchdogWindow",
+                                        "Number of recent packets the forward ratio of a next hop "
+                                        "is taken over.",
+                                        UintegerValue(32),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_watchdogWindow),
+                                        MakeUintegerChecker<uint32_t>(1, FrtaWatchdog::MAX_WINDOW))
+                          .AddAttribute("WatchdogThreshold",
+                                        "Forward ratio below which a next hop is blacklisted.",
+                                        DoubleValue(0.5),
+                                        MakeDoubleAccessor(&FrtaRoutingProtocol::m_watchdogThreshold),
+                                        MakeDoubleChecker<double>(0.0, 1.0))
+                          .AddAttribute("BlacklistTime",
+                                        "Time a next hop that drops packets is avoided.",
+                                        TimeValue(Seconds(30.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_blacklistTime),
+                                        MakeTimeChecker())
+                          .AddAttribute("BetaTrust",
+                                        "Derive trust from per-node success and failure evidence "
+                                        "and weight path scores by the confidence in it.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_betaTrust),
+                                        MakeBooleanChecker())
+                          .AddAttribute("TrustHalfLife",
+                                        "Time after which trust evidence counts half, 0 for no decay.",
+                                        TimeValue(Seconds(300.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_trustHalfLife),
+                                        MakeTimeChecker())
+                          .AddAttribute("RecommendationTrust",
+                                        "Share direct trust with neighbors and judge nodes never "
+                                        "observed by the opinions of the network.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_recommendationTrust),
+                                        MakeBooleanChecker())
+                          .AddAttribute("TrustVectorInterval",
+                                        "Interval between broadcasts of a node's direct trust.",
+                                        TimeValue(Seconds(2.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_trustVectorInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("RecommendationWork",
+                                        "Trust graph entries visited by the recommendation "
+                                        "iteration per trust vector interval.",
+                                        UintegerValue(4096),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_recommendationWork),
+                                        MakeUintegerChecker<uint32_t>(1))
+                          .AddAttribute("AntiEntropy",
+                                        "Reconcile trust tables with neighbors by exchanging bucket "
+                                        "digests and only the buckets that differ.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_antiEntropy),
+                                        MakeBooleanChecker())
+                          .AddAttribute("AntiEntropyInterval",
+                                        "Interval between trust table digests.",
+                                        TimeValue(Seconds(1.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_antiEntropyInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("AntiEntropyFanout",
+                                        "Maximum number of neighbors asked for differing buckets "
+                                        "per interval.",
+                                        UintegerValue(2),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_antiEntropyFanout),
+                                        MakeUintegerChecker<uint32_t>(1))
+                          .AddAttribute("LoopDetection",
+                                        "Drop a packet this node already forwarded and invalidate "
+                                        "the route that looped it back.",
+                                        BooleanValue(true),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_loopDetection),
+                                        MakeBooleanChecker())
+                          .AddAttribute("LoopDetectionLifetime",
+                                        "Time a forwarded packet is remembered for loop detection.",
+                                        TimeValue(MilliSeconds(500)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_loopDetectionLifetime),
+                                        MakeTimeChecker())
+                          .AddAttribute("ControlPriority",
+                                        "Socket priority of FRTA control packets. 6 selects the "
+                                        "voice access category of QoS Wi-Fi and the first band of "
+                                        "the queue disc installed by FrtaRoutingHelper.",
+                                        UintegerValue(6),
+                                        MakeUintegerAccessor(&FrtaRoutingProtocol::m_controlPriority),
+                                        MakeUintegerChecker<uint8_t>(0, 7))
+                          .AddAttribute("Multicast",
+                                        "Forward multicast traffic along source trees built from "
+                                        "the most trusted reverse paths.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_multicast),
+                                        MakeBooleanChecker())
+                          .AddAttribute("MulticastQueryInterval",
+                                        "Interval between the tree queries of a multicast source. "
+                                        "Tree state lasts three intervals.",
+                                        TimeValue(Seconds(1.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_multicastQueryInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("ChannelDiversity",
+                                        "Prefer routes whose consecutive hops use different "
+                                        "channels and exchange channel loads with neighbors.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_channelDiversity),
+                                        MakeBooleanChecker())
+                          .AddAttribute("ChannelDiversityWeight",
+                                        "Weight of the hops on the most used channel of a path "
+                                        "against its hop count, as in WCETT. 0 ranks paths by "
+                                        "hop count alone.",
+                                        DoubleValue(0.5),
+                                        MakeDoubleAccessor(&FrtaRoutingProtocol::m_channelDiversityWeight),
+                                        MakeDoubleChecker<double>(0.0, 1.0))
+                          .AddAttribute("ChannelReportInterval",
+                                        "Interval between reports of the channel and load of each "
+                                        "radio.",
+                                        TimeValue(Seconds(1.0)),
+                                        MakeTimeAccessor(&FrtaRoutingProtocol::m_channelReportInterval),
+                                        MakeTimeChecker())
+                          .AddAttribute("TxPowerControl",
+                                        "Learn the path loss to each neighbor from its broadcasts "
+                                        "and send to it at the lowest power that keeps "
+                                        "TxPowerMargin above the receiver sensitivity. Powers are "
+                                        "applied on Wi-Fi devices using "
+                                        "ns3::FrtaTxPowerWifiManager. Routes through neighbors "
+                                        "reached at low power are preferred.",
+                                        BooleanValue(false),
+                                        MakeBooleanAccessor(&FrtaRoutingProtocol::m_txPowerControl),
+                                        MakeBooleanChecker())
+                          .AddAttribute("TxPowerMargin",
+                                        "Margin in dB above the receiver sensitivity that transmit "
+                                        "power control aims for.",
+                                        DoubleValue(10.0),
+                                        MakeDoubleAccessor(&FrtaRoutingProtocol::m_txPowerMargin),
+                                        MakeDoubleChecker<double>(0.0));
   return tid;
 }
 
 FrtaRoutingProtocol::FrtaRoutingProtocol() 
   : m_ipv4(0),
     m_updateInterval(Seconds(30.0)),
-    m_running(false)
+    m_running(false),
+    m_initialized(false),
+    m_routeSeqNo(0),
+    m_expectedNodes(0),
+    m_routeRequestTimeout(Seconds(2.0)),
+    m_routeCacheTimeout(Seconds(30.0)),
+    m_maxHopCount(FRTA_MAX_HOP_COUNT),
+    m_minPathTrust(0.5),
+    m_maxPaths(FRTA_MAX_PATHS),
+    m_minJitter(MicroSeconds(0)),
+    m_maxJitter(MicroSeconds(1000)),
+    m_maxRouteCacheEntries(0),
+    m_maxTrustEntries(0),
+    m_maxCollisionStatsEntries(0),
+    m_maxPathCacheEntries(0),
+    m_evictLeastValuable(false),
+    m_packetPoolSize(16),
+    m_flowPinning(true),
+    m_flowletGap(MilliSeconds(50)),
+    m_flowIdleTimeout(Seconds(10.0)),
+    m_maxFlowEntries(0),
+    m_opportunistic(false),
+    m_candidateSlot(MilliSeconds(2)),
+    m_maxCandidates(3),
+    m_networkCoding(false),
+    m_codingHoldTime(MilliSeconds(5)),
+    m_receptionReportInterval(MilliSeconds(100)),
+    m_aggregation(false),
+    m_aggregationDelay(MilliSeconds(2)),
+    m_aggregationMaxPacketSize(200),
+    m_aggregationMaxFrameSize(1400),
+    m_delayTolerant(false),
+    m_dtnDscp(8),
+    m_dtnBeaconInterval(Seconds(1.0)),
+    m_dtnBundleLifetime(Seconds(300.0)),
+    m_dtnMaxCustody(10),
+    m_dtnStoreSize(256),
+    m_watchdog(false),
+    m_watchdogTimeout(MilliSeconds(200)),
+    m_watchdogWindow(32),
+    m_watchdogThreshold(0.5),
+    m_blacklistTime(Seconds(30.0)),
+    m_betaTrust(false),
+    m_trustHalfLife(Seconds(300.0)),
+    m_recommendationTrust(false),
+    m_trustVectorInterval(Seconds(2.0)),
+    m_recommendationWork(4096),
+    m_antiEntropy(false),
+    m_antiEntropyInterval(Seconds(1.0)),
+    m_antiEntropyFanout(2),
+    m_trustRequests(0),
+    m_loopDetection(true),
+    m_loopDetectionLifetime(MilliSeconds(500)),
+    m_loopsDetected(0),
+    m_controlPriority(6),
+    m_multicast(false),
+    m_multicastQueryInterval(Seconds(1.0)),
+    m_multicastSequence(0),
+    m_channelDiversity(false),
+    m_channelDiversityWeight(0.5),
+    m_channelReportInterval(Seconds(1.0)),
+    m_txPowerControl(false),
+    m_txPowerMargin(10.0),
+    m_nextWaiterId(0)
 {
   NS_LOG_FUNCTION(this);
   m_random = CreateObject<UniformRandomVariable>();
-  g_protocolLog << "FrtaRoutingProtocol initialized at " << Simulator::Now().GetSeconds() << "s\n";
+  m_collisionDetector.SetScratchResource(m_scratch.GetResource());
 }
 
 FrtaRoutingProtocol::~FrtaRoutingProtocol()
 {
   NS_LOG_FUNCTION(this);
-  g_protocolLog << "FrtaRoutingProtocol destroyed at " << Simulator::Now().GetSeconds() << "s\n";
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::DoInitialize()
+FrtaRoutingProtocolT<Policy>::DoInitialize()
 {
   NS_LOG_FUNCTION(this);
+  // Addresses are assigned by now, so the socket and the local routes are
+  // set up exactly once here instead of on every interface notification.
+  ApplyStateBounds();
+  m_packetPool.SetCapacity(m_packetPoolSize, CONTROL_PACKET_HEADROOM);
   if (m_ipv4)
   {
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+      CreateSocket(i);
+    }
     InitializeRoutingTable();
+    m_trustReplica.SetSelf(GetMainAddress());
+    if (m_networkCoding || m_watchdog)
+    {
+      m_ipv4->TraceConnectWithoutContext("Tx", MakeCallback(&FrtaRoutingProtocolT::NotifyTx, this));
+    }
+    if (m_networkCoding)
+    {
+      Simulator::Schedule(m_receptionReportInterval + GetJitter(),
+                          &FrtaRoutingProtocolT::SendReceptionReport, this);
+    }
+    if (m_watchdog)
+    {
+      m_monitor.SetTimeout(m_watchdogTimeout);
+      m_monitor.SetWindow(m_watchdogWindow);
+      m_monitor.SetThreshold(m_watchdogThreshold);
+      m_monitor.SetBlacklistTime(m_blacklistTime);
+      m_monitor.SetCapacity(m_maxTrustEntries);
+      for (const auto& socket : m_sockets)
+      {
+        m_ipv4->GetObject<Node>()->RegisterProtocolHandler(
+          MakeCallback(&FrtaRoutingProtocolT::Overhear, this), Ipv4L3Protocol::PROT_NUMBER,
+          m_ipv4->GetNetDevice(socket.first), true);
+      }
+    }
+    if (m_delayTolerant)
+    {
+      m_bundles.SetCapacity(m_dtnStoreSize);
+      m_predictability.SetSelf(GetMainAddress());
+      m_predictability.SetAgingUnit(m_dtnBeaconInterval);
+      Simulator::Schedule(m_dtnBeaconInterval + GetJitter(), &FrtaRoutingProtocolT::DtnTick, this);
+    }
+    if (m_antiEntropy)
+    {
+      Simulator::Schedule(m_antiEntropyInterval + GetJitter(),
+                          &FrtaRoutingProtocolT::SendTrustDigest, this);
+    }
+    if (m_recommendationTrust)
+    {
+      // Opinions of a neighbor last until a few of its vectors were missed
+      m_recommendations.SetSelf(GetMainAddress());
+      m_recommendations.SetLifetime(3 * m_trustVectorInterval);
+      Simulator::Schedule(m_trustVectorInterval + GetJitter(),
+                          &FrtaRoutingProtocolT::SendTrustVector, this);
+    }
+    if (m_channelDiversity)
+    {
+      m_ipv4->TraceConnectWithoutContext("Tx",
+                                         MakeCallback(&FrtaRoutingProtocolT::NoteChannelTraffic, this));
+      m_ipv4->TraceConnectWithoutContext("Rx",
+                                         MakeCallback(&FrtaRoutingProtocolT::NoteChannelTraffic, this));
+      Simulator::Schedule(m_channelReportInterval + GetJitter(),
+                          &FrtaRoutingProtocolT::SendChannelReport, this);
+    }
+    if (m_txPowerControl)
+    {
+      // The interface rides along as the trace context
+      for (const auto& socket : m_sockets)
+      {
+        Ptr<WifiPhy> phy = GetWifiPhy(socket.first);
+        if (phy)
+        {
+          phy->TraceConnect("MonitorSnifferRx", std::to_string(socket.first),
+                            MakeCallback(&FrtaRoutingProtocolT::NoteRxPower, this));
+        }
+      }
+    }
   }
   Ipv4RoutingProtocol::DoInitialize();
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::DoDispose()
+FrtaRoutingProtocolT<Policy>::ApplyStateBounds()
+{
+  NS_LOG_FUNCTION(this);
+  FrtaEvictionPolicy policy = m_evictLeastValuable ? FRTA_EVICT_LEAST_VALUABLE : FRTA_EVICT_LRU;
+  
+  // Expired routes go first, then long and weakly trusted ones. Local
+  // interface routes are never chosen.
+  m_routeCache.SetEvictionPolicy(policy, [this](const Ipv4Address&, const RouteEntry& entry) {
+    if (entry.hopCount == 0)
+    {
+      return std::numeric_limits<double>::max();
+    }
+    if (Simulator::Now() - entry.lastUpdate >= m_routeCacheTimeout)
+    {
+      return -1.0;
+    }
+    return entry.trust / (1.0 + entry.hopCount);
+  });
+  // A trust value close to the default carries the least information
+  double defaultTrust = GetDefaultTrust();
+  m_trustValues.SetEvictionPolicy(policy, [defaultTrust](const Ipv4Address&, double trust) {
+    return std::abs(trust - defaultTrust);
+  });
+  m_reportedTrust.SetEvictionPolicy(policy, [defaultTrust](const Ipv4Address&, double trust) {
+    return std::abs(trust - defaultTrust);
+  });
+  m_packetCounts.SetEvictionPolicy(policy, [](const Ipv4Address&, uint32_t count) {
+    return static_cast<double>(count);
+  });
+  m_pathTrustValues.SetEvictionPolicy(policy, [](const FrtaPath&, double trust) {
+    return trust;
+  });
+  m_cachedPaths.SetEvictionPolicy(policy);
+  m_routeRequestTime.SetEvictionPolicy(policy, [](const Ipv4Address&, const Time& requested) {
+    return requested.GetSeconds();
+  });
+  
+  m_routeCache.SetCapacity(m_maxRouteCacheEntries);
+  m_trustValues.SetCapacity(m_maxTrustEntries);
+  m_reportedTrust.SetCapacity(m_maxTrustEntries);
+  m_packetCounts.SetCapacity(m_maxTrustEntries);
+  m_pathTrustValues.SetCapacity(m_maxPathCacheEntries);
+  m_cachedPaths.SetCapacity(m_maxPathCacheEntries);
+  m_routeRequestTime.SetCapacity(m_maxPathCacheEntries);
+  m_collisionDetector.SetMaxEntries(m_maxCollisionStatsEntries, policy);
+  
+  m_alternateHops.SetCapacity(m_maxRouteCacheEntries);
+  m_neighborInterfaces.SetCapacity(m_maxRouteCacheEntries);
+  m_neighborChannels.SetCapacity(m_maxRouteCacheEntries);
+  m_linkLosses.SetCapacity(m_maxRouteCacheEntries);
+  m_flowTable.SetFlowletGap(m_flowletGap);
+  m_flowTable.SetIdleTimeout(m_flowIdleTimeout);
+  m_flowTable.SetMaxEntries(m_maxFlowEntries);
+  m_trustEngine.SetHalfLife(m_trustHalfLife);
+  m_trustEngine.SetCapacity(m_maxTrustEntries, policy);
+  m_forwardedPackets.SetLifetime(m_loopDetectionLifetime);
+  m_multicastTrees.SetLifetime(3 * m_multicastQueryInterval);
+}
+
+double
+FrtaRoutingProtocol::GetPacketPoolHitRate() const
+{
+  return m_packetPool.GetHitRate();
+}
+
+uint64_t
+FrtaRoutingProtocol::GetStateEvictions() const
+{
+  return m_routeCache.GetEvictions() + m_trustValues.GetEvictions() +
+         m_packetCounts.GetEvictions() + m_pathTrustValues.GetEvictions() +
+         m_cachedPaths.GetEvictions() + m_routeRequestTime.GetEvictions() +
+         m_collisionDetector.GetEvictions() + m_trustEngine.GetEvictions() +
+         m_nodeIds.GetEvictions();
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::DoDispose()
 {
   NS_LOG_FUNCTION(this);
   m_ipv4 = 0;
-  if (m_socket)
+  for (auto& socket : m_sockets)
+  {
+    socket.second->Close();
+  }
+  m_sockets.clear();
+  for (auto& socket : m_broadcastSockets)
   {
-    m_socket->Close();
-    m_socket = 0;
+    socket.second->Close();
   }
+  m_broadcastSockets.clear();
+  m_neighborInterfaces.clear();
+  m_interfaceChannels.clear();
+  m_radioLoads.clear();
+  m_neighborChannels.clear();
+  m_linkLosses.clear();
   m_routingTable.clear();
   m_trustValues.clear();
+  m_reportedTrust.clear();
   m_packetCounts.clear();
+  m_packetPool.Clear();
+  m_flowTable.Clear();
+  for (auto& waiters : m_routeWaiters)
+  {
+    for (auto& waiter : waiters.second)
+    {
+      waiter.timeoutEvent.Cancel();
+    }
+  }
+  m_routeWaiters.clear();
+  for (auto& pending : m_pendingForwards)
+  {
+    pending.second.event.Cancel();
+  }
+  m_pendingForwards.clear();
+  m_seenPackets.Clear();
+  m_forwardedPackets.Clear();
+  m_multicastSeen.Clear();
+  m_multicastTrees.Clear();
+  m_multicastQueryEvent.Cancel();
+  for (auto& queue : m_codingQueues)
+  {
+    for (auto& native : queue.second)
+    {
+      native.flushEvent.Cancel();
+    }
+  }
+  m_codingQueues.clear();
+  m_coder.Clear();
+  for (auto& buffer : m_aggregationBuffers)
+  {
+    buffer.second.flushEvent.Cancel();
+  }
+  m_aggregationBuffers.clear();
+  m_bundles.Clear();
+  m_predictability.Clear();
+  m_monitor.Clear();
+  m_trustEngine.Clear();
+  m_recommendations.Clear();
+  m_trustReplica.Clear();
   Ipv4RoutingProtocol::DoDispose();
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::Start()
+FrtaRoutingProtocolT<Policy>::Start()
 {
   NS_LOG_FUNCTION(this);
   if (!m_running)
   {
     m_running = true;
     
-    // Create socket if not already created
-    if (!m_socket)
-    {
-      Ptr<Node> node = m_ipv4->GetObject<Node>();
-      // Create socket for FRTA protocol
-      Ptr<Socket> socket = Socket::CreateSocket(node, TypeId::LookupByName("ns3::UdpSocketFactory"));
-      socket->SetAllowBroadcast(true);
-      socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
-      socket->SetRecvCallback(MakeCallback(&FrtaRoutingProtocol::ReceiveRoutingPacket, this));
-      m_socket = socket;
-      
-      g_protocolLog << "Created socket for node " << node->GetId() 
-                    << " at " << Simulator::Now().GetSeconds() << "s\n";
+    for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
+    {
+      CreateSocket(i);
+    }
+    if (!m_initialized)
+    {
+      InitializeRoutingTable();
     }
     
-    // Initialize routes and start periodic updates
-    InitializeRoutingTable();
+    // Start periodic updates
     SendRoutingUpdate();
+    Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocolT::BroadcastRouteAdvertisement, this);
     
     // Schedule periodic route cache cleanup
-    Simulator::Schedule(ROUTE_CACHE_TIMEOUT, &FrtaRoutingProtocol::CleanupRoutingTable, this);
+    Simulator::Schedule(m_routeCacheTimeout, &FrtaRoutingProtocolT::CleanupRoutingTable, this);
   }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::Stop()
+FrtaRoutingProtocolT<Policy>::Stop()
 {
   NS_LOG_FUNCTION(this);
   if (m_running)
@@ -182,68 +1063,273 @@ FrtaRoutingProtocol::Stop()
   }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::SetUpdateInterval(Time interval)
+FrtaRoutingProtocolT<Policy>::SetUpdateInterval(Time interval)
 {
   NS_LOG_FUNCTION(this << interval);
   m_updateInterval = interval;
 }
 
 void
-FrtaRoutingProtocol::SetIpv4(Ptr<Ipv4> ipv4)
+FrtaRoutingProtocol::EnableProtocolLog(bool enable)
+{
+  // A stream in a failed state skips formatting entirely, which keeps the
+  // logging call sites cheap when the log is switched off.
+  if (enable)
+  {
+    g_protocolLog.clear();
+  }
+  else
+  {
+    g_protocolLog.setstate(std::ios::badbit);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ReserveNodes(uint32_t nodes)
+{
+  NS_LOG_FUNCTION(this << nodes);
+  m_expectedNodes = nodes;
+  m_trustValues.reserve(nodes);
+  m_packetCounts.reserve(nodes);
+  m_routeCache.reserve(nodes);
+  m_nodeIds.Reserve(nodes);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SetIpv4(Ptr<Ipv4> ipv4)
 {
   NS_LOG_FUNCTION(this << ipv4);
   NS_ASSERT(ipv4 != nullptr);
   NS_ASSERT(m_ipv4 == nullptr);
   
+  // The socket and local routes are created in DoInitialize, once addresses
+  // have been assigned.
   m_ipv4 = ipv4;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::CreateSocket(uint32_t interface)
+{
+  NS_LOG_FUNCTION(this << interface);
+  if (m_sockets.count(interface) || m_ipv4->GetNAddresses(interface) == 0)
+  {
+    return;
+  }
+  Ipv4InterfaceAddress address = m_ipv4->GetAddress(interface, 0);
+  if (address.GetLocal() == Ipv4Address::GetLoopback())
+  {
+    return;
+  }
   
-  // Create socket
   Ptr<Node> node = m_ipv4->GetObject<Node>();
   NS_ASSERT(node != nullptr);
   
-  m_socket = Socket::CreateSocket(node, TypeId::LookupByName("ns3::UdpSocketFactory"));
-  NS_ASSERT(m_socket != nullptr);
+  // One socket per interface, so that broadcasts leave on every radio and
+  // the interface of a received packet is known
+  Ptr<Socket> socket = Socket::CreateSocket(node, UdpSocketFactory::GetTypeId());
+  NS_ASSERT(socket != nullptr);
   
-  m_socket->SetAllowBroadcast(true);
-  m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), 9));
-  m_socket->SetRecvCallback(MakeCallback(&FrtaRoutingProtocol::ReceiveRoutingPacket, this));
+  socket->SetAllowBroadcast(true);
+  socket->SetPriority(m_controlPriority);
+  socket->Bind(InetSocketAddress(address.GetLocal(), FRTA_PORT));
+  socket->BindToNetDevice(m_ipv4->GetNetDevice(interface));
+  socket->SetRecvCallback(MakeCallback(&FrtaRoutingProtocolT::ReceiveRoutingPacket, this));
+  m_sockets[interface] = socket;
   
-  if (m_running)
-  {
-    InitializeRoutingTable();
+  // A socket bound to a unicast address does not receive limited
+  // broadcasts; IPv4 hands them to sockets bound to the subnet broadcast
+  Ptr<Socket> broadcastSocket = Socket::CreateSocket(node, UdpSocketFactory::GetTypeId());
+  NS_ASSERT(broadcastSocket != nullptr);
+  
+  broadcastSocket->SetAllowBroadcast(true);
+  broadcastSocket->Bind(InetSocketAddress(address.GetBroadcast(), FRTA_PORT));
+  broadcastSocket->BindToNetDevice(m_ipv4->GetNetDevice(interface));
+  broadcastSocket->SetRecvCallback(MakeCallback(&FrtaRoutingProtocolT::ReceiveRoutingPacket, this));
+  m_broadcastSockets[interface] = broadcastSocket;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::CloseSocket(uint32_t interface)
+{
+  NS_LOG_FUNCTION(this << interface);
+  auto it = m_sockets.find(interface);
+  if (it != m_sockets.end())
+  {
+    it->second->Close();
+    m_sockets.erase(it);
+  }
+  it = m_broadcastSockets.find(interface);
+  if (it != m_broadcastSockets.end())
+  {
+    it->second->Close();
+    m_broadcastSockets.erase(it);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::BroadcastControl(Ptr<Packet> packet)
+{
+  for (auto it = m_sockets.begin(); it != m_sockets.end(); ++it)
+  {
+    Ptr<Packet> copy = std::next(it) == m_sockets.end() ? packet : packet->Copy();
+    it->second->SendTo(copy, 0, InetSocketAddress(Ipv4Address::GetBroadcast(), FRTA_PORT));
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendControl(Ptr<Packet> packet, Ipv4Address destination, uint32_t interface)
+{
+  auto it = m_sockets.find(interface);
+  if (it == m_sockets.end())
+  {
+    NS_LOG_LOGIC("No FRTA socket on interface " << interface);
+    return;
+  }
+  it->second->SendTo(packet, 0, InetSocketAddress(destination, FRTA_PORT));
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::IsOwnAddress(Ipv4Address address) const
+{
+  return m_ipv4->GetInterfaceForAddress(address) >= 0;
+}
+
+template <typename Policy>
+int32_t
+FrtaRoutingProtocolT<Policy>::GetMainInterface() const
+{
+  return m_sockets.empty() ? -1 : static_cast<int32_t>(m_sockets.begin()->first);
+}
+
+template <typename Policy>
+Ipv4Address
+FrtaRoutingProtocolT<Policy>::GetMainAddress() const
+{
+  int32_t interface = GetMainInterface();
+  return interface < 0 ? Ipv4Address::GetZero() : m_ipv4->GetAddress(interface, 0).GetLocal();
+}
+
+template <typename Policy>
+uint32_t
+FrtaRoutingProtocolT<Policy>::GetInterfaceForNeighbor(Ipv4Address neighbor) const
+{
+  // Own addresses, then the interface the neighbor was heard on, then the
+  // interface whose subnet holds it
+  int32_t local = m_ipv4->GetInterfaceForAddress(neighbor);
+  if (local >= 0)
+  {
+    return local;
+  }
+  auto it = m_neighborInterfaces.find(neighbor);
+  if (it != m_neighborInterfaces.end())
+  {
+    return it->second;
+  }
+  for (const auto& socket : m_sockets)
+  {
+    Ipv4InterfaceAddress address = m_ipv4->GetAddress(socket.first, 0);
+    if (address.GetLocal().CombineMask(address.GetMask()) == neighbor.CombineMask(address.GetMask()))
+    {
+      return socket.first;
+    }
   }
+  return m_sockets.empty() ? 1 : m_sockets.begin()->first;
+}
+
+template <typename Policy>
+Ptr<Ipv4Route>
+FrtaRoutingProtocolT<Policy>::CreateRoute(Ipv4Address destination, Ipv4Address gateway,
+                                          uint32_t interface) const
+{
+  Ptr<Ipv4Route> route = Create<Ipv4Route>();
+  route->SetDestination(destination);
+  route->SetGateway(gateway);
+  route->SetSource(m_ipv4->GetAddress(interface, 0).GetLocal());
+  route->SetOutputDevice(m_ipv4->GetNetDevice(interface));
+  return route;
 }
 
+template <typename Policy>
 Ptr<Ipv4Route>
-FrtaRoutingProtocol::RouteOutput(Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
-                                Socket::SocketErrno &sockerr)
+FrtaRoutingProtocolT<Policy>::RouteOutput(Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
+                                          Socket::SocketErrno &sockerr)
 {
   NS_LOG_FUNCTION(this << header.GetDestination());
   
   Ipv4Address destination = header.GetDestination();
   
-  // If this is a broadcast packet, create a route for it
+  // Broadcast and multicast leave on the interface of the sending socket if
+  // it is bound to one, and on the first FRTA interface otherwise
+  int32_t outputInterface = oif ? m_ipv4->GetInterfaceForDevice(oif) : GetMainInterface();
+  if ((destination.IsBroadcast() || (m_multicast && destination.IsMulticast())) &&
+      outputInterface < 0)
+  {
+    sockerr = Socket::ERROR_NOROUTETOHOST;
+    return nullptr;
+  }
   if (destination.IsBroadcast())
   {
-    Ptr<Ipv4Route> route = Create<Ipv4Route>();
-    route->SetDestination(destination);
-    route->SetGateway(Ipv4Address::GetZero());
-    route->SetSource(m_ipv4->GetAddress(1, 0).GetLocal());
-    route->SetOutputDevice(m_ipv4->GetNetDevice(1));
-    return route;
+    return CreateRoute(destination, Ipv4Address::GetZero(), outputInterface);
+  }
+  
+  // Multicast goes out as a link-layer broadcast; sending starts the queries
+  // that build the tree of this source
+  if (m_multicast && destination.IsMulticast())
+  {
+    if (m_multicastTrees.NoteSending(destination) && !m_multicastQueryEvent.IsRunning())
+    {
+      m_multicastQueryEvent = Simulator::ScheduleNow(&FrtaRoutingProtocolT::SendMulticastQueries, this);
+    }
+    return CreateRoute(destination, Ipv4Address::GetZero(), outputInterface);
   }
   
   // Check if we have a route in cache
   auto it = m_routeCache.find(destination);
   if (it != m_routeCache.end() &&
-      Simulator::Now() - it->second.lastUpdate < ROUTE_CACHE_TIMEOUT)
+      Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout)
   {
-    Ptr<Ipv4Route> route = Create<Ipv4Route>();
-    route->SetDestination(destination);
-    route->SetGateway(it->second.nextHop);
-    route->SetSource(m_ipv4->GetAddress(1, 0).GetLocal());
-    route->SetOutputDevice(m_ipv4->GetNetDevice(1));
+    // Ports are not known before the transport header is added
+    uint64_t flow = FrtaFlowTable::HashFlow(header.GetSource(), destination,
+                                            header.GetProtocol(), 0, 0);
+    Ipv4Address gateway;
+    uint32_t interface = it->second.interface;
+    FrtaCandidateTag candidates;
+    if (m_opportunistic && p && BuildCandidates(destination, it->second, candidates))
+    {
+      FrtaCandidateTag stale;
+      p->RemovePacketTag(stale);
+      p->AddPacketTag(candidates);
+      gateway = Ipv4Address::GetBroadcast();
+    }
+    else
+    {
+      gateway = SelectNextHop(destination, it->second, flow, p ? p->GetSize() : 0);
+      if (gateway != it->second.nextHop)
+      {
+        interface = GetInterfaceForNeighbor(gateway);
+      }
+      // The IPv4 header is completed after routing; the packet is watched on Tx
+      m_lastOutputDestination = destination;
+      m_lastOutputNextHop = gateway;
+    }
+    Ptr<Ipv4Route> route = CreateRoute(destination, gateway, interface);
+    
+    if (m_networkCoding && p)
+    {
+      FrtaCodingTag hop;
+      p->RemovePacketTag(hop);
+      hop.SetTransmitter(route->GetSource());
+      p->AddPacketTag(hop);
+    }
     
     sockerr = Socket::ERROR_NOTERROR;
     return route;
@@ -257,15 +1343,34 @@ FrtaRoutingProtocol::RouteOutput(Ptr<Packet> p, const Ipv4Header &header, Ptr<Ne
                   << " at " << Simulator::Now().GetSeconds() << "s\n";
   }
   
+  // Delay-tolerant packets go to the bundle store through the loopback device
+  if (m_delayTolerant && p && IsDelayTolerant(p, header))
+  {
+    FrtaDeferredTag deferred;
+    if (!p->PeekPacketTag(deferred))
+    {
+      p->AddPacketTag(deferred);
+    }
+    Ptr<Ipv4Route> route = Create<Ipv4Route>();
+    route->SetDestination(destination);
+    route->SetGateway(Ipv4Address::GetLoopback());
+    route->SetSource(GetMainAddress());
+    route->SetOutputDevice(m_ipv4->GetNetDevice(0));
+    sockerr = Socket::ERROR_NOTERROR;
+    return route;
+  }
+  
   sockerr = Socket::ERROR_NOROUTETOHOST;
   return nullptr;
 }
 
+template <typename Policy>
 bool
-FrtaRoutingProtocol::RouteInput(Ptr<const Packet> p, const Ipv4Header &header,
-                               Ptr<const NetDevice> idev, const UnicastForwardCallback &ucb,
-                               const MulticastForwardCallback &mcb,
-                               const LocalDeliverCallback &lcb, const ErrorCallback &ecb)
+FrtaRoutingProtocolT<Policy>::RouteInput(Ptr<const Packet> p, const Ipv4Header &header,
+                                         Ptr<const NetDevice> idev,
+                                         const UnicastForwardCallback &ucb,
+                                         const MulticastForwardCallback &mcb,
+                                         const LocalDeliverCallback &lcb, const ErrorCallback &ecb)
 {
   NS_LOG_FUNCTION(this << header.GetDestination());
   
@@ -276,85 +1381,179 @@ FrtaRoutingProtocol::RouteInput(Ptr<const Packet> p, const Ipv4Header &header,
     return true;
   }
   
+  if (m_multicast && header.GetDestination().IsMulticast())
+  {
+    return RouteMulticastInput(p, header, idev, mcb, lcb);
+  }
+  
+  FrtaDeferredTag deferred;
+  if (p->PeekPacketTag(deferred))
+  {
+    Ptr<Packet> packet = p->Copy();
+    packet->RemovePacketTag(deferred);
+    packet->AddHeader(header);
+    StoreBundle(packet, header.GetDestination(), m_dtnBundleLifetime, 0);
+    return true;
+  }
+  
+  FrtaCandidateTag candidates;
+  bool opportunistic = p->PeekPacketTag(candidates);
+  
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+  bool control = ReadPorts(p, header, sourcePort, destinationPort) &&
+                 IsControlPacket(header, sourcePort, destinationPort);
+  
+  // Keep data packets for decoding, and note that their transmitter holds them
+  if (m_networkCoding && !control)
+  {
+    FrtaCodingTag hop;
+    if (p->PeekPacketTag(hop))
+    {
+      m_coder.NoteNeighborHas(hop.GetTransmitter(), FrtaFingerprintCache::Fingerprint(header));
+    }
+    m_coder.Remember(header, p);
+  }
+  
   // Check if packet is destined for this node
   if (m_ipv4->IsDestinationAddress(header.GetDestination(), idev->GetIfIndex()))
   {
+    // Opportunistic packets may arrive through several candidates; the
+    // first copy is acknowledged so that the others stop forwarding it
+    if (opportunistic)
+    {
+      uint64_t fingerprint = FrtaFingerprintCache::Fingerprint(header);
+      if (!m_seenPackets.Insert(fingerprint))
+      {
+        return true;
+      }
+      SendOpportunisticAck(fingerprint, m_ipv4->GetInterfaceForDevice(idev));
+    }
     lcb(p, header, idev->GetIfIndex());
     return true;
   }
   
+  // Link-layer broadcasts reach every neighbor, candidate or not
+  if (opportunistic)
+  {
+    return ReceiveOpportunistic(p, header, candidates, ucb);
+  }
+  
   // Forward packet if we have a route
   auto it = m_routeCache.find(header.GetDestination());
   if (it != m_routeCache.end() &&
-      Simulator::Now() - it->second.lastUpdate < ROUTE_CACHE_TIMEOUT)
+      Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout)
   {
-    Ptr<Ipv4Route> route = Create<Ipv4Route>();
-    route->SetDestination(header.GetDestination());
-    route->SetGateway(it->second.nextHop);
-    route->SetSource(m_ipv4->GetAddress(1, 0).GetLocal());
-    route->SetOutputDevice(m_ipv4->GetNetDevice(1));
+    if (m_loopDetection && !control && IsLooping(header))
+    {
+      ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+      return true;
+    }
+    
+    uint64_t flow = FrtaFlowTable::HashFlow(header.GetSource(), header.GetDestination(),
+                                            header.GetProtocol(), sourcePort, destinationPort);
+    
+    Ipv4Address nextHop = SelectNextHop(header.GetDestination(), it->second, flow, p->GetSize());
+    uint32_t interface = nextHop == it->second.nextHop ? it->second.interface
+                                                       : GetInterfaceForNeighbor(nextHop);
+    Ptr<Ipv4Route> route = CreateRoute(header.GetDestination(), nextHop, interface);
+    
+    if (m_watchdog && !control)
+    {
+      Ipv4Header sent = header;
+      sent.SetTtl(header.GetTtl() - 1);
+      WatchForwarding(sent, route->GetGateway());
+    }
     
+    if (m_aggregation && !control && p->GetSize() <= m_aggregationMaxPacketSize)
+    {
+      EnqueueForAggregation(p, header, route, ucb);
+      return true;
+    }
+    if (m_networkCoding && !control)
+    {
+      EnqueueForCoding(p, header, route, ucb);
+      return true;
+    }
     ucb(route, p, header);
     return true;
   }
   
-  // No route found
+  // No route found; delay-tolerant packets are carried until one appears
+  if (m_delayTolerant && !control && IsDelayTolerant(p, header))
+  {
+    Ptr<Packet> packet = p->Copy();
+    packet->AddHeader(header);
+    StoreBundle(packet, header.GetDestination(), m_dtnBundleLifetime, 0);
+    return true;
+  }
   return false;
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::InitializeRoutingTable()
+FrtaRoutingProtocolT<Policy>::InitializeRoutingTable()
 {
   NS_LOG_FUNCTION(this);
   NS_ASSERT(m_ipv4 != nullptr);
   
+  if (m_expectedNodes > 0)
+  {
+    ReserveNodes(m_expectedNodes);
+  }
+  
   // Initialize routing table
   for (uint32_t i = 0; i < m_ipv4->GetNInterfaces(); i++)
   {
-    if (m_ipv4->GetNAddresses(i) == 0)
-    {
-      continue;
-    }
-    
-    Ipv4InterfaceAddress addr = m_ipv4->GetAddress(i, 0);
-    if (addr.GetLocal() == Ipv4Address("127.0.0.1"))
-    {
-      continue;
-    }
-    
-    // Create route for this interface
-    Ptr<Ipv4Route> route = Create<Ipv4Route>();
-    route->SetDestination(addr.GetLocal());
-    route->SetSource(addr.GetLocal());
-    route->SetGateway(addr.GetLocal());
-    route->SetOutputDevice(m_ipv4->GetNetDevice(i));
-    m_routingTable[addr.GetLocal()] = route;
-    
-    // Initialize trust values
-    m_trustValues[addr.GetLocal()] = 1.0;
-    m_packetCounts[addr.GetLocal()] = 0;
-    
-    // Initialize route cache
-    RouteEntry entry;
-    entry.nextHop = addr.GetLocal();
-    entry.trust = 1.0;
-    entry.lastUpdate = Simulator::Now();
-    entry.hopCount = 0;
-    m_routeCache[addr.GetLocal()] = entry;
-    
-    g_protocolLog << "InitializeRoutingTable: Added route for " << addr.GetLocal()
-                  << " on interface " << i << " at " << Simulator::Now().GetSeconds() << "s\n";
+    AddInterfaceRoutes(i);
+  }
+  m_initialized = true;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::AddInterfaceRoutes(uint32_t interface)
+{
+  NS_LOG_FUNCTION(this << interface);
+  
+  uint32_t i = interface;
+  if (m_ipv4->GetNAddresses(i) == 0)
+  {
+    return;
   }
   
-  if (m_running)
+  Ipv4InterfaceAddress addr = m_ipv4->GetAddress(i, 0);
+  if (addr.GetLocal() == Ipv4Address::GetLoopback())
   {
-    Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocol::SendRoutingUpdate, this);
-    Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocol::BroadcastRouteAdvertisement, this);
+    return;
   }
+    
+  // Create route for this interface
+  Ptr<Ipv4Route> route = Create<Ipv4Route>();
+  route->SetDestination(addr.GetLocal());
+  route->SetSource(addr.GetLocal());
+  route->SetGateway(addr.GetLocal());
+  route->SetOutputDevice(m_ipv4->GetNetDevice(i));
+  m_routingTable[addr.GetLocal()] = route;
+  
+  // Initialize trust values
+  m_trustValues[addr.GetLocal()] = 1.0;
+  m_packetCounts[addr.GetLocal()] = 0;
+  
+  // Initialize route cache
+  RouteEntry entry;
+  entry.nextHop = addr.GetLocal();
+  entry.trust = 1.0;
+  entry.lastUpdate = Simulator::Now();
+  entry.hopCount = 0;
+  StoreRoute(addr.GetLocal(), entry);
+  
+  NS_LOG_INFO("Added route for " << addr.GetLocal() << " on interface " << i);
 }
 
+template <typename Policy>
 Ptr<Ipv4Route>
-FrtaRoutingProtocol::SelectOptimalPath(Ipv4Address destination)
+FrtaRoutingProtocolT<Policy>::SelectOptimalPath(Ipv4Address destination)
 {
   NS_LOG_FUNCTION(this << destination);
   
@@ -362,14 +1561,10 @@ FrtaRoutingProtocol::SelectOptimalPath(Ipv4Address destination)
   auto it = m_routeCache.find(destination);
   if (it != m_routeCache.end())
   {
-    if (it->second.trust > 0.5 && 
-        Simulator::Now() - it->second.lastUpdate < ROUTE_CACHE_TIMEOUT)
+    if (it->second.trust > m_minPathTrust && 
+        Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout)
     {
-      Ptr<Ipv4Route> route = Create<Ipv4Route>();
-      route->SetDestination(destination);
-      route->SetSource(m_ipv4->GetAddress(0, 0).GetLocal());
-      route->SetGateway(it->second.nextHop);
-      route->SetOutputDevice(m_ipv4->GetNetDevice(0));
+      Ptr<Ipv4Route> route = CreateRoute(destination, it->second.nextHop, it->second.interface);
       
       g_protocolLog << "Selected optimal path to " << destination
                     << " via " << it->second.nextHop << " (trust: " << it->second.trust
@@ -390,26 +1585,16 @@ FrtaRoutingProtocol::SelectOptimalPath(Ipv4Address destination)
   return nullptr;
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::SendRouteRequest(Ipv4Address destination)
+FrtaRoutingProtocolT<Policy>::SendRouteRequest(Ipv4Address destination)
 {
   NS_LOG_FUNCTION(this << destination);
-  NS_ASSERT(m_socket != nullptr);
-  
-  // Create packet
-  Ptr<Packet> packet = Create<Packet>();
+  NS_ASSERT(!m_sockets.empty());
   
-  // Add route request header first
   RouteRequestHeader reqHeader;
   reqHeader.SetDestination(destination);
-  reqHeader.SetSource(m_ipv4->GetAddress(1, 0).GetLocal());
   reqHeader.SetHopCount(0);
-  packet->AddHeader(reqHeader);
-  
-  // Add FRTA header last (will be first when receiving)
-  FrtaHeader frtaHeader;
-  frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_REQUEST);
-  packet->AddHeader(frtaHeader);
   
   // Add to pending requests
   m_pendingRequests.insert(destination);
@@ -420,18 +1605,19 @@ FrtaRoutingProtocol::SendRouteRequest(Ipv4Address destination)
                 << " at " << Simulator::Now().GetSeconds() << "s\n";
   
   // Broadcast the request
-  m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address::GetBroadcast(), 9));
+  ForwardRouteRequest(reqHeader);
   
   // Schedule timeout
-  Simulator::Schedule(ROUTE_REQUEST_TIMEOUT, &FrtaRoutingProtocol::HandleRouteRequestTimeout,
+  Simulator::Schedule(m_routeRequestTimeout, &FrtaRoutingProtocolT::HandleRouteRequestTimeout,
                      this, destination);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::ProcessRouteRequest(Ptr<Packet> packet, Ipv4Address sender)
+FrtaRoutingProtocolT<Policy>::ProcessRouteRequest(Ptr<Packet> packet, Ipv4Address sender)
 {
   NS_LOG_FUNCTION(this << sender);
-  NS_ASSERT(m_socket != nullptr);
+  NS_ASSERT(!m_sockets.empty());
   
   // Remove FRTA header first
   FrtaHeader frtaHeader;
@@ -461,7 +1647,7 @@ FrtaRoutingProtocol::ProcessRouteRequest(Ptr<Packet> packet, Ipv4Address sender)
                 << Simulator::Now().GetSeconds() << "s\n";
   
   // Avoid processing our own requests or requests we've seen before
-  if (source == m_ipv4->GetAddress(1, 0).GetLocal())
+  if (IsOwnAddress(source))
   {
     g_protocolLog << "Ignoring own request at " << Simulator::Now().GetSeconds() << "s\n";
     return;
@@ -470,96 +1656,117 @@ FrtaRoutingProtocol::ProcessRouteRequest(Ptr<Packet> packet, Ipv4Address sender)
   // Create reverse route to source
   RouteEntry sourceEntry;
   sourceEntry.nextHop = sender;
-  sourceEntry.trust = 0.7;
+  sourceEntry.trust = GetReverseRouteTrust();
   sourceEntry.lastUpdate = Simulator::Now();
   sourceEntry.hopCount = hopCount + 1;
-  m_routeCache[source] = sourceEntry;
+  sourceEntry.channelCost = GetChannelCost(reqHeader.GetChannels());
+  if (IsBetterRoute(source, sourceEntry))
+  {
+    StoreRoute(source, sourceEntry);
+  }
+  else
+  {
+    // A copy of the request that came along a costlier or less trusted path
+    AddAlternateHop(source, sender, hopCount, sourceEntry.channelCost);
+  }
   
   // Update trust for the sender
-  UpdateTrustValue(sender, 0.7);
+  UpdateTrustValue(sender, GetReverseRouteTrust());
   
   // Check if we are the destination
-  if (destination == m_ipv4->GetAddress(1, 0).GetLocal())
+  if (IsOwnAddress(destination))
   {
     g_protocolLog << "We are destination, sending reply to " << source
                   << " via " << sender << " at " << Simulator::Now().GetSeconds() << "s\n";
-    SendRouteReply(source, sender);
+    SendRouteReply(source, sender, destination, 0, reqHeader.GetChannels());
     return;
   }
   
   // Check if we have a valid route to destination
   auto it = m_routeCache.find(destination);
   if (it != m_routeCache.end() &&
-      Simulator::Now() - it->second.lastUpdate < ROUTE_CACHE_TIMEOUT)
+      Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout)
   {
     g_protocolLog << "Found route to " << destination
                   << " via " << it->second.nextHop << ", sending reply to " << source
                   << " at " << Simulator::Now().GetSeconds() << "s\n";
-    SendRouteReply(source, sender);
+    SendRouteReply(source, sender, destination, it->second.hopCount, reqHeader.GetChannels());
     return;
   }
   
   // Forward the route request if hop count is within limit
-  if (hopCount < MAX_HOP_COUNT)
+  if (hopCount < m_maxHopCount)
   {
     // Add small random delay to avoid collisions
-    Time delay = MicroSeconds(m_random->GetInteger(0, 1000));
-    
-    // Create new packet with updated hop count
-    Ptr<Packet> forwardPacket = Create<Packet>();
-    FrtaHeader newFrtaHeader;
-    newFrtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_REQUEST);
-    forwardPacket->AddHeader(newFrtaHeader);
+    Time delay = GetJitter();
     
     reqHeader.SetHopCount(hopCount + 1);
-    forwardPacket->AddHeader(reqHeader);
     
     g_protocolLog << "Forwarding request for " << destination
                   << " (hop count: " << (hopCount + 1) << ") with delay " 
                   << delay.GetMicroSeconds() << "us at "
                   << Simulator::Now().GetSeconds() << "s\n";
     
-    Simulator::Schedule(delay, &FrtaRoutingProtocol::ForwardRouteRequest, this, forwardPacket);
+    Simulator::Schedule(delay, &FrtaRoutingProtocolT::ForwardRouteRequest, this, reqHeader);
   }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::ForwardRouteRequest(Ptr<Packet> packet)
+FrtaRoutingProtocolT<Policy>::ForwardRouteRequest(RouteRequestHeader reqHeader)
 {
-  NS_LOG_FUNCTION(this);
-  
-  // Get packet details for logging
-  RouteRequestHeader reqHeader;
-  packet->PeekHeader(reqHeader);
+  NS_LOG_FUNCTION(this << reqHeader.GetDestination());
   
   g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
                 << " forwarding route request to destination " << reqHeader.GetDestination()
                 << " at " << Simulator::Now().GetSeconds() << "s\n";
   
-  // Send to broadcast address
-  m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address::GetBroadcast(), 9));
+  // One copy per radio, each recording the channel it is sent on; a request
+  // starting here names the address it leaves from as its source
+  for (const auto& socket : m_sockets)
+  {
+    RouteRequestHeader hopHeader = reqHeader;
+    if (reqHeader.GetHopCount() == 0)
+    {
+      hopHeader.SetSource(m_ipv4->GetAddress(socket.first, 0).GetLocal());
+    }
+    hopHeader.AddChannel(GetInterfaceChannel(socket.first));
+    Ptr<Packet> packet = m_packetPool.Acquire();
+    packet->AddHeader(hopHeader);
+    
+    FrtaHeader frtaHeader;
+    frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_REQUEST);
+    packet->AddHeader(frtaHeader);
+    SendControl(packet, Ipv4Address::GetBroadcast(), socket.first);
+  }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::SendRouteReply(Ipv4Address destination, Ipv4Address nextHop)
+FrtaRoutingProtocolT<Policy>::SendRouteReply(Ipv4Address destination, Ipv4Address nextHop,
+                                             Ipv4Address target, uint32_t hopCount,
+                                             const std::vector<uint8_t>& channels)
 {
-  NS_LOG_FUNCTION(this << destination << nextHop);
-  
-  // Create packet with FRTA header
-  Ptr<Packet> packet = Create<Packet>();
-  FrtaHeader frtaHeader;
-  frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_REPLY);
-  packet->AddHeader(frtaHeader);
+  NS_LOG_FUNCTION(this << destination << nextHop << target << hopCount);
   
-  // Add route reply header
+  // Add route reply header first
+  Ptr<Packet> packet = m_packetPool.Acquire();
   RouteReplyHeader replyHeader;
   replyHeader.SetDestination(destination);
   replyHeader.SetNextHop(nextHop);
-  replyHeader.SetTrust(m_trustValues[nextHop]);
+  replyHeader.SetTrust(GetNodeTrustScore(nextHop));
+  replyHeader.SetTarget(target);
+  replyHeader.SetHopCount(hopCount);
+  replyHeader.SetChannels(channels);
   packet->AddHeader(replyHeader);
   
+  // Add FRTA header last (will be first when receiving)
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_REPLY);
+  packet->AddHeader(frtaHeader);
+  
   // Add small random delay to avoid collisions
-  Time delay = MicroSeconds(m_random->GetInteger(0, 1000));
+  Time delay = GetJitter();
   
   g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
                 << " scheduling route reply to " << destination
@@ -567,18 +1774,29 @@ FrtaRoutingProtocol::SendRouteReply(Ipv4Address destination, Ipv4Address nextHop
                 << delay.GetMicroSeconds() << "us at " 
                 << Simulator::Now().GetSeconds() << "s\n";
   
-  Simulator::Schedule(delay, &FrtaRoutingProtocol::SendDelayedReply, this, packet, nextHop);
+  Simulator::Schedule(delay, &FrtaRoutingProtocolT::SendDelayedReply, this, packet, nextHop);
+}
+
+template <typename Policy>
+Time
+FrtaRoutingProtocolT<Policy>::GetJitter()
+{
+  uint32_t minJitter = m_minJitter.GetMicroSeconds();
+  uint32_t maxJitter = std::max<uint32_t>(minJitter, m_maxJitter.GetMicroSeconds());
+  return MicroSeconds(m_random->GetInteger(minJitter, maxJitter));
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::SendDelayedReply(Ptr<Packet> packet, Ipv4Address nextHop)
+FrtaRoutingProtocolT<Policy>::SendDelayedReply(Ptr<Packet> packet, Ipv4Address nextHop)
 {
   NS_LOG_FUNCTION(this << nextHop);
-  m_socket->SendTo(packet, 0, InetSocketAddress(nextHop, 9));
+  SendControl(packet, nextHop, GetInterfaceForNeighbor(nextHop));
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::ProcessRouteReply(Ptr<Packet> packet, Ipv4Address sender)
+FrtaRoutingProtocolT<Policy>::ProcessRouteReply(Ptr<Packet> packet, Ipv4Address sender)
 {
   NS_LOG_FUNCTION(this << sender);
   
@@ -592,11 +1810,14 @@ FrtaRoutingProtocol::ProcessRouteReply(Ptr<Packet> packet, Ipv4Address sender)
   
   Ipv4Address destination = replyHeader.GetDestination();
   Ipv4Address nextHop = replyHeader.GetNextHop();
+  Ipv4Address target = replyHeader.GetTarget();
   double trust = replyHeader.GetTrust();
+  uint32_t hopCount = replyHeader.GetHopCount();
   
   g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
                 << " processing route reply from " << sender
                 << " for destination " << destination
+                << " to target " << target
                 << " via " << nextHop << " at "
                 << Simulator::Now().GetSeconds() << "s\n";
   
@@ -604,179 +1825,2296 @@ FrtaRoutingProtocol::ProcessRouteReply(Ptr<Packet> packet, Ipv4Address sender)
   UpdateTrustValue(sender, trust);
   UpdateTrustValue(nextHop, trust);
   
-  // Update route cache with new route
+  // Every node on the reply path learns the target through the sender; the
+  // route back to the requester was set up by the request
   RouteEntry entry;
-  entry.nextHop = sender;  // Use sender as next hop
+  entry.nextHop = sender;
   entry.trust = trust;
   entry.lastUpdate = Simulator::Now();
-  entry.hopCount = 1;  // Direct hop to next node
-  m_routeCache[destination] = entry;
+  entry.hopCount = hopCount + 1;
+  entry.channelCost = GetChannelCost(replyHeader.GetChannels());
+  // Never route to this node itself through a neighbor
+  if (!IsOwnAddress(target))
+  {
+    if (IsBetterRoute(target, entry))
+    {
+      StoreRoute(target, entry);
+    }
+    else
+    {
+      AddAlternateHop(target, sender, hopCount, entry.channelCost);
+    }
+  }
   
   g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
-                << " updated route cache for " << destination
+                << " updated route cache for " << target
                 << " via " << sender << " (trust: " << trust << ")"
                 << " at " << Simulator::Now().GetSeconds() << "s\n";
   
-  // If we're not the final destination, forward the reply
-  if (destination != m_ipv4->GetAddress(1, 0).GetLocal())
+  // If we're not the requester, forward the reply along the reverse route
+  if (!IsOwnAddress(destination))
   {
     auto it = m_routeCache.find(destination);
-    if (it != m_routeCache.end() && it->second.nextHop != destination)
+    auto route = m_routeCache.find(target);
+    if (it != m_routeCache.end() && it->second.nextHop != sender && route != m_routeCache.end())
+    {
+      g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                    << " forwarding reply to " << destination
+                    << " via " << it->second.nextHop
+                    << " at " << Simulator::Now().GetSeconds() << "s\n";
+      SendRouteReply(destination, it->second.nextHop, target, route->second.hopCount,
+                     replyHeader.GetChannels());
+    }
+  }
+  
+  // The discovery of the target is over, here and at the requester
+  m_pendingRequests.erase(target);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::UpdateRoute(Ipv4Address destination, Ipv4Address nextHop, double trust)
+{
+  NS_LOG_FUNCTION(this << destination << nextHop << trust);
+  
+  RouteEntry entry;
+  entry.nextHop = nextHop;
+  entry.trust = trust;
+  entry.lastUpdate = Simulator::Now();
+  entry.hopCount = 1; // Direct hop
+  
+  StoreRoute(destination, entry);
+  
+  // Update trust value for next hop
+  UpdateTrustValue(nextHop, trust);
+  
+  g_protocolLog << "UpdateRoute: Updated route to " << destination
+                << " via " << nextHop << " (trust: " << trust
+                << ") at " << Simulator::Now().GetSeconds() << "s\n";
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::StoreRoute(Ipv4Address destination, RouteEntry entry)
+{
+  if (m_watchdog && entry.hopCount > 0 && entry.nextHop != destination &&
+      m_monitor.IsBlacklisted(entry.nextHop))
+  {
+    NS_LOG_LOGIC("Ignoring route to " << destination << " via blacklisted " << entry.nextHop);
+    return;
+  }
+  entry.seqNo = ++m_routeSeqNo;
+  entry.interface = GetInterfaceForNeighbor(entry.nextHop);
+  
+  // A still valid next hop that is being replaced remains usable as an alternate
+  auto it = m_routeCache.find(destination);
+  bool demote = it != m_routeCache.end() && it->second.nextHop != entry.nextHop &&
+                it->second.hopCount > 0 &&
+                Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout;
+  RouteEntry replaced = demote ? it->second : RouteEntry();
+  m_routeCache[destination] = entry;
+  PruneAlternateHops(destination, entry.hopCount);
+  if (demote)
+  {
+    AddAlternateHop(destination, replaced.nextHop, replaced.hopCount - 1, replaced.channelCost);
+  }
+  if (m_routeWaiters.count(destination))
+  {
+    // Report outside of the packet handler that learned the route
+    Simulator::ScheduleNow(&FrtaRoutingProtocolT::NotifyRouteResolved, this, destination);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::AddAlternateHop(Ipv4Address destination, Ipv4Address nextHop,
+                                              uint32_t hopCount, double channelCost)
+{
+  NS_LOG_FUNCTION(this << destination << nextHop << hopCount);
+  
+  if (m_watchdog && m_monitor.IsBlacklisted(nextHop))
+  {
+    return;
+  }
+  
+  // Only a neighbour strictly closer to the destination than our own route
+  // is loop-free, as in AODV-multipath
+  auto route = m_routeCache.find(destination);
+  if (route == m_routeCache.end() || IsOwnAddress(nextHop) ||
+      hopCount >= route->second.hopCount)
+  {
+    return;
+  }
+  AlternateHops& alternates = m_alternateHops[destination];
+  uint32_t slot = 0;
+  for (; slot < alternates.n; slot++)
+  {
+    if (alternates.nextHop[slot] == nextHop)
+    {
+      break;
+    }
+  }
+  if (slot == alternates.n)
+  {
+    if (alternates.n < AlternateHops::MAX_HOPS)
+    {
+      alternates.n++;
+    }
+    else
+    {
+      // Replace the alternate trusted least, the one confirmed longest
+      // ago among equals
+      slot = 0;
+      double slotTrust = GetNodeTrustScore(alternates.nextHop[0]);
+      for (uint32_t i = 1; i < alternates.n; i++)
+      {
+        double trust = GetNodeTrustScore(alternates.nextHop[i]);
+        if (trust < slotTrust ||
+            (trust == slotTrust && alternates.lastUpdate[i] < alternates.lastUpdate[slot]))
+        {
+          slot = i;
+          slotTrust = trust;
+        }
+      }
+    }
+  }
+  alternates.nextHop[slot] = nextHop;
+  alternates.lastUpdate[slot] = Simulator::Now();
+  alternates.hopCount[slot] = hopCount;
+  alternates.channelCost[slot] = channelCost;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::PruneAlternateHops(Ipv4Address destination, uint32_t hopCount)
+{
+  // Alternates must stay closer to the destination than our route
+  auto it = m_alternateHops.find(destination);
+  if (it == m_alternateHops.end())
+  {
+    return;
+  }
+  AlternateHops& alternates = it->second;
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < alternates.n; i++)
+  {
+    if (alternates.hopCount[i] < hopCount)
+    {
+      alternates.nextHop[kept] = alternates.nextHop[i];
+      alternates.lastUpdate[kept] = alternates.lastUpdate[i];
+      alternates.hopCount[kept] = alternates.hopCount[i];
+      alternates.channelCost[kept] = alternates.channelCost[i];
+      kept++;
+    }
+  }
+  alternates.n = kept;
+}
+
+template <typename Policy>
+Ipv4Address
+FrtaRoutingProtocolT<Policy>::SelectNextHop(Ipv4Address destination, const RouteEntry& route,
+                                            uint64_t flow, uint32_t bytes)
+{
+  if (!m_flowPinning)
+  {
+    return route.nextHop;
+  }
+  
+  std::array<Ipv4Address, AlternateHops::MAX_HOPS + 1> candidates;
+  uint32_t nCandidates = 0;
+  candidates[nCandidates++] = route.nextHop;
+  auto it = m_alternateHops.find(destination);
+  if (it != m_alternateHops.end())
+  {
+    const AlternateHops& alternates = it->second;
+    for (uint32_t i = 0; i < alternates.n; i++)
+    {
+      // With channel diversity, paths that are more than a hop worse once
+      // channel reuse is charged are not worth spreading flows onto
+      if (alternates.nextHop[i] != route.nextHop &&
+          Simulator::Now() - alternates.lastUpdate[i] < m_routeCacheTimeout &&
+          !IsLowTrust(GetNodeTrustScore(alternates.nextHop[i])) &&
+          (!m_channelDiversity || alternates.channelCost[i] <= GetRouteCost(route) + 1))
+      {
+        candidates[nCandidates++] = alternates.nextHop[i];
+      }
+    }
+  }
+  return m_flowTable.Select(flow, bytes, candidates.data(), nCandidates);
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::BuildCandidates(Ipv4Address destination, const RouteEntry& route,
+                                              FrtaCandidateTag& tag)
+{
+  NS_LOG_FUNCTION(this << destination);
+  
+  // A neighbor is reached best by unicast, which the MAC retransmits
+  if (route.hopCount <= 1)
+  {
+    return false;
+  }
+  
+  struct Candidate {
+    Ipv4Address nextHop;
+    double score;
+  };
+  auto score = [this](Ipv4Address nextHop, uint32_t hops) {
+    return GetNodeTrustScore(nextHop) / (1.0 + hops);
+  };
+  
+  std::array<Candidate, AlternateHops::MAX_HOPS + 1> ranked;
+  uint32_t nRanked = 0;
+  ranked[nRanked++] = {route.nextHop, score(route.nextHop, route.hopCount)};
+  auto it = m_alternateHops.find(destination);
+  if (it != m_alternateHops.end())
+  {
+    const AlternateHops& alternates = it->second;
+    for (uint32_t i = 0; i < alternates.n; i++)
+    {
+      if (alternates.nextHop[i] != route.nextHop &&
+          Simulator::Now() - alternates.lastUpdate[i] < m_routeCacheTimeout &&
+          !IsLowTrust(GetNodeTrustScore(alternates.nextHop[i])))
+      {
+        ranked[nRanked++] = {alternates.nextHop[i], score(alternates.nextHop[i], alternates.hopCount[i] + 1)};
+      }
+    }
+  }
+  std::stable_sort(ranked.begin(), ranked.begin() + nRanked,
+                   [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+  
+  // The destination goes first so that it is never preempted
+  tag = FrtaCandidateTag();
+  tag.SetForwarder(m_ipv4->GetAddress(route.interface, 0).GetLocal());
+  tag.AddCandidate(destination);
+  for (uint32_t i = 0; i < nRanked && i < m_maxCandidates; i++)
+  {
+    tag.AddCandidate(ranked[i].nextHop);
+  }
+  return true;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::ReceiveOpportunistic(Ptr<const Packet> p, const Ipv4Header& header,
+                                                   const FrtaCandidateTag& tag,
+                                                   const UnicastForwardCallback& ucb)
+{
+  NS_LOG_FUNCTION(this << header.GetDestination() << tag.GetForwarder());
+  
+  if (IsOwnAddress(header.GetSource()))
+  {
+    return true;
+  }
+  
+  // Drop a waiting copy once a higher-priority candidate is heard forwarding it
+  uint64_t fingerprint = FrtaFingerprintCache::Fingerprint(header);
+  auto pending = m_pendingForwards.find(fingerprint);
+  if (pending != m_pendingForwards.end())
+  {
+    if (pending->second.candidates.GetRank(tag.GetForwarder()) < pending->second.rank)
+    {
+      pending->second.event.Cancel();
+      m_pendingForwards.erase(pending);
+      g_protocolLog << "Suppressed forwarding to " << header.GetDestination() << ", forwarded by "
+                    << tag.GetForwarder() << " at " << Simulator::Now().GetSeconds() << "s\n";
+    }
+    return true;
+  }
+  
+  // Candidates are named by their address on the forwarder's link
+  Ipv4Address local = m_ipv4->GetAddress(GetInterfaceForNeighbor(tag.GetForwarder()), 0).GetLocal();
+  uint32_t rank = tag.GetRank(local);
+  if (rank == tag.GetNCandidates())
+  {
+    return true;
+  }
+  if (!m_seenPackets.Insert(fingerprint))
+  {
+    return true;
+  }
+  
+  auto it = m_routeCache.find(header.GetDestination());
+  if (it == m_routeCache.end() ||
+      Simulator::Now() - it->second.lastUpdate >= m_routeCacheTimeout)
+  {
+    NS_LOG_LOGIC("Candidate without a route to " << header.GetDestination());
+    return true;
+  }
+  
+  // Rank 0 is the destination, whose acknowledgement takes the first slot
+  PendingForward& forward = m_pendingForwards[fingerprint];
+  forward.rank = rank;
+  forward.candidates = tag;
+  forward.event = Simulator::Schedule(m_candidateSlot * static_cast<int64_t>(rank),
+                                      &FrtaRoutingProtocolT::ForwardOpportunistic, this,
+                                      fingerprint, p, header, ucb);
+  return true;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendOpportunisticAck(uint64_t fingerprint, uint32_t interface)
+{
+  NS_LOG_FUNCTION(this << fingerprint << interface);
+  
+  OpportunisticAckHeader ackHeader;
+  ackHeader.SetFingerprint(fingerprint);
+  Ptr<Packet> packet = m_packetPool.Acquire();
+  packet->AddHeader(ackHeader);
+  
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_OPP_ACK);
+  packet->AddHeader(frtaHeader);
+  SendControl(packet, Ipv4Address::GetBroadcast(), interface);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessOpportunisticAck(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  OpportunisticAckHeader ackHeader;
+  packet->RemoveHeader(ackHeader);
+  
+  // A copy still in flight to us must not be forwarded either
+  uint64_t fingerprint = ackHeader.GetFingerprint();
+  m_seenPackets.Insert(fingerprint);
+  auto pending = m_pendingForwards.find(fingerprint);
+  if (pending != m_pendingForwards.end())
+  {
+    pending->second.event.Cancel();
+    m_pendingForwards.erase(pending);
+    g_protocolLog << "Suppressed forwarding, acknowledged by destination " << sender
+                  << " at " << Simulator::Now().GetSeconds() << "s\n";
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ForwardOpportunistic(uint64_t fingerprint, Ptr<const Packet> p,
+                                                   Ipv4Header header, UnicastForwardCallback ucb)
+{
+  NS_LOG_FUNCTION(this << header.GetDestination());
+  m_pendingForwards.erase(fingerprint);
+  
+  Ipv4Address destination = header.GetDestination();
+  auto it = m_routeCache.find(destination);
+  if (it == m_routeCache.end() ||
+      Simulator::Now() - it->second.lastUpdate >= m_routeCacheTimeout)
+  {
+    NS_LOG_LOGIC("Route to " << destination << " expired before forwarding");
+    return;
+  }
+  
+  Ptr<Packet> packet = p->Copy();
+  FrtaCandidateTag candidates;
+  packet->RemovePacketTag(candidates);
+  
+  Ipv4Address gateway = it->second.nextHop;
+  if (m_opportunistic && BuildCandidates(destination, it->second, candidates))
+  {
+    packet->AddPacketTag(candidates);
+    gateway = Ipv4Address::GetBroadcast();
+  }
+  Ptr<Ipv4Route> route = CreateRoute(destination, gateway, it->second.interface);
+  ucb(route, packet, header);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::EnqueueForCoding(Ptr<const Packet> p, const Ipv4Header& header,
+                                               Ptr<Ipv4Route> route,
+                                               const UnicastForwardCallback& ucb)
+{
+  NS_LOG_FUNCTION(this << header.GetDestination() << route->GetGateway());
+  
+  CodingNative native;
+  native.fingerprint = FrtaFingerprintCache::Fingerprint(header);
+  native.payload = p;
+  native.header = header;
+  native.route = route;
+  native.ucb = ucb;
+  FrtaCodingTag hop;
+  if (p->PeekPacketTag(hop))
+  {
+    native.previousHop = hop.GetTransmitter();
+  }
+  
+  auto holds = [this](Ipv4Address node, const CodingNative& held) {
+    return held.previousHop == node || m_coder.NeighborHas(node, held.fingerprint);
+  };
+  
+  // Add the oldest packet queued for each other next hop as long as every
+  // next hop holds all the packets but its own. Packets about to expire are
+  // left to the native path, which handles the TTL.
+  std::array<CodingNative*, CodedPacketHeader::MAX_NATIVES> chosen;
+  uint32_t nChosen = 0;
+  chosen[nChosen++] = &native;
+  Ipv4Address nextHop = route->GetGateway();
+  for (auto& queue : m_codingQueues)
+  {
+    if (header.GetTtl() <= 1 || nChosen == CodedPacketHeader::MAX_NATIVES)
+    {
+      break;
+    }
+    if (queue.first == nextHop)
+    {
+      continue;
+    }
+    for (auto& other : queue.second)
+    {
+      bool combinable = other.header.GetTtl() > 1;
+      for (uint32_t i = 0; i < nChosen && combinable; i++)
+      {
+        combinable = holds(queue.first, *chosen[i]) && holds(chosen[i]->route->GetGateway(), other);
+      }
+      if (combinable)
+      {
+        chosen[nChosen++] = &other;
+        break;
+      }
+    }
+  }
+  
+  if (nChosen == 1)
+  {
+    native.flushEvent = Simulator::Schedule(m_codingHoldTime, &FrtaRoutingProtocolT::FlushCodingQueue,
+                                            this, nextHop, native.fingerprint);
+    m_codingQueues[nextHop].push_back(native);
+    return;
+  }
+  
+  CodedPacketHeader codedHeader;
+  std::array<Ptr<const Packet>, CodedPacketHeader::MAX_NATIVES> payloads;
+  for (uint32_t i = 0; i < nChosen; i++)
+  {
+    CodedPacketHeader::Native entry;
+    entry.nextHop = chosen[i]->route->GetGateway();
+    entry.fingerprint = chosen[i]->fingerprint;
+    entry.length = chosen[i]->payload->GetSize();
+    entry.header = chosen[i]->header;
+    entry.header.SetTtl(entry.header.GetTtl() - 1);
+    codedHeader.AddNative(entry);
+    payloads[i] = chosen[i]->payload;
+  }
+  Ptr<Packet> packet = m_coder.Encode(payloads.data(), nChosen);
+  packet->AddHeader(codedHeader);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_CODED_PACKET);
+  packet->AddHeader(frtaHeader);
+  SendControl(packet, Ipv4Address::GetBroadcast(),
+              m_ipv4->GetInterfaceForDevice(chosen[0]->route->GetOutputDevice()));
+  
+  g_protocolLog << "Coded " << nChosen << " packets for " << header.GetDestination()
+                << " and others at " << Simulator::Now().GetSeconds() << "s\n";
+  
+  // Each next hop now holds its own packet; the partners leave their queues
+  for (uint32_t i = 0; i < nChosen; i++)
+  {
+    const CodedPacketHeader::Native& entry = codedHeader.GetNative(i);
+    m_coder.NoteNeighborHas(entry.nextHop, entry.fingerprint);
+    if (i == 0)
+    {
+      continue;
+    }
+    chosen[i]->flushEvent.Cancel();
+    auto queue = m_codingQueues.find(entry.nextHop);
+    auto it = std::find_if(queue->second.begin(), queue->second.end(),
+                           [&entry](const CodingNative& held) {
+                             return held.fingerprint == entry.fingerprint;
+                           });
+    queue->second.erase(it);
+    if (queue->second.empty())
+    {
+      m_codingQueues.erase(queue);
+    }
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::FlushCodingQueue(Ipv4Address nextHop, uint64_t fingerprint)
+{
+  NS_LOG_FUNCTION(this << nextHop << fingerprint);
+  
+  auto queue = m_codingQueues.find(nextHop);
+  if (queue == m_codingQueues.end())
+  {
+    return;
+  }
+  auto it = std::find_if(queue->second.begin(), queue->second.end(),
+                         [fingerprint](const CodingNative& native) {
+                           return native.fingerprint == fingerprint;
+                         });
+  if (it == queue->second.end())
+  {
+    return;
+  }
+  CodingNative native = *it;
+  queue->second.erase(it);
+  if (queue->second.empty())
+  {
+    m_codingQueues.erase(queue);
+  }
+  
+  // No partner arrived in time, forward natively
+  Ptr<Packet> packet = native.payload->Copy();
+  FrtaCodingTag hop;
+  packet->RemovePacketTag(hop);
+  hop.SetTransmitter(native.route->GetSource());
+  packet->AddPacketTag(hop);
+  native.ucb(native.route, packet, native.header);
+  m_coder.NoteNeighborHas(nextHop, fingerprint);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessCodedPacket(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  CodedPacketHeader codedHeader;
+  packet->RemoveHeader(codedHeader);
+  
+  // The relay held every packet it coded
+  for (uint32_t i = 0; i < codedHeader.GetNNatives(); i++)
+  {
+    m_coder.NoteNeighborHas(sender, codedHeader.GetNative(i).fingerprint);
+  }
+  
+  uint32_t index;
+  Ptr<Packet> native = m_coder.Decode(codedHeader, packet,
+                                      m_ipv4->GetAddress(GetInterfaceForNeighbor(sender), 0).GetLocal(),
+                                      index);
+  if (!native)
+  {
+    return;
+  }
+  
+  // Hand the decoded packet to IPv4 as if it had been received natively
+  Ipv4Header ipHeader = codedHeader.GetNative(index).header;
+  if (Node::ChecksumEnabled())
+  {
+    ipHeader.EnableChecksum();
+  }
+  FrtaCodingTag hop;
+  hop.SetTransmitter(sender);
+  native->AddPacketTag(hop);
+  native->AddHeader(ipHeader);
+  
+  g_protocolLog << "Decoded packet for " << ipHeader.GetDestination() << " from " << sender
+                << " at " << Simulator::Now().GetSeconds() << "s\n";
+  
+  DeliverToIpv4(native, GetInterfaceForNeighbor(sender));
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::DeliverToIpv4(Ptr<Packet> packet, uint32_t interface)
+{
+  // Hand a packet with its IPv4 header to IPv4 as if it had been received
+  // natively on an interface
+  Ptr<NetDevice> device = m_ipv4->GetNetDevice(interface);
+  m_ipv4->GetObject<Ipv4L3Protocol>()->Receive(device, packet, Ipv4L3Protocol::PROT_NUMBER,
+                                               device->GetBroadcast(), device->GetAddress(),
+                                               NetDevice::PACKET_HOST);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::EnqueueForAggregation(Ptr<const Packet> p,
+                                                    const Ipv4Header& header,
+                                                    Ptr<Ipv4Route> route,
+                                                    const UnicastForwardCallback& ucb)
+{
+  NS_LOG_FUNCTION(this << header.GetDestination() << route->GetGateway());
+  
+  // The TTL is decremented here, since aggregated packets bypass IP forwarding
+  if (header.GetTtl() <= 1)
+  {
+    ucb(route, p, header);
+    return;
+  }
+  
+  Ipv4Address nextHop = route->GetGateway();
+  uint32_t bytes = p->GetSize() + header.GetSerializedSize();
+  auto it = m_aggregationBuffers.find(nextHop);
+  if (it != m_aggregationBuffers.end() &&
+      it->second.bytes + bytes > m_aggregationMaxFrameSize)
+  {
+    FlushAggregate(nextHop);
+  }
+  
+  AggregationBuffer& buffer = m_aggregationBuffers[nextHop];
+  if (buffer.packets.empty())
+  {
+    buffer.flushEvent = Simulator::Schedule(m_aggregationDelay, &FrtaRoutingProtocolT::FlushAggregate,
+                                            this, nextHop);
+  }
+  buffer.packets.push_back({p, header, ucb});
+  buffer.bytes += bytes;
+  buffer.route = route;
+  
+  if (buffer.packets.size() == AggregateHeader::MAX_PACKETS)
+  {
+    FlushAggregate(nextHop);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::FlushAggregate(Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION(this << nextHop);
+  
+  auto it = m_aggregationBuffers.find(nextHop);
+  if (it == m_aggregationBuffers.end())
+  {
+    return;
+  }
+  AggregationBuffer buffer = it->second;
+  m_aggregationBuffers.erase(it);
+  buffer.flushEvent.Cancel();
+  
+  // A packet alone is not worth the aggregation headers
+  if (buffer.packets.size() == 1)
+  {
+    const AggregatedPacket& single = buffer.packets.front();
+    single.ucb(buffer.route, single.payload, single.header);
+    return;
+  }
+  
+  Ptr<Packet> frame = Create<Packet>();
+  AggregateHeader aggregateHeader;
+  for (const auto& aggregated : buffer.packets)
+  {
+    Ipv4Header ipHeader = aggregated.header;
+    ipHeader.SetTtl(ipHeader.GetTtl() - 1);
+    if (Node::ChecksumEnabled())
+    {
+      ipHeader.EnableChecksum();
+    }
+    Ptr<Packet> packet = aggregated.payload->Copy();
+    packet->AddHeader(ipHeader);
+    aggregateHeader.AddPacket(packet->GetSize());
+    frame->AddAtEnd(packet);
+  }
+  frame->AddHeader(aggregateHeader);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_AGGREGATE);
+  frame->AddHeader(frtaHeader);
+  SendToNeighbor(frame, nextHop);
+  
+  m_aggregationStats.frames++;
+  m_aggregationStats.packets += buffer.packets.size();
+  g_protocolLog << "Aggregated " << buffer.packets.size() << " packets to " << nextHop
+                << " at " << Simulator::Now().GetSeconds() << "s\n";
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendToNeighbor(Ptr<Packet> frame, Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION(this << neighbor);
+  
+  // Bypasses the socket, so control frames are prioritized here; aggregates
+  // and bundles carry data
+  FrtaHeader frtaHeader;
+  frame->PeekHeader(frtaHeader);
+  if (frtaHeader.GetMessageType() != FrtaHeader::FRTA_AGGREGATE &&
+      frtaHeader.GetMessageType() != FrtaHeader::FRTA_BUNDLE)
+  {
+    SocketPriorityTag priorityTag;
+    priorityTag.SetPriority(m_controlPriority);
+    frame->ReplacePacketTag(priorityTag);
+  }
+  
+  // Sent on a direct route, so that no route to the neighbor itself is needed
+  Ptr<Ipv4Route> route = CreateRoute(neighbor, neighbor, GetInterfaceForNeighbor(neighbor));
+  
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort(FRTA_PORT);
+  udpHeader.SetDestinationPort(FRTA_PORT);
+  if (Node::ChecksumEnabled())
+  {
+    udpHeader.EnableChecksums();
+    udpHeader.InitializeChecksum(route->GetSource(), neighbor, 17);
+  }
+  frame->AddHeader(udpHeader);
+  m_ipv4->Send(frame, route->GetSource(), neighbor, 17, route);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessAggregate(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  AggregateHeader aggregateHeader;
+  packet->RemoveHeader(aggregateHeader);
+  
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < aggregateHeader.GetNPackets(); i++)
+  {
+    uint32_t length = aggregateHeader.GetLength(i);
+    if (offset + length > packet->GetSize())
+    {
+      NS_LOG_WARN("Truncated aggregate from " << sender);
+      break;
+    }
+    DeliverToIpv4(packet->CreateFragment(offset, length), GetInterfaceForNeighbor(sender));
+    offset += length;
+    m_aggregationStats.deaggregated++;
+  }
+}
+
+const FrtaAggregationStats&
+FrtaRoutingProtocol::GetAggregationStats() const
+{
+  return m_aggregationStats;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::IsDelayTolerant(Ptr<const Packet> p, const Ipv4Header& header) const
+{
+  // Locally originated packets carry their TOS in a socket tag until IPv4 sets it
+  uint8_t tos = header.GetTos();
+  SocketIpTosTag tosTag;
+  if (p->PeekPacketTag(tosTag))
+  {
+    tos = tosTag.GetTos();
+  }
+  return (tos >> 2) == m_dtnDscp;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::StoreBundle(Ptr<Packet> packet, Ipv4Address destination, Time lifetime,
+                                          uint32_t custody)
+{
+  NS_LOG_FUNCTION(this << destination << lifetime << custody);
+  
+  uint64_t dropped = m_bundles.GetDropped();
+  m_bundles.Add({packet, destination, Simulator::Now() + lifetime, custody});
+  m_dtnStats.stored++;
+  m_dtnStats.dropped += m_bundles.GetDropped() - dropped;
+  g_protocolLog << "Stored bundle for " << destination << " (" << m_bundles.GetN()
+                << " carried) at " << Simulator::Now().GetSeconds() << "s\n";
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::DtnTick()
+{
+  NS_LOG_FUNCTION(this);
+  
+  m_predictability.Age();
+  m_dtnStats.expired += m_bundles.Expire();
+  
+  // Bundles whose destination became reachable leave through normal forwarding
+  for (auto& bundle : m_bundles.TakeIf([this](const FrtaBundle& bundle)
+                                       { return HasValidRoute(bundle.destination); }))
+  {
+    DeliverToIpv4(bundle.packet, m_routeCache.find(bundle.destination)->second.interface);
+    m_dtnStats.released++;
+  }
+  
+  DeliveryPredictabilityHeader beacon;
+  m_predictability.Fill(beacon);
+  Ptr<Packet> packet = m_packetPool.Acquire();
+  packet->AddHeader(beacon);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_DTN_BEACON);
+  packet->AddHeader(frtaHeader);
+  BroadcastControl(packet);
+  
+  Simulator::Schedule(m_dtnBeaconInterval + GetJitter(), &FrtaRoutingProtocolT::DtnTick, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessDtnBeacon(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  DeliveryPredictabilityHeader beacon;
+  packet->RemoveHeader(beacon);
+  if (!m_delayTolerant)
+  {
+    return;
+  }
+  m_predictability.Encounter(sender);
+  m_predictability.Transit(sender, beacon);
+  
+  // Hand over bundles the neighbor is more likely to deliver, weighted by its trust
+  auto it = m_trustValues.find(sender);
+  double trust = (it != m_trustValues.end()) ? it->second : GetDefaultTrust();
+  auto handOff = [&](const FrtaBundle& bundle) {
+    if (bundle.destination == sender)
+    {
+      return true;
+    }
+    return bundle.custody < m_dtnMaxCustody &&
+           trust * beacon.Find(bundle.destination) > m_predictability.Get(bundle.destination);
+  };
+  // Bundles stay in the store until the neighbor accepts custody; an
+  // unanswered offer is renewed at a later encounter
+  for (auto& bundle : m_bundles.Offer(handOff, sender, Simulator::Now() + m_dtnBeaconInterval))
+  {
+    BundleHeader bundleHeader;
+    bundleHeader.SetLifetime(bundle.expires - Simulator::Now());
+    bundleHeader.SetCustody(bundle.custody + 1);
+    Ptr<Packet> frame = bundle.packet->Copy();
+    frame->AddHeader(bundleHeader);
+    FrtaHeader bundleFrtaHeader;
+    bundleFrtaHeader.SetMessageType(FrtaHeader::FRTA_BUNDLE);
+    frame->AddHeader(bundleFrtaHeader);
+    SendToNeighbor(frame, sender);
+    g_protocolLog << "Offered bundle for " << bundle.destination << " to " << sender
+                  << " at " << Simulator::Now().GetSeconds() << "s\n";
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessBundle(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  BundleHeader bundleHeader;
+  packet->RemoveHeader(bundleHeader);
+  Ipv4Header ipHeader;
+  packet->PeekHeader(ipHeader);
+  Ipv4Address destination = ipHeader.GetDestination();
+  
+  if (IsOwnAddress(destination) || HasValidRoute(destination))
+  {
+    DeliverToIpv4(packet, GetInterfaceForNeighbor(sender));
+    m_dtnStats.released++;
+  }
+  else if (m_delayTolerant && !bundleHeader.GetLifetime().IsZero())
+  {
+    StoreBundle(packet, destination, bundleHeader.GetLifetime(), bundleHeader.GetCustody());
+  }
+  else
+  {
+    return;
+  }
+  
+  // Take custody, so that the sender can let go of the bundle
+  CustodyAckHeader ackHeader;
+  ackHeader.SetBundle(FrtaFingerprintCache::Fingerprint(ipHeader));
+  Ptr<Packet> ack = m_packetPool.Acquire();
+  ack->AddHeader(ackHeader);
+  FrtaHeader ackFrtaHeader;
+  ackFrtaHeader.SetMessageType(FrtaHeader::FRTA_CUSTODY_ACK);
+  ack->AddHeader(ackFrtaHeader);
+  SendControl(ack, sender, GetInterfaceForNeighbor(sender));
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessCustodyAck(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  CustodyAckHeader ackHeader;
+  packet->RemoveHeader(ackHeader);
+  if (m_bundles.Release(ackHeader.GetBundle(), sender))
+  {
+    m_dtnStats.handedOff++;
+    g_protocolLog << "Handed bundle to " << sender << " at "
+                  << Simulator::Now().GetSeconds() << "s\n";
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::WatchForwarding(const Ipv4Header& header, Ipv4Address nextHop)
+{
+  // The destination itself does not forward
+  if (nextHop == header.GetDestination() || nextHop.IsBroadcast())
+  {
+    return;
+  }
+  m_monitor.Expire(std::bind(&FrtaRoutingProtocolT::NoteForwarding, this,
+                             std::placeholders::_1, std::placeholders::_2,
+                             std::placeholders::_3));
+  m_monitor.Watch(header, nextHop);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::Overhear(Ptr<NetDevice>, Ptr<const Packet> packet, uint16_t,
+                                       const Address&, const Address&, NetDevice::PacketType)
+{
+  FrtaWatchdog::OutcomeCallback outcome = std::bind(&FrtaRoutingProtocolT::NoteForwarding, this,
+                                                    std::placeholders::_1,
+                                                    std::placeholders::_2,
+                                                    std::placeholders::_3);
+  m_monitor.Expire(outcome);
+  
+  Ptr<Packet> copy = packet->Copy();
+  Ipv4Header ipHeader;
+  copy->RemoveHeader(ipHeader);
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+  if (!ReadPorts(copy, ipHeader, sourcePort, destinationPort) ||
+      !IsControlPacket(ipHeader, sourcePort, destinationPort))
+  {
+    m_monitor.Overhear(ipHeader, outcome);
+    return;
+  }
+  
+  // Relays may forward packets inside aggregate and coded frames
+  UdpHeader udpHeader;
+  copy->RemoveHeader(udpHeader);
+  FrtaHeader frtaHeader;
+  copy->RemoveHeader(frtaHeader);
+  if (frtaHeader.GetMessageType() == FrtaHeader::FRTA_AGGREGATE)
+  {
+    AggregateHeader aggregateHeader;
+    copy->RemoveHeader(aggregateHeader);
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < aggregateHeader.GetNPackets(); i++)
+    {
+      uint32_t length = aggregateHeader.GetLength(i);
+      if (offset + length > copy->GetSize())
+      {
+        break;
+      }
+      Ipv4Header inner;
+      copy->CreateFragment(offset, length)->PeekHeader(inner);
+      m_monitor.Overhear(inner, outcome);
+      offset += length;
+    }
+  }
+  else if (frtaHeader.GetMessageType() == FrtaHeader::FRTA_CODED_PACKET)
+  {
+    CodedPacketHeader codedHeader;
+    copy->RemoveHeader(codedHeader);
+    for (uint32_t i = 0; i < codedHeader.GetNNatives(); i++)
+    {
+      m_monitor.Overhear(codedHeader.GetNative(i).header, outcome);
+    }
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::NoteForwarding(Ipv4Address nextHop, bool forwarded, bool blacklisted)
+{
+  // Observed forwarding is the trust of a next hop
+  if (m_betaTrust)
+  {
+    ObserveTrust(nextHop, forwarded ? 1 : 0, forwarded ? 0 : 1);
+  }
+  else
+  {
+    UpdateTrustValue(nextHop, m_monitor.GetForwardRatio(nextHop));
+  }
+  if (blacklisted)
+  {
+    g_protocolLog << "Watchdog blacklisted " << nextHop << " (forward ratio "
+                  << m_monitor.GetForwardRatio(nextHop) << ") at "
+                  << Simulator::Now().GetSeconds() << "s\n";
+    RouteAround(nextHop);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::RouteAround(Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION(this << nextHop);
+  
+  for (auto& entry : m_alternateHops)
+  {
+    AlternateHops& alternates = entry.second;
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < alternates.n; i++)
+    {
+      if (alternates.nextHop[i] != nextHop)
+      {
+        alternates.nextHop[kept] = alternates.nextHop[i];
+        alternates.lastUpdate[kept] = alternates.lastUpdate[i];
+        alternates.hopCount[kept] = alternates.hopCount[i];
+        alternates.channelCost[kept] = alternates.channelCost[i];
+        kept++;
+      }
+    }
+    alternates.n = kept;
+  }
+  
+  // Switch to a fresh alternate, or drop the route so that it is rediscovered
+  for (auto it = m_routeCache.begin(); it != m_routeCache.end();)
+  {
+    if (it->second.hopCount == 0 || it->second.nextHop != nextHop || it->first == nextHop)
+    {
+      ++it;
+      continue;
+    }
+    auto alternates = m_alternateHops.find(it->first);
+    bool switched = false;
+    if (alternates != m_alternateHops.end())
+    {
+      for (uint32_t i = 0; i < alternates->second.n && !switched; i++)
+      {
+        if (Simulator::Now() - alternates->second.lastUpdate[i] < m_routeCacheTimeout)
+        {
+          it->second.nextHop = alternates->second.nextHop[i];
+          it->second.hopCount = alternates->second.hopCount[i] + 1;
+          it->second.channelCost = alternates->second.channelCost[i];
+          it->second.interface = GetInterfaceForNeighbor(it->second.nextHop);
+          it->second.seqNo = ++m_routeSeqNo;
+          switched = true;
+        }
+      }
+    }
+    if (switched)
+    {
+      PruneAlternateHops(it->first, it->second.hopCount);
+      ++it;
+    }
+    else
+    {
+      m_alternateHops.erase(it->first);
+      it = m_routeCache.erase(it);
+    }
+  }
+}
+
+const FrtaWatchdogStats&
+FrtaRoutingProtocol::GetWatchdogStats() const
+{
+  return m_monitor.GetStats();
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SetInterfaceChannel(uint32_t interface, uint8_t channel)
+{
+  NS_LOG_FUNCTION(this << interface << (uint32_t)channel);
+  m_interfaceChannels[interface] = channel;
+  
+  Ptr<WifiPhy> phy = GetWifiPhy(interface);
+  if (phy && phy->GetChannelNumber() != channel)
+  {
+    // Width 0 selects the default width of the standard in the band
+    phy->SetOperatingChannel(WifiPhy::ChannelTuple{channel, 0, phy->GetPhyBand(), 0});
+  }
+}
+
+template <typename Policy>
+uint8_t
+FrtaRoutingProtocolT<Policy>::GetInterfaceChannel(uint32_t interface) const
+{
+  auto it = m_interfaceChannels.find(interface);
+  if (it != m_interfaceChannels.end())
+  {
+    return it->second;
+  }
+  Ptr<WifiPhy> phy = GetWifiPhy(interface);
+  if (phy)
+  {
+    return phy->GetChannelNumber();
+  }
+  // Unlabelled devices count as one shared channel
+  return 0;
+}
+
+template <typename Policy>
+uint64_t
+FrtaRoutingProtocolT<Policy>::GetChannelLoad(uint8_t channel) const
+{
+  uint64_t load = 0;
+  for (const auto& radio : m_radioLoads)
+  {
+    if (GetInterfaceChannel(radio.first) == channel)
+    {
+      load += radio.second.load;
+    }
+  }
+  for (const auto& neighbor : m_neighborChannels)
+  {
+    if (Simulator::Now() - neighbor.second.lastUpdate < 3 * m_channelReportInterval)
+    {
+      for (const auto& radio : neighbor.second.radios)
+      {
+        if (radio.first == channel)
+        {
+          load += radio.second;
+        }
+      }
+    }
+  }
+  return load;
+}
+
+template <typename Policy>
+uint8_t
+FrtaRoutingProtocolT<Policy>::SelectChannel(uint32_t interface, const std::vector<uint8_t>& channels)
+{
+  NS_LOG_FUNCTION(this << interface);
+  NS_ASSERT(!channels.empty());
+  
+  uint8_t current = GetInterfaceChannel(interface);
+  auto own = m_radioLoads.find(interface);
+  uint64_t ownLoad = own != m_radioLoads.end() ? own->second.load : 0;
+  
+  uint8_t best = channels.front();
+  std::pair<bool, uint64_t> bestKey(true, std::numeric_limits<uint64_t>::max());
+  for (uint8_t channel : channels)
+  {
+    bool taken = false;
+    for (const auto& socket : m_sockets)
+    {
+      taken |= socket.first != interface && GetInterfaceChannel(socket.first) == channel;
+    }
+    // The radio takes its own traffic along, so it does not count against
+    // the channel it is on
+    uint64_t load = GetChannelLoad(channel);
+    if (channel == current)
+    {
+      load -= std::min(load, ownLoad);
+    }
+    std::pair<bool, uint64_t> key(taken, load);
+    if (key < bestKey)
+    {
+      bestKey = key;
+      best = channel;
+    }
+  }
+  
+  if (best != current)
+  {
+    g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                  << " moving interface " << interface << " from channel " << (uint32_t)current
+                  << " to " << (uint32_t)best << " (load " << bestKey.second << " B/s) at "
+                  << Simulator::Now().GetSeconds() << "s\n";
+    SetInterfaceChannel(interface, best);
+  }
+  return best;
+}
+
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetChannelCost(const std::vector<uint8_t>& channels) const
+{
+  // WCETT with equal link costs: the hop count blended with the hops on
+  // the most used channel, which cannot transmit concurrently
+  std::array<uint32_t, 256> uses{};
+  uint32_t maxUses = 0;
+  for (uint8_t channel : channels)
+  {
+    maxUses = std::max(maxUses, ++uses[channel]);
+  }
+  return (1 - m_channelDiversityWeight) * channels.size() + m_channelDiversityWeight * maxUses;
+}
+
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetRouteCost(const RouteEntry& entry) const
+{
+  // Routes without channel information cost as if on a single channel
+  return m_channelDiversity && entry.channelCost > 0 ? entry.channelCost : entry.hopCount;
+}
+
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetPathChannelCost(const FrtaPath& path) const
+{
+  std::vector<uint8_t> channels;
+  for (uint32_t i = 1; i < path.Size(); i++)
+  {
+    channels.push_back(GetLinkChannel(m_nodeIds.GetAddress(path[i - 1]),
+                                      m_nodeIds.GetAddress(path[i]), channels));
+  }
+  return GetChannelCost(channels);
+}
+
+template <typename Policy>
+uint8_t
+FrtaRoutingProtocolT<Policy>::GetLinkChannel(Ipv4Address from, Ipv4Address to,
+                                             const std::vector<uint8_t>& used) const
+{
+  // Links of this node use the radio the neighbor is reached on
+  if (IsOwnAddress(from))
+  {
+    return GetInterfaceChannel(GetInterfaceForNeighbor(to));
+  }
+  if (IsOwnAddress(to))
+  {
+    return GetInterfaceChannel(GetInterfaceForNeighbor(from));
+  }
+  
+  // Between two neighbors, the channel both report that the path uses least
+  auto fromIt = m_neighborChannels.find(from);
+  auto toIt = m_neighborChannels.find(to);
+  if (fromIt == m_neighborChannels.end() || toIt == m_neighborChannels.end())
+  {
+    return 0;
+  }
+  uint8_t best = 0;
+  uint32_t bestUses = std::numeric_limits<uint32_t>::max();
+  for (const auto& fromRadio : fromIt->second.radios)
+  {
+    for (const auto& toRadio : toIt->second.radios)
+    {
+      if (fromRadio.first == toRadio.first)
+      {
+        uint32_t uses = std::count(used.begin(), used.end(), fromRadio.first);
+        if (uses < bestUses)
+        {
+          bestUses = uses;
+          best = fromRadio.first;
+        }
+      }
+    }
+  }
+  return best;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::IsBetterRoute(Ipv4Address destination, const RouteEntry& entry) const
+{
+  auto it = m_routeCache.find(destination);
+  if (it != m_routeCache.end() && it->second.hopCount == 0)
+  {
+    // Local interface routes are never replaced
+    return false;
+  }
+  if (it == m_routeCache.end() || it->second.nextHop == entry.nextHop ||
+      Simulator::Now() - it->second.lastUpdate >= m_routeCacheTimeout)
+  {
+    return true;
+  }
+  // Trust per unit of cost, as SelectTrustedPath weighs whole paths; the
+  // score folds in confidence and recommendations when those are enabled
+  double cost = GetRouteCost(entry) + GetTxPowerCost(entry.nextHop);
+  double existingCost = GetRouteCost(it->second) + GetTxPowerCost(it->second.nextHop);
+  return GetNodeTrustScore(entry.nextHop) * existingCost >=
+         GetNodeTrustScore(it->second.nextHop) * cost;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendChannelReport()
+{
+  NS_LOG_FUNCTION(this);
+  
+  ChannelReportHeader report;
+  for (const auto& socket : m_sockets)
+  {
+    RadioLoad& radio = m_radioLoads[socket.first];
+    radio.load = radio.bytes / m_channelReportInterval.GetSeconds();
+    radio.bytes = 0;
+    report.AddEntry(GetInterfaceChannel(socket.first),
+                    std::min<uint64_t>(radio.load, std::numeric_limits<uint32_t>::max()));
+  }
+  if (report.GetNEntries() > 0)
+  {
+    Ptr<Packet> packet = m_packetPool.Acquire();
+    packet->AddHeader(report);
+    FrtaHeader frtaHeader;
+    frtaHeader.SetMessageType(FrtaHeader::FRTA_CHANNEL_REPORT);
+    packet->AddHeader(frtaHeader);
+    BroadcastControl(packet);
+  }
+  
+  Simulator::Schedule(m_channelReportInterval + GetJitter(),
+                      &FrtaRoutingProtocolT::SendChannelReport, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessChannelReport(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  ChannelReportHeader report;
+  packet->RemoveHeader(report);
+  
+  NeighborChannels& neighbor = m_neighborChannels[sender];
+  neighbor.radios.clear();
+  for (uint32_t i = 0; i < report.GetNEntries(); i++)
+  {
+    neighbor.radios.emplace_back(report.GetChannel(i), report.GetLoad(i));
+  }
+  neighbor.lastUpdate = Simulator::Now();
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::NoteChannelTraffic(Ptr<const Packet> packet, Ptr<Ipv4>,
+                                                 uint32_t interface)
+{
+  m_radioLoads[interface].bytes += packet->GetSize();
+}
+
+template <typename Policy>
+Ptr<WifiPhy>
+FrtaRoutingProtocolT<Policy>::GetWifiPhy(uint32_t interface) const
+{
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(m_ipv4->GetNetDevice(interface));
+  return wifi ? wifi->GetPhy() : nullptr;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::NoteRxPower(std::string context, Ptr<const Packet> packet,
+                                          uint16_t, WifiTxVector txVector, MpduInfo,
+                                          SignalNoiseDbm signalNoise, uint16_t)
+{
+  // FRTA broadcasts come straight from their transmitter, so the IPv4
+  // source names the neighbor the frame was heard from
+  Ptr<Packet> copy = packet->Copy();
+  WifiMacHeader macHeader;
+  copy->RemoveHeader(macHeader);
+  if (!macHeader.IsData() || !macHeader.GetAddr1().IsBroadcast())
+  {
+    return;
+  }
+  LlcSnapHeader llc;
+  copy->RemoveHeader(llc);
+  if (llc.GetType() != Ipv4L3Protocol::PROT_NUMBER)
+  {
+    return;
+  }
+  Ipv4Header ipHeader;
+  copy->RemoveHeader(ipHeader);
+  Ipv4Address neighbor = ipHeader.GetSource();
+  if (IsOwnAddress(neighbor))
+  {
+    return;
+  }
+  
+  // The transmitter is taken to have the power levels of this radio
+  uint32_t interface = std::stoul(context);
+  Ptr<WifiPhy> phy = GetWifiPhy(interface);
+  double txPower = phy->GetTxPowerStart();
+  if (phy->GetNTxPower() > 1)
+  {
+    txPower += txVector.GetTxPowerLevel() * (phy->GetTxPowerEnd() - phy->GetTxPowerStart()) /
+               (phy->GetNTxPower() - 1);
+  }
+  double loss = txPower - signalNoise.signal;
+  bool known = m_linkLosses.count(neighbor) > 0;
+  LinkLoss& link = m_linkLosses[neighbor];
+  link.loss = known ? (link.loss + loss) / 2 : loss;
+  link.interface = interface;
+  
+  Ptr<WifiNetDevice> wifi = DynamicCast<WifiNetDevice>(m_ipv4->GetNetDevice(interface));
+  Ptr<FrtaTxPowerWifiManager> manager =
+    DynamicCast<FrtaTxPowerWifiManager>(wifi->GetRemoteStationManager());
+  if (manager)
+  {
+    manager->SetTxPower(macHeader.GetAddr2(), phy->GetRxSensitivity() + m_txPowerMargin + link.loss);
+  }
+}
+
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetTxPowerCost(Ipv4Address neighbor) const
+{
+  // The power needed for a neighbor as a fraction of the range of the radio
+  if (!m_txPowerControl)
+  {
+    return 0;
+  }
+  auto it = m_linkLosses.find(neighbor);
+  Ptr<WifiPhy> phy = GetWifiPhy(it != m_linkLosses.end() ? it->second.interface
+                                                         : GetInterfaceForNeighbor(neighbor));
+  if (!phy || phy->GetTxPowerEnd() <= phy->GetTxPowerStart())
+  {
+    return 0;
+  }
+  if (it == m_linkLosses.end())
+  {
+    return 1;
+  }
+  double needed = phy->GetRxSensitivity() + m_txPowerMargin + it->second.loss;
+  double cost = (needed - phy->GetTxPowerStart()) / (phy->GetTxPowerEnd() - phy->GetTxPowerStart());
+  return std::min(1.0, std::max(0.0, cost));
+}
+
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetPathLoss(Ipv4Address neighbor) const
+{
+  auto it = m_linkLosses.find(neighbor);
+  return it != m_linkLosses.end() ? it->second.loss : 0;
+}
+
+uint64_t
+FrtaRoutingProtocol::GetLoopsDetected() const
+{
+  return m_loopsDetected;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::JoinGroup(Ipv4Address group)
+{
+  NS_LOG_FUNCTION(this << group);
+  m_multicastTrees.Join(group);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::LeaveGroup(Ipv4Address group)
+{
+  NS_LOG_FUNCTION(this << group);
+  
+  // Prune the trees this node only stayed on for its own membership
+  m_multicastTrees.Leave(group);
+  for (const FrtaMulticastTree* tree : m_multicastTrees.GetTrees(group))
+  {
+    if (!m_multicastTrees.IsForwarder(tree->source, group))
+    {
+      SendMulticastJoin(tree->source, group, false);
+    }
+  }
+}
+
+template <typename Policy>
+int64_t
+FrtaRoutingProtocolT<Policy>::AssignStreams(int64_t stream)
+{
+  NS_LOG_FUNCTION(this << stream);
+  m_random->SetStream(stream);
+  return 1;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::RouteMulticastInput(Ptr<const Packet> p, const Ipv4Header& header,
+                                                  Ptr<const NetDevice> idev,
+                                                  const MulticastForwardCallback& mcb,
+                                                  const LocalDeliverCallback& lcb)
+{
+  NS_LOG_FUNCTION(this << header.GetSource() << header.GetDestination());
+  
+  // Copies rebroadcast by forwarders reach every node several times
+  Ipv4Address group = header.GetDestination();
+  if (m_ipv4->IsDestinationAddress(header.GetSource(), idev->GetIfIndex()) ||
+      !m_multicastSeen.Insert(FrtaFingerprintCache::Fingerprint(header)))
+  {
+    return true;
+  }
+  
+  bool member = m_multicastTrees.IsMember(group);
+  if (member)
+  {
+    lcb(p, header, idev->GetIfIndex());
+  }
+  if (m_multicastTrees.IsForwarder(header.GetSource(), group) && header.GetTtl() > 1)
+  {
+    Ptr<Ipv4MulticastRoute> route = Create<Ipv4MulticastRoute>();
+    route->SetGroup(group);
+    route->SetOrigin(header.GetSource());
+    route->SetParent(idev->GetIfIndex());
+    for (const auto& socket : m_sockets)
+    {
+      route->SetOutputTtl(socket.first, Ipv4MulticastRoute::MAX_TTL - 1);
+    }
+    mcb(route, p, header);
+    return true;
+  }
+  return member;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendMulticastQueries()
+{
+  NS_LOG_FUNCTION(this);
+  
+  // Queries stop once the node no longer sends to any group
+  std::vector<Ipv4Address> groups = m_multicastTrees.GetSendingGroups();
+  if (groups.empty())
+  {
+    return;
+  }
+  m_multicastSequence++;
+  for (const auto& group : groups)
+  {
+    // One copy per radio, each naming the address it leaves from, which is
+    // the source of multicast packets sent on that radio
+    for (const auto& socket : m_sockets)
+    {
+      MulticastQueryHeader query;
+      query.SetGroup(group);
+      query.SetSource(m_ipv4->GetAddress(socket.first, 0).GetLocal());
+      query.SetSequence(m_multicastSequence);
+      query.SetHopCount(0);
+      query.SetTrust(1.0);
+      Ptr<Packet> packet = m_packetPool.Acquire();
+      packet->AddHeader(query);
+      FrtaHeader frtaHeader;
+      frtaHeader.SetMessageType(FrtaHeader::FRTA_MCAST_QUERY);
+      packet->AddHeader(frtaHeader);
+      SendControl(packet, Ipv4Address::GetBroadcast(), socket.first);
+    }
+  }
+  
+  m_multicastQueryEvent = Simulator::Schedule(m_multicastQueryInterval,
+                                              &FrtaRoutingProtocolT::SendMulticastQueries, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessMulticastQuery(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  MulticastQueryHeader query;
+  packet->RemoveHeader(query);
+  
+  if (!m_multicast || IsOwnAddress(query.GetSource()))
+  {
+    return;
+  }
+  
+  m_multicastTrees.Expire();
+  
+  // The upstream neighbor is the end of the most trusted reverse path
+  double trust = query.GetTrust() * GetNodeTrustScore(sender);
+  uint8_t hopCount = std::min<uint32_t>(query.GetHopCount() + 1, 255);
+  if (m_multicastTrees.Query(query.GetSource(), query.GetGroup(), query.GetSequence(), sender,
+                             hopCount, trust))
+  {
+    // Copies from more trusted paths may still arrive during the jitter
+    Simulator::Schedule(GetJitter(), &FrtaRoutingProtocolT::ForwardMulticastQuery, this,
+                        query.GetSource(), query.GetGroup());
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ForwardMulticastQuery(Ipv4Address source, Ipv4Address group)
+{
+  NS_LOG_FUNCTION(this << source << group);
+  
+  const FrtaMulticastTree* tree = m_multicastTrees.Find(source, group);
+  if (!tree)
+  {
+    return;
+  }
+  
+  MulticastQueryHeader query;
+  query.SetGroup(group);
+  query.SetSource(source);
+  query.SetSequence(tree->sequence);
+  query.SetHopCount(tree->hopCount);
+  query.SetTrust(tree->trust);
+  Ptr<Packet> packet = m_packetPool.Acquire();
+  packet->AddHeader(query);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_MCAST_QUERY);
+  packet->AddHeader(frtaHeader);
+  BroadcastControl(packet);
+  
+  // Members and forwarders refresh their join once per round
+  if (m_multicastTrees.IsMember(group) || m_multicastTrees.IsForwarder(source, group))
+  {
+    SendMulticastJoin(source, group, true);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendMulticastJoin(Ipv4Address source, Ipv4Address group, bool join)
+{
+  NS_LOG_FUNCTION(this << source << group << join);
+  
+  const FrtaMulticastTree* tree = m_multicastTrees.Find(source, group);
+  if (!tree || tree->upstream == Ipv4Address())
+  {
+    return;
+  }
+  
+  MulticastJoinHeader joinHeader;
+  joinHeader.SetGroup(group);
+  joinHeader.SetSource(source);
+  joinHeader.SetJoin(join);
+  Ptr<Packet> packet = m_packetPool.Acquire();
+  packet->AddHeader(joinHeader);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_MCAST_JOIN);
+  packet->AddHeader(frtaHeader);
+  SendToNeighbor(packet, tree->upstream);
+  
+  g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                << (join ? " joined " : " left ") << "tree of " << source << " for " << group
+                << " via " << tree->upstream << " (trust: " << tree->trust << ") at "
+                << Simulator::Now().GetSeconds() << "s\n";
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessMulticastJoin(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  MulticastJoinHeader joinHeader;
+  packet->RemoveHeader(joinHeader);
+  
+  if (!m_multicast)
+  {
+    return;
+  }
+  
+  // Joins and leaves propagate towards the source only when the forwarding
+  // state of this node changes
+  Ipv4Address source = joinHeader.GetSource();
+  Ipv4Address group = joinHeader.GetGroup();
+  bool self = IsOwnAddress(source);
+  if (joinHeader.IsJoin())
+  {
+    if (m_multicastTrees.AddDownstream(source, group, sender) && !self)
+    {
+      SendMulticastJoin(source, group, true);
+    }
+  }
+  else if (m_multicastTrees.RemoveDownstream(source, group, sender) && !self &&
+           !m_multicastTrees.IsMember(group))
+  {
+    SendMulticastJoin(source, group, false);
+  }
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::IsLooping(const Ipv4Header& header)
+{
+  // Only packets actually forwarded are remembered, so that bundles carried
+  // here and released later are not taken for loops
+  if (m_forwardedPackets.Insert(FrtaFingerprintCache::Fingerprint(header)))
+  {
+    return false;
+  }
+  
+  // The route led the packet back here; drop it so that it is rediscovered
+  Ipv4Address destination = header.GetDestination();
+  m_routeCache.erase(destination);
+  m_alternateHops.erase(destination);
+  m_loopsDetected++;
+  g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                << " dropped looping packet from " << header.GetSource()
+                << " to " << destination << " (id " << header.GetIdentification()
+                << ") at " << Simulator::Now().GetSeconds() << "s\n";
+  return true;
+}
+
+const FrtaDtnStats&
+FrtaRoutingProtocol::GetDtnStats() const
+{
+  return m_dtnStats;
+}
+
+uint32_t
+FrtaRoutingProtocol::GetNBundles() const
+{
+  return m_bundles.GetN();
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendReceptionReport()
+{
+  NS_LOG_FUNCTION(this);
+  
+  ReceptionReportHeader report;
+  m_coder.TakeReport(report);
+  if (report.GetNFingerprints() > 0)
+  {
+    Ptr<Packet> packet = m_packetPool.Acquire();
+    packet->AddHeader(report);
+    FrtaHeader frtaHeader;
+    frtaHeader.SetMessageType(FrtaHeader::FRTA_RECEPTION_REPORT);
+    packet->AddHeader(frtaHeader);
+    BroadcastControl(packet);
+  }
+  
+  Simulator::Schedule(m_receptionReportInterval + GetJitter(),
+                      &FrtaRoutingProtocolT::SendReceptionReport, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessReceptionReport(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  ReceptionReportHeader report;
+  packet->RemoveHeader(report);
+  m_coder.ProcessReport(sender, report);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::NotifyTx(Ptr<const Packet> packet, Ptr<Ipv4>, uint32_t)
+{
+  Ptr<Packet> payload = packet->Copy();
+  Ipv4Header header;
+  payload->RemoveHeader(header);
+  uint16_t sourcePort = 0;
+  uint16_t destinationPort = 0;
+  if (header.GetDestination().IsBroadcast() ||
+      (ReadPorts(payload, header, sourcePort, destinationPort) &&
+       IsControlPacket(header, sourcePort, destinationPort)))
+  {
+    return;
+  }
+  
+  // Watch locally originated packets now that their header is complete
+  if (m_watchdog && header.GetDestination() == m_lastOutputDestination &&
+      IsOwnAddress(header.GetSource()))
+  {
+    WatchForwarding(header, m_lastOutputNextHop);
+    m_lastOutputDestination = Ipv4Address();
+  }
+  
+  // Keep the data packets this node sends, to decode packets coded with them
+  if (m_networkCoding)
+  {
+    m_coder.Remember(header, payload);
+  }
+}
+
+const FrtaCodingStats&
+FrtaRoutingProtocol::GetCodingStats() const
+{
+  return m_coder.GetStats();
+}
+
+const FrtaFlowTable&
+FrtaRoutingProtocol::GetFlowTable() const
+{
+  return m_flowTable;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::HasValidRoute(Ipv4Address destination)
+{
+  auto it = m_routeCache.find(destination);
+  return it != m_routeCache.end() &&
+         Simulator::Now() - it->second.lastUpdate < m_routeCacheTimeout;
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::ResolveRoute(Ipv4Address destination, RouteResolvedCallback callback,
+                                           Time timeout)
+{
+  NS_LOG_FUNCTION(this << destination << timeout);
+  
+  if (HasValidRoute(destination))
+  {
+    callback(destination, true);
+    return true;
+  }
+  
+  RouteWaiter waiter;
+  waiter.id = m_nextWaiterId++;
+  waiter.callback = callback;
+  waiter.timeoutEvent = Simulator::Schedule(timeout, &FrtaRoutingProtocolT::HandleResolveTimeout,
+                                            this, destination, waiter.id);
+  m_routeWaiters[destination].push_back(waiter);
+  
+  // Join a discovery in progress or start one
+  if (!m_sockets.empty() && m_pendingRequests.find(destination) == m_pendingRequests.end())
+  {
+    SendRouteRequest(destination);
+  }
+  return false;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::NotifyRouteResolved(Ipv4Address destination)
+{
+  NS_LOG_FUNCTION(this << destination);
+  
+  auto it = m_routeWaiters.find(destination);
+  if (it == m_routeWaiters.end() || !HasValidRoute(destination))
+  {
+    return;
+  }
+  
+  // Detach the waiters first, callbacks may resolve again
+  std::vector<RouteWaiter> waiters;
+  waiters.swap(it->second);
+  m_routeWaiters.erase(it);
+  for (auto& waiter : waiters)
+  {
+    waiter.timeoutEvent.Cancel();
+    waiter.callback(destination, true);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::HandleResolveTimeout(Ipv4Address destination, uint32_t id)
+{
+  NS_LOG_FUNCTION(this << destination << id);
+  
+  auto it = m_routeWaiters.find(destination);
+  if (it == m_routeWaiters.end())
+  {
+    return;
+  }
+  std::vector<RouteWaiter>& waiters = it->second;
+  auto waiterIt = std::find_if(waiters.begin(), waiters.end(),
+                               [id](const RouteWaiter& waiter) { return waiter.id == id; });
+  if (waiterIt == waiters.end())
+  {
+    return;
+  }
+  RouteResolvedCallback callback = waiterIt->callback;
+  waiters.erase(waiterIt);
+  if (waiters.empty())
+  {
+    m_routeWaiters.erase(it);
+  }
+  callback(destination, false);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::BroadcastRouteAdvertisement()
+{
+  NS_LOG_FUNCTION(this);
+  FrtaArena::Scope scratch(m_scratch);
+  
+  for (const auto& entry : m_routeCache)
+  {
+    if (entry.second.trust > m_minPathTrust && 
+        Simulator::Now() - entry.second.lastUpdate < m_routeCacheTimeout)
+    {
+      Ptr<Packet> packet = m_packetPool.Acquire();
+      RouteAdvertisementHeader advHeader;
+      advHeader.SetDestination(entry.first);
+      advHeader.SetNextHop(entry.second.nextHop);
+      advHeader.SetTrust(entry.second.trust);
+      advHeader.SetHopCount(entry.second.hopCount);
+      packet->AddHeader(advHeader);
+      
+      FrtaHeader frtaHeader;
+      frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_ADVERTISEMENT);
+      packet->AddHeader(frtaHeader);
+      
+      BroadcastControl(packet);
+      
+      g_protocolLog << "Broadcasted route advertisement for " << entry.first
+                    << " via " << entry.second.nextHop << " at " 
+                    << Simulator::Now().GetSeconds() << "s\n";
+    }
+  }
+  
+  Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocolT::BroadcastRouteAdvertisement, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessRouteAdvertisement(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
+  
+  // Get FRTA header
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  
+  // Get route advertisement header
+  RouteAdvertisementHeader advHeader;
+  packet->RemoveHeader(advHeader);
+  
+  Ipv4Address destination = advHeader.GetDestination();
+  Ipv4Address nextHop = advHeader.GetNextHop();
+  double trust = advHeader.GetTrust();
+  uint32_t hopCount = advHeader.GetHopCount();
+  
+  // A route through ourselves would loop
+  if (IsOwnAddress(nextHop) || IsOwnAddress(destination))
+  {
+    return;
+  }
+  
+  // The advertised next hop is usually out of our radio range, so what we
+  // know of it comes from recommendations rather than our own observation
+  if (m_recommendationTrust && nextHop != destination)
+  {
+    trust = std::min(trust, GetNodeTrustScore(nextHop));
+  }
+  
+  // Update route if it's better than existing one
+  auto it = m_routeCache.find(destination);
+  if (it == m_routeCache.end() || 
+      (trust > it->second.trust && hopCount < it->second.hopCount))
+  {
+    // The advertiser is our next hop; the advertised next hop is its own
+    RouteEntry entry;
+    entry.nextHop = sender;
+    entry.trust = trust;
+    entry.lastUpdate = Simulator::Now();
+    entry.hopCount = hopCount + 1;
+    StoreRoute(destination, entry);
+    
+    g_protocolLog << "Updated route from advertisement: " << destination
+                  << " via " << sender << " (advertised next hop: " << nextHop
+                  << ", trust: " << trust
+                  << ", hops: " << entry.hopCount << ") at " 
+                  << Simulator::Now().GetSeconds() << "s\n";
+  }
+  else if (it->second.nextHop != sender && trust > m_minPathTrust)
+  {
+    // Not better, but a trusted path through another neighbour
+    AddAlternateHop(destination, sender, hopCount, 0);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::HandleRouteRequestTimeout(Ipv4Address destination)
+{
+  NS_LOG_FUNCTION(this << destination);
+  
+  if (m_pendingRequests.find(destination) != m_pendingRequests.end())
+  {
+    g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                  << " route request timeout for " << destination
+                  << " at " << Simulator::Now().GetSeconds() << "s\n"
+                  << "  Pending requests: " << m_pendingRequests.size()
+                  << ", Route cache entries: " << m_routeCache.size() << "\n";
+    
+    m_pendingRequests.erase(destination);
+    m_routeRequestTime.erase(destination);
+    
+    // Keep discovering while applications are still waiting for this route
+    if (m_routeWaiters.count(destination) && !m_sockets.empty())
+    {
+      SendRouteRequest(destination);
+    }
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::UpdateTrustValue(Ipv4Address node, double trust)
+{
+  NS_LOG_FUNCTION(this << node << trust);
+  
+  if (m_betaTrust)
+  {
+    // A trust report counts as one unit of evidence, split by its value
+    ObserveTrust(node, trust, 1 - trust);
+    return;
+  }
+  
+  // Get current trust value or the policy default
+  auto it = m_trustValues.find(node);
+  double currentTrust = (it != m_trustValues.end()) ? it->second : GetDefaultTrust();
+  
+  // Combine current and new trust values, kept within bounds
+  m_trustValues[node] = SmoothTrust(currentTrust, trust);
+  
+  g_protocolLog << "Updated trust for " << node << " from " << currentTrust 
+                << " to " << m_trustValues[node] << " at " << Simulator::Now().GetSeconds() << "s\n";
+  PublishTrust(node);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ObserveTrust(Ipv4Address node, double positive, double negative)
+{
+  // The trust table mirrors the expected trust, for the checks that read it
+  m_trustEngine.Observe(node, positive, negative);
+  m_trustValues[node] = m_trustEngine.GetExpectedTrust(node);
+  g_protocolLog << "Observed " << positive << "/" << negative << " for " << node
+                << ", trust " << m_trustValues[node] << " (confidence "
+                << m_trustEngine.GetConfidence(node) << ") at "
+                << Simulator::Now().GetSeconds() << "s\n";
+  PublishTrust(node);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::PublishTrust(Ipv4Address node)
+{
+  auto it = m_trustValues.find(node);
+  if (it != m_trustValues.end() && !IsOwnAddress(node))
+  {
+    m_trustReplica.SetLocal(node, it->second);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::MergeTrust(Ipv4Address node, double trust)
+{
+  // Reported trust is kept apart from our own observations, which it only
+  // stands in for until we have some, and is not published again
+  auto it = m_reportedTrust.find(node);
+  double currentTrust = (it != m_reportedTrust.end()) ? it->second : GetDefaultTrust();
+  m_reportedTrust[node] = SmoothTrust(currentTrust, trust);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendTrustDigest()
+{
+  NS_LOG_FUNCTION(this);
+  
+  m_trustRequests = 0;
+  TrustDigestHeader digest;
+  m_trustReplica.FillDigest(digest);
+  Ptr<Packet> packet = m_packetPool.Acquire();
+  packet->AddHeader(digest);
+  FrtaHeader frtaHeader;
+  frtaHeader.SetMessageType(FrtaHeader::FRTA_TRUST_DIGEST);
+  packet->AddHeader(frtaHeader);
+  BroadcastControl(packet);
+  
+  Simulator::Schedule(m_antiEntropyInterval + GetJitter(),
+                      &FrtaRoutingProtocolT::SendTrustDigest, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SendTrustRecords(uint16_t buckets, Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION(this << buckets << neighbor);
+  
+  // To one neighbor, or to all of them for a broadcast address
+  std::vector<FrtaTrustRecord> records;
+  m_trustReplica.GetRecords(buckets, records);
+  for (uint32_t first = 0; first < records.size(); first += TrustUpdateHeader::MAX_RECORDS)
+  {
+    TrustUpdateHeader update;
+    for (uint32_t i = first; i < records.size() && update.AddRecord(records[i]); i++)
+    {
+    }
+    Ptr<Packet> packet = m_packetPool.Acquire();
+    packet->AddHeader(update);
+    FrtaHeader frtaHeader;
+    frtaHeader.SetMessageType(FrtaHeader::FRTA_TRUST_UPDATE);
+    packet->AddHeader(frtaHeader);
+    if (neighbor.IsBroadcast())
     {
-      g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
-                    << " forwarding reply to " << destination
-                    << " via " << it->second.nextHop
-                    << " at " << Simulator::Now().GetSeconds() << "s\n";
-      SendRouteReply(destination, it->second.nextHop);
+      BroadcastControl(packet);
+    }
+    else
+    {
+      SendToNeighbor(packet, neighbor);
     }
   }
-  
-  // Remove from pending requests if this was our request
-  m_pendingRequests.erase(destination);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::UpdateRoute(Ipv4Address destination, Ipv4Address nextHop, double trust)
+FrtaRoutingProtocolT<Policy>::ProcessTrustDigest(Ptr<Packet> packet, Ipv4Address sender)
 {
-  NS_LOG_FUNCTION(this << destination << nextHop << trust);
-  
-  RouteEntry entry;
-  entry.nextHop = nextHop;
-  entry.trust = trust;
-  entry.lastUpdate = Simulator::Now();
-  entry.hopCount = 1; // Direct hop
-  
-  m_routeCache[destination] = entry;
+  NS_LOG_FUNCTION(this << sender);
   
-  // Update trust value for next hop
-  UpdateTrustValue(nextHop, trust);
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  TrustDigestHeader digest;
+  packet->RemoveHeader(digest);
   
-  g_protocolLog << "UpdateRoute: Updated route to " << destination
-                << " via " << nextHop << " (trust: " << trust
-                << ") at " << Simulator::Now().GetSeconds() << "s\n";
+  // Equal tables cost nothing; otherwise ask a bounded number of neighbors
+  uint16_t differing = m_trustReplica.Compare(digest);
+  if (!m_antiEntropy || differing == 0 || m_trustRequests >= m_antiEntropyFanout)
+  {
+    return;
+  }
+  m_trustRequests++;
+  TrustRequestHeader request;
+  request.SetBuckets(differing);
+  Ptr<Packet> reply = m_packetPool.Acquire();
+  reply->AddHeader(request);
+  FrtaHeader requestFrtaHeader;
+  requestFrtaHeader.SetMessageType(FrtaHeader::FRTA_TRUST_REQUEST);
+  reply->AddHeader(requestFrtaHeader);
+  SendToNeighbor(reply, sender);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::BroadcastRouteAdvertisement()
+FrtaRoutingProtocolT<Policy>::ProcessTrustRequest(Ptr<Packet> packet, Ipv4Address sender)
 {
-  NS_LOG_FUNCTION(this);
-  
-  for (const auto& entry : m_routeCache)
-  {
-    if (entry.second.trust > 0.5 && 
-        Simulator::Now() - entry.second.lastUpdate < ROUTE_CACHE_TIMEOUT)
-    {
-      Ptr<Packet> packet = Create<Packet>();
-      FrtaHeader frtaHeader;
-      frtaHeader.SetMessageType(FrtaHeader::FRTA_ROUTE_ADVERTISEMENT);
-      packet->AddHeader(frtaHeader);
-      
-      RouteAdvertisementHeader advHeader;
-      advHeader.SetDestination(entry.first);
-      advHeader.SetNextHop(entry.second.nextHop);
-      advHeader.SetTrust(entry.second.trust);
-      advHeader.SetHopCount(entry.second.hopCount);
-      packet->AddHeader(advHeader);
-      
-      m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address::GetBroadcast(), 9));
-      
-      g_protocolLog << "Broadcasted route advertisement for " << entry.first
-                    << " via " << entry.second.nextHop << " at " 
-                    << Simulator::Now().GetSeconds() << "s\n";
-    }
-  }
+  NS_LOG_FUNCTION(this << sender);
   
-  Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocol::BroadcastRouteAdvertisement, this);
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  TrustRequestHeader request;
+  packet->RemoveHeader(request);
+  SendTrustRecords(request.GetBuckets(), sender);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::ProcessRouteAdvertisement(Ptr<Packet> packet, Ipv4Address sender)
+FrtaRoutingProtocolT<Policy>::ProcessTrustUpdate(Ptr<Packet> packet, Ipv4Address sender)
 {
   NS_LOG_FUNCTION(this << sender);
   
-  // Get FRTA header
   FrtaHeader frtaHeader;
   packet->RemoveHeader(frtaHeader);
+  TrustUpdateHeader update;
+  packet->RemoveHeader(update);
   
-  // Get route advertisement header
-  RouteAdvertisementHeader advHeader;
-  packet->RemoveHeader(advHeader);
-  
-  Ipv4Address destination = advHeader.GetDestination();
-  Ipv4Address nextHop = advHeader.GetNextHop();
-  double trust = advHeader.GetTrust();
-  uint32_t hopCount = advHeader.GetHopCount();
-  
-  // Update route if it's better than existing one
-  auto it = m_routeCache.find(destination);
-  if (it == m_routeCache.end() || 
-      (trust > it->second.trust && hopCount < it->second.hopCount))
+  uint32_t merged = 0;
+  for (uint32_t i = 0; i < update.GetNRecords(); i++)
   {
-    RouteEntry entry;
-    entry.nextHop = nextHop;
-    entry.trust = trust;
-    entry.lastUpdate = Simulator::Now();
-    entry.hopCount = hopCount + 1;
-    m_routeCache[destination] = entry;
-    
-    g_protocolLog << "Updated route from advertisement: " << destination
-                  << " via " << nextHop << " (trust: " << trust
-                  << ", hops: " << entry.hopCount << ") at " 
-                  << Simulator::Now().GetSeconds() << "s\n";
+    // Opinions about ourselves, by ourselves, or of a node about itself are
+    // not evidence
+    const FrtaTrustRecord& record = update.GetRecord(i);
+    if (!IsOwnAddress(record.subject) && !IsOwnAddress(record.origin) &&
+        record.subject != record.origin && m_trustReplica.Merge(record))
+    {
+      MergeTrust(record.subject, record.trust / 65535.0);
+      merged++;
+    }
   }
+  g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
+                << " merged " << merged << " of " << update.GetNRecords()
+                << " trust records from " << sender
+                << " at " << Simulator::Now().GetSeconds() << "s\n";
 }
 
-void
-FrtaRoutingProtocol::HandleRouteRequestTimeout(Ipv4Address destination)
+template <typename Policy>
+double
+FrtaRoutingProtocolT<Policy>::GetNodeTrustScore(Ipv4Address node) const
 {
-  NS_LOG_FUNCTION(this << destination);
+  // Nodes never observed are judged by the network's opinion, if known
+  double prior = GetDefaultTrust();
+  double recommended;
+  auto reported = m_reportedTrust.find(node);
+  if (m_recommendationTrust && m_recommendations.GetTrust(node, recommended))
+  {
+    prior = recommended;
+  }
+  else if (reported != m_reportedTrust.end())
+  {
+    prior = reported->second;
+  }
   
-  if (m_pendingRequests.find(destination) != m_pendingRequests.end())
+  // Nodes with little evidence score close to the prior
+  if (m_betaTrust)
   {
-    g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
-                  << " route request timeout for " << destination
-                  << " at " << Simulator::Now().GetSeconds() << "s\n"
-                  << "  Pending requests: " << m_pendingRequests.size()
-                  << ", Route cache entries: " << m_routeCache.size() << "\n";
-    
-    m_pendingRequests.erase(destination);
-    m_routeRequestTime.erase(destination);
+    return m_trustEngine.GetScore(node, prior);
   }
+  auto it = m_trustValues.find(node);
+  return it != m_trustValues.end() ? it->second : prior;
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::UpdateTrustValue(Ipv4Address node, double trust)
+FrtaRoutingProtocolT<Policy>::SendTrustVector()
 {
-  NS_LOG_FUNCTION(this << node << trust);
+  NS_LOG_FUNCTION(this);
   
-  // Get current trust value or default to 0.5
-  auto it = m_trustValues.find(node);
-  double currentTrust = (it != m_trustValues.end()) ? it->second : 0.5;
+  Ipv4Address self = GetMainAddress();
+  FrtaRecommendationTrust::Opinions opinions;
+  TrustVectorHeader vector;
+  for (const auto& entry : m_trustValues)
+  {
+    if (IsOwnAddress(entry.first))
+    {
+      continue;
+    }
+    if (!vector.AddEntry(entry.first, entry.second))
+    {
+      break;
+    }
+    opinions.emplace_back(entry.first, entry.second);
+  }
+  m_recommendations.SetOpinions(self, opinions);
+  m_recommendations.Step(m_recommendationWork);
   
-  // Weighted average of current and new trust values
-  double alpha = 0.7;  // Weight for new trust value
-  double newTrust = (alpha * trust) + ((1 - alpha) * currentTrust);
+  if (vector.GetNEntries() > 0)
+  {
+    Ptr<Packet> packet = m_packetPool.Acquire();
+    packet->AddHeader(vector);
+    FrtaHeader frtaHeader;
+    frtaHeader.SetMessageType(FrtaHeader::FRTA_TRUST_VECTOR);
+    packet->AddHeader(frtaHeader);
+    BroadcastControl(packet);
+  }
   
-  // Ensure trust stays within bounds
-  m_trustValues[node] = std::max(0.1, std::min(1.0, newTrust));
+  Simulator::Schedule(m_trustVectorInterval + GetJitter(),
+                      &FrtaRoutingProtocolT::SendTrustVector, this);
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::ProcessTrustVector(Ptr<Packet> packet, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION(this << sender);
   
-  g_protocolLog << "Updated trust for " << node << " from " << currentTrust 
-                << " to " << m_trustValues[node] << " at " << Simulator::Now().GetSeconds() << "s\n";
+  FrtaHeader frtaHeader;
+  packet->RemoveHeader(frtaHeader);
+  TrustVectorHeader vector;
+  packet->RemoveHeader(vector);
+  if (!m_recommendationTrust)
+  {
+    return;
+  }
+  FrtaRecommendationTrust::Opinions opinions;
+  opinions.reserve(vector.GetNEntries());
+  for (uint32_t i = 0; i < vector.GetNEntries(); i++)
+  {
+    opinions.emplace_back(vector.GetNode(i), vector.GetTrust(i));
+  }
+  m_recommendations.SetOpinions(sender, opinions);
 }
 
+template <typename Policy>
 double
-FrtaRoutingProtocol::CalculateTrustValue(Ipv4Address node)
+FrtaRoutingProtocolT<Policy>::CalculateTrustValue(Ipv4Address node)
 {
   NS_LOG_FUNCTION(this << node);
   auto it = m_packetCounts.find(node);
-  double trust = (it != m_packetCounts.end()) ? 1.0 - (it->second / 100.0) : 0.5;
+  double trust = (it != m_packetCounts.end()) ? TrustFromPacketCount(it->second) : GetDefaultTrust();
+  // Observed forwarding takes precedence over packet counts
+  if (m_watchdog && m_monitor.GetSamples(node) > 0)
+  {
+    trust = m_monitor.GetForwardRatio(node);
+  }
   g_protocolLog << "Calculated trust for " << node << " as " << trust
                 << " at " << Simulator::Now().GetSeconds() << "s\n";
   return trust;
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::SendRoutingUpdate()
+FrtaRoutingProtocolT<Policy>::SendRoutingUpdate()
 {
   NS_LOG_FUNCTION(this);
   if (!m_running)
@@ -784,26 +4122,20 @@ FrtaRoutingProtocol::SendRoutingUpdate()
     return;
   }
   
-  for (const auto& entry : m_routingTable)
-  {
-    Ptr<Packet> packet = Create<Packet>();
-    TrustTag trustTag;
-    trustTag.SetTrust(m_trustValues[entry.first]);
-    packet->AddPacketTag(trustTag);
-    
-    m_socket->SendTo(packet, 0, InetSocketAddress(Ipv4Address::GetBroadcast(), 9));
-    g_protocolLog << "Sent routing update for " << entry.first
-                  << " (trust: " << m_trustValues[entry.first] << ") at " 
-                  << Simulator::Now().GetSeconds() << "s\n";
-  }
+  // Full exchange of the trust table, without digests
+  SendTrustRecords(0xFFFF, Ipv4Address::GetBroadcast());
+  g_protocolLog << "Sent routing update with " << m_trustReplica.GetN()
+                << " trust records at " << Simulator::Now().GetSeconds() << "s\n";
   
-  Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocol::SendRoutingUpdate, this);
+  Simulator::Schedule(m_updateInterval, &FrtaRoutingProtocolT::SendRoutingUpdate, this);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::ReceiveRoutingPacket(Ptr<Socket> socket)
+FrtaRoutingProtocolT<Policy>::ReceiveRoutingPacket(Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION(this);
+  FrtaArena::Scope scratch(m_scratch);
   Ptr<Packet> packet;
   Address from;
   
@@ -811,6 +4143,13 @@ FrtaRoutingProtocol::ReceiveRoutingPacket(Ptr<Socket> socket)
   {
     InetSocketAddress inetAddr = InetSocketAddress::ConvertFrom(from);
     Ipv4Address sender = inetAddr.GetIpv4();
+    m_neighborInterfaces[sender] = m_ipv4->GetInterfaceForDevice(socket->GetBoundNetDevice());
+    
+    // Routes offered by a next hop caught dropping packets are not believed
+    if (m_watchdog && m_monitor.IsBlacklisted(sender))
+    {
+      continue;
+    }
     
     // Peek at FRTA header without removing it
     FrtaHeader frtaHeader;
@@ -833,21 +4172,48 @@ FrtaRoutingProtocol::ReceiveRoutingPacket(Ptr<Socket> socket)
       case FrtaHeader::FRTA_ROUTE_ADVERTISEMENT:
         ProcessRouteAdvertisement(packet, sender);
         break;
+      case FrtaHeader::FRTA_CODED_PACKET:
+        ProcessCodedPacket(packet, sender);
+        break;
+      case FrtaHeader::FRTA_RECEPTION_REPORT:
+        ProcessReceptionReport(packet, sender);
+        break;
+      case FrtaHeader::FRTA_AGGREGATE:
+        ProcessAggregate(packet, sender);
+        break;
+      case FrtaHeader::FRTA_BUNDLE:
+        ProcessBundle(packet, sender);
+        break;
+      case FrtaHeader::FRTA_DTN_BEACON:
+        ProcessDtnBeacon(packet, sender);
+        break;
+      case FrtaHeader::FRTA_TRUST_VECTOR:
+        ProcessTrustVector(packet, sender);
+        break;
       case FrtaHeader::FRTA_TRUST_UPDATE:
-      {
-        TrustTag trustTag;
-        double trust = 0.5;  // Default value
-        if (packet->PeekPacketTag(trustTag))
-        {
-          trust = trustTag.GetTrust();
-        }
-        UpdateTrustValue(sender, trust);
-        g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
-                      << " received trust update from " << sender
-                      << " (trust: " << trust << ") at "
-                      << Simulator::Now().GetSeconds() << "s\n";
+        ProcessTrustUpdate(packet, sender);
+        break;
+      case FrtaHeader::FRTA_TRUST_DIGEST:
+        ProcessTrustDigest(packet, sender);
+        break;
+      case FrtaHeader::FRTA_TRUST_REQUEST:
+        ProcessTrustRequest(packet, sender);
+        break;
+      case FrtaHeader::FRTA_MCAST_QUERY:
+        ProcessMulticastQuery(packet, sender);
+        break;
+      case FrtaHeader::FRTA_MCAST_JOIN:
+        ProcessMulticastJoin(packet, sender);
+        break;
+      case FrtaHeader::FRTA_CHANNEL_REPORT:
+        ProcessChannelReport(packet, sender);
+        break;
+      case FrtaHeader::FRTA_OPP_ACK:
+        ProcessOpportunisticAck(packet, sender);
+        break;
+      case FrtaHeader::FRTA_CUSTODY_ACK:
+        ProcessCustodyAck(packet, sender);
         break;
-      }
       default:
         g_protocolLog << "Node " << m_ipv4->GetObject<Node>()->GetId()
                       << " received unknown packet type " << (int)frtaHeader.GetMessageType()
@@ -858,56 +4224,170 @@ FrtaRoutingProtocol::ReceiveRoutingPacket(Ptr<Socket> socket)
   }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::NotifyInterfaceUp(uint32_t interface)
+FrtaRoutingProtocolT<Policy>::NotifyInterfaceUp(uint32_t interface)
 {
   NS_LOG_FUNCTION(this << interface);
-  InitializeRoutingTable();
-  g_protocolLog << "Interface " << interface << " up at " << Simulator::Now().GetSeconds() << "s\n";
+  // Before DoInitialize all interfaces are picked up in a single pass
+  if (m_initialized)
+  {
+    CreateSocket(interface);
+    AddInterfaceRoutes(interface);
+  }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::NotifyInterfaceDown(uint32_t interface)
+FrtaRoutingProtocolT<Policy>::NotifyInterfaceDown(uint32_t interface)
 {
   NS_LOG_FUNCTION(this << interface);
-  g_protocolLog << "Interface " << interface << " down at " << Simulator::Now().GetSeconds() << "s\n";
+  CloseSocket(interface);
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
+FrtaRoutingProtocolT<Policy>::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION(this << interface << address);
-  InitializeRoutingTable();
-  g_protocolLog << "Added address " << address << " on interface " << interface
-                << " at " << Simulator::Now().GetSeconds() << "s\n";
+  if (m_initialized)
+  {
+    CreateSocket(interface);
+    AddInterfaceRoutes(interface);
+  }
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
+FrtaRoutingProtocolT<Policy>::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION(this << interface << address);
-  g_protocolLog << "Removed address " << address << " on interface " << interface
-                << " at " << Simulator::Now().GetSeconds() << "s\n";
+  if (m_ipv4->GetNAddresses(interface) == 0)
+  {
+    CloseSocket(interface);
+  }
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::SaveState(FrtaSnapshotWriter& writer) const
+{
+  NS_LOG_FUNCTION(this);
+  
+  // One-hop entries in the route cache double as the neighbor set
+  writer.WriteU32(m_routeCache.size());
+  for (const auto& entry : m_routeCache)
+  {
+    writer.WriteAddress(entry.first);
+    writer.WriteAddress(entry.second.nextHop);
+    writer.WriteDouble(entry.second.trust);
+    writer.WriteAge(entry.second.lastUpdate);
+    writer.WriteU32(entry.second.hopCount);
+  }
+  
+  writer.WriteU32(m_trustValues.size());
+  for (const auto& entry : m_trustValues)
+  {
+    writer.WriteAddress(entry.first);
+    writer.WriteDouble(entry.second);
+  }
+  
+  writer.WriteU32(m_packetCounts.size());
+  for (const auto& entry : m_packetCounts)
+  {
+    writer.WriteAddress(entry.first);
+    writer.WriteU32(entry.second);
+  }
+  
+  m_collisionDetector.SaveState(writer);
+  
+  // Carried bundles survive a warm restart
+  m_bundles.SaveState(writer);
+}
+
+template <typename Policy>
+bool
+FrtaRoutingProtocolT<Policy>::RestoreState(FrtaSnapshotReader& reader)
+{
+  NS_LOG_FUNCTION(this);
+  
+  uint32_t nRoutes = reader.ReadU32();
+  for (uint32_t i = 0; i < nRoutes && reader.IsOk(); i++)
+  {
+    Ipv4Address destination = reader.ReadAddress();
+    RouteEntry entry;
+    entry.nextHop = reader.ReadAddress();
+    entry.trust = reader.ReadDouble();
+    entry.lastUpdate = reader.ReadAge();
+    entry.hopCount = reader.ReadU32();
+    StoreRoute(destination, entry);
+  }
+  
+  uint32_t nTrust = reader.ReadU32();
+  for (uint32_t i = 0; i < nTrust && reader.IsOk(); i++)
+  {
+    Ipv4Address node = reader.ReadAddress();
+    m_trustValues[node] = reader.ReadDouble();
+  }
+  
+  uint32_t nCounts = reader.ReadU32();
+  for (uint32_t i = 0; i < nCounts && reader.IsOk(); i++)
+  {
+    Ipv4Address node = reader.ReadAddress();
+    m_packetCounts[node] = reader.ReadU32();
+  }
+  
+  bool ok = m_collisionDetector.RestoreState(reader);
+  return m_bundles.RestoreState(reader) && ok;
+}
+
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+  NS_LOG_FUNCTION(this);
+  std::ostream* os = stream->GetStream();
+  *os << "Node: " << m_ipv4->GetObject<Node>()->GetId()
+      << ", Time: " << Simulator::Now().As(unit)
+      << ", FrtaRoutingProtocol Route Cache\n"
+      << "Destination\tNextHop\tHops\tTrust\tNodeTrust\tAge\tSeqNo\n";
+  for (const auto& entry : m_routeCache)
+  {
+    auto trustIt = m_trustValues.find(entry.first);
+    *os << entry.first << "\t" << entry.second.nextHop
+        << "\t" << entry.second.hopCount
+        << "\t" << entry.second.trust
+        << "\t" << (trustIt != m_trustValues.end() ? trustIt->second : GetDefaultTrust())
+        << "\t" << (Simulator::Now() - entry.second.lastUpdate).As(unit)
+        << "\t" << entry.second.seqNo << "\n";
+  }
+  *os << "\n";
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+FrtaRoutingProtocolT<Policy>::WriteRouteCache(std::ostream& os, const std::string& prefix) const
 {
   NS_LOG_FUNCTION(this);
-  *stream->GetStream() << "FrtaRoutingProtocol Routing Table\n";
-  for (const auto& entry : m_routingTable)
+  uint32_t nodeId = m_ipv4->GetObject<Node>()->GetId();
+  Time now = Simulator::Now();
+  for (const auto& entry : m_routeCache)
   {
-    *stream->GetStream() << "Destination: " << entry.first
-                         << ", Route: " << *entry.second
-                         << ", Trust: " << m_trustValues.at(entry.first) << "\n";
-    g_protocolLog << "Printed route to " << entry.first
-                  << " (trust: " << m_trustValues.at(entry.first)
-                  << ") at " << Simulator::Now().GetSeconds() << "s\n";
+    os << prefix << nodeId
+       << ',' << entry.first
+       << ',' << entry.second.nextHop
+       << ',' << entry.second.hopCount
+       << ',' << entry.second.trust
+       << ',' << (now - entry.second.lastUpdate).GetSeconds()
+       << ',' << entry.second.seqNo
+       << ',' << m_collisionDetector.GetLinkCollisionProbability(entry.second.nextHop)
+       << '\n';
   }
 }
 
+template <typename Policy>
 bool
-FrtaRoutingProtocol::DetectCollision(Ptr<const Packet> packet, Ipv4Address nextHop)
+FrtaRoutingProtocolT<Policy>::DetectCollision(Ptr<const Packet> packet, Ipv4Address nextHop)
 {
   NS_LOG_FUNCTION(this << packet << nextHop);
   
@@ -915,13 +4395,12 @@ FrtaRoutingProtocol::DetectCollision(Ptr<const Packet> packet, Ipv4Address nextH
   auto it = m_trustValues.find(nextHop);
   if (it == m_trustValues.end())
   {
-    // For unknown nodes, give them a chance
-    m_trustValues[nextHop] = 0.5;
+    // For unknown nodes, give them a chance without creating state for them
     return false;
   }
   
   // More lenient trust threshold for collision detection
-  if (it->second < 0.3)  // Lowered from 0.5
+  if (IsLowTrust(it->second))
   {
     g_protocolLog << "DetectCollision: Low trust value (" << it->second
                   << ") for " << nextHop << " at " << Simulator::Now().GetSeconds() << "s\n";
@@ -930,7 +4409,7 @@ FrtaRoutingProtocol::DetectCollision(Ptr<const Packet> packet, Ipv4Address nextH
   
   // More lenient packet count threshold
   auto countIt = m_packetCounts.find(nextHop);
-  if (countIt != m_packetCounts.end() && countIt->second > 200)  // Increased from 100
+  if (countIt != m_packetCounts.end() && IsOverloaded(countIt->second))
   {
     g_protocolLog << "DetectCollision: High packet count (" << countIt->second
                   << ") for " << nextHop << " at " << Simulator::Now().GetSeconds() << "s\n";
@@ -942,8 +4421,9 @@ FrtaRoutingProtocol::DetectCollision(Ptr<const Packet> packet, Ipv4Address nextH
   return false;
 }
 
-std::vector<std::vector<Ipv4Address>>
-FrtaRoutingProtocol::FindAllPaths(Ipv4Address source, Ipv4Address destination)
+template <typename Policy>
+FrtaPathList
+FrtaRoutingProtocolT<Policy>::FindAllPaths(Ipv4Address source, Ipv4Address destination)
 {
   NS_LOG_FUNCTION(this << source << destination);
   
@@ -952,47 +4432,22 @@ FrtaRoutingProtocol::FindAllPaths(Ipv4Address source, Ipv4Address destination)
   if (cacheIt != m_cachedPaths.end())
   {
     Time cacheAge = Simulator::Now() - m_routeRequestTime[destination];
-    if (cacheAge < ROUTE_CACHE_TIMEOUT)
+    if (cacheAge < m_routeCacheTimeout)
     {
       return cacheIt->second;
     }
   }
   
-  std::vector<std::vector<Ipv4Address>> paths;
-  std::vector<Ipv4Address> currentPath;
-  std::set<Ipv4Address> visited;
-  
-  // Helper lambda for DFS path finding
-  std::function<void(Ipv4Address)> findPaths = [&](Ipv4Address current) {
-    if (paths.size() >= MAX_PATHS)
-    {
-      return;
-    }
-    
-    currentPath.push_back(current);
-    visited.insert(current);
-    
-    if (current == destination)
-    {
-      paths.push_back(currentPath);
-    }
-    else
-    {
-      // Check neighbors from routing table
-      for (const auto& entry : m_routeCache)
-      {
-        if (visited.find(entry.first) == visited.end())
-        {
-          findPaths(entry.first);
-        }
-      }
-    }
-    
-    currentPath.pop_back();
-    visited.erase(current);
-  };
+  // Intern every candidate hop up front so the search itself only touches
+  // dense identifiers held inline in the path
+  for (const auto& entry : m_routeCache)
+  {
+    m_nodeIds.GetId(entry.first);
+  }
   
-  findPaths(source);
+  FrtaPathList paths;
+  FrtaPath currentPath;
+  FindPathsFrom(m_nodeIds.GetId(source), m_nodeIds.GetId(destination), currentPath, paths);
   
   // Cache the found paths
   m_cachedPaths[destination] = paths;
@@ -1001,95 +4456,135 @@ FrtaRoutingProtocol::FindAllPaths(Ipv4Address source, Ipv4Address destination)
   return paths;
 }
 
-std::vector<Ipv4Address>
-FrtaRoutingProtocol::SelectTrustedPath(Ipv4Address source, Ipv4Address destination)
+template <typename Policy>
+void
+FrtaRoutingProtocolT<Policy>::FindPathsFrom(uint32_t current, uint32_t destination,
+                                            FrtaPath& currentPath, FrtaPathList& paths)
+{
+  // Depth-first search bounded by the number of paths and the hop limit
+  if (paths.Size() >= m_maxPaths || !currentPath.PushBack(current))
+  {
+    return;
+  }
+  
+  if (current == destination)
+  {
+    paths.Add(currentPath);
+  }
+  else if (currentPath.GetHopCount() < m_maxHopCount)
+  {
+    // Check neighbors from routing table
+    for (const auto& entry : m_routeCache)
+    {
+      uint32_t neighbor;
+      if (m_nodeIds.Lookup(entry.first, neighbor) && !currentPath.Contains(neighbor))
+      {
+        FindPathsFrom(neighbor, destination, currentPath, paths);
+      }
+    }
+  }
+  
+  currentPath.PopBack();
+}
+
+template <typename Policy>
+FrtaPath
+FrtaRoutingProtocolT<Policy>::SelectTrustedPath(Ipv4Address source, Ipv4Address destination)
 {
   NS_LOG_FUNCTION(this << source << destination);
   
+  // Identifiers of nodes that left the route cache are never reused, so the
+  // map is started afresh once they dominate; paths built from the old
+  // identifiers go with it
+  if (m_nodeIds.Trim(m_routeCache.size() + 3))
+  {
+    m_cachedPaths.clear();
+    m_pathTrustValues.clear();
+  }
+  
   // First try direct route if available
   auto directIt = m_routeCache.find(destination);
   if (directIt != m_routeCache.end() && 
-      Simulator::Now() - directIt->second.lastUpdate < ROUTE_CACHE_TIMEOUT)
+      Simulator::Now() - directIt->second.lastUpdate < m_routeCacheTimeout)
   {
-    std::vector<Ipv4Address> directPath;
-    directPath.push_back(source);
-    directPath.push_back(directIt->second.nextHop);
-    directPath.push_back(destination);
+    FrtaPath directPath;
+    directPath.PushBack(m_nodeIds.GetId(source));
+    directPath.PushBack(m_nodeIds.GetId(directIt->second.nextHop));
+    directPath.PushBack(m_nodeIds.GetId(destination));
     return directPath;
   }
   
   // If no direct route, try finding all paths
-  auto paths = FindAllPaths(source, destination);
-  if (!paths.empty())
+  FrtaPathList paths = FindAllPaths(source, destination);
+  
+  // Find path with highest minimum trust value; with beta trust the
+  // values are confidence-weighted, so barely known relays do not win.
+  // With channel diversity the trust is taken per unit of WCETT-style
+  // cost, so of equally trusted paths the one alternating channels wins.
+  double bestTrust = -1;
+  FrtaPath bestPath;
+  for (const auto& path : paths)
   {
-    // Find path with highest minimum trust value
-    double bestTrust = -1;
-    std::vector<Ipv4Address> bestPath;
-    
-    for (const auto& path : paths)
+    double pathTrust = CalculatePathTrust(path);
+    if (m_channelDiversity)
     {
-      double pathTrust = CalculatePathTrust(path);
-      if (pathTrust > bestTrust)
-      {
-        bestTrust = pathTrust;
-        bestPath = path;
-      }
+      pathTrust /= std::max(1.0, GetPathChannelCost(path));
     }
-    
-    if (!bestPath.empty())
+    if (m_txPowerControl && path.Size() > 1)
+    {
+      // A first hop reached at low power silences a smaller area
+      pathTrust /= 1 + GetTxPowerCost(m_nodeIds.GetAddress(path[1]));
+    }
+    if (pathTrust > bestTrust)
     {
-      return bestPath;
+      bestTrust = pathTrust;
+      bestPath = path;
     }
   }
   
-  // If no path found, return empty vector
-  return std::vector<Ipv4Address>();
+  // Empty if no path was found
+  return bestPath;
 }
 
+template <typename Policy>
 bool
-FrtaRoutingProtocol::IsPathTrusted(const std::vector<Ipv4Address>& path)
+FrtaRoutingProtocolT<Policy>::IsPathTrusted(const FrtaPath& path)
 {
   NS_LOG_FUNCTION(this);
   
-  if (path.empty())
+  if (path.Empty())
   {
     return false;
   }
   
   double pathTrust = CalculatePathTrust(path);
-  return pathTrust >= MIN_PATH_TRUST;
+  return pathTrust >= m_minPathTrust;
 }
 
+template <typename Policy>
 double
-FrtaRoutingProtocol::CalculatePathTrust(const std::vector<Ipv4Address>& path)
+FrtaRoutingProtocolT<Policy>::CalculatePathTrust(const FrtaPath& path)
 {
   NS_LOG_FUNCTION(this);
   
-  if (path.empty())
+  if (path.Empty())
   {
     return 0.0;
   }
   
-  // Check if we have a cached trust value
+  // Check if we have a cached trust value; beta and recommended trust
+  // change without path updates, so they are always evaluated afresh
   auto it = m_pathTrustValues.find(path);
-  if (it != m_pathTrustValues.end())
+  if (!m_betaTrust && !m_recommendationTrust && it != m_pathTrustValues.end())
   {
     return it->second;
   }
   
   // Calculate trust as minimum of node trust values along path
   double minTrust = 1.0;
-  for (const auto& node : path)
+  for (uint32_t node : path)
   {
-    auto trustIt = m_trustValues.find(node);
-    if (trustIt != m_trustValues.end())
-    {
-      minTrust = std::min(minTrust, trustIt->second);
-    }
-    else
-    {
-      minTrust = std::min(minTrust, 0.5); // Default trust for unknown nodes
-    }
+    minTrust = std::min(minTrust, GetNodeTrustScore(m_nodeIds.GetAddress(node)));
   }
   
   // Cache the calculated trust value
@@ -1097,34 +4592,39 @@ FrtaRoutingProtocol::CalculatePathTrust(const std::vector<Ipv4Address>& path)
   return minTrust;
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::UpdatePathTrust(const std::vector<Ipv4Address>& path, bool success)
+FrtaRoutingProtocolT<Policy>::UpdatePathTrust(const FrtaPath& path, bool success)
 {
   NS_LOG_FUNCTION(this << success);
   
-  if (path.empty())
+  if (path.Empty())
   {
     return;
   }
   
   // Update trust values for all nodes in the path
-  for (const auto& node : path)
+  for (uint32_t id : path)
   {
-    auto& trust = m_trustValues[node];
-    if (success)
+    Ipv4Address node = m_nodeIds.GetAddress(id);
+    if (m_betaTrust)
     {
-      trust = std::min(1.0, trust + 0.1);
+      ObserveTrust(node, success ? 1 : 0, success ? 0 : 1);
     }
     else
     {
-      trust = std::max(0.0, trust - 0.2);
+      auto trustIt = m_trustValues.find(node);
+      double trust = (trustIt != m_trustValues.end()) ? trustIt->second : GetDefaultTrust();
+      m_trustValues[node] = AdjustTrust(trust, success);
+      PublishTrust(node);
     }
     
     // Update collision statistics for each node
     m_collisionDetector.UpdateTransmissionStats(node, success);
   }
   
-  // Update path trust value
+  // Update path trust value from the new node trust values
+  m_pathTrustValues.erase(path);
   double newTrust = CalculatePathTrust(path);
   m_pathTrustValues[path] = newTrust;
   
@@ -1133,18 +4633,20 @@ FrtaRoutingProtocol::UpdatePathTrust(const std::vector<Ipv4Address>& path, bool
                 << Simulator::Now().GetSeconds() << "s\n";
 }
 
+template <typename Policy>
 void
-FrtaRoutingProtocol::CleanupRoutingTable()
+FrtaRoutingProtocolT<Policy>::CleanupRoutingTable()
 {
   NS_LOG_FUNCTION(this);
+  FrtaArena::Scope scratch(m_scratch);
   
   Time now = Simulator::Now();
-  std::vector<Ipv4Address> toRemove;
+  std::pmr::vector<Ipv4Address> toRemove(m_scratch.GetResource());
   
   // Find expired routes
   for (const auto& entry : m_routeCache)
   {
-    if (now - entry.second.lastUpdate >= ROUTE_CACHE_TIMEOUT)
+    if (now - entry.second.lastUpdate >= m_routeCacheTimeout)
     {
       toRemove.push_back(entry.first);
     }
@@ -1154,12 +4656,20 @@ FrtaRoutingProtocol::CleanupRoutingTable()
   for (const auto& addr : toRemove)
   {
     m_routeCache.erase(addr);
+    m_alternateHops.erase(addr);
     g_protocolLog << "Removed expired route to " << addr 
                   << " at " << now.GetSeconds() << "s\n";
   }
   
+  m_flowTable.Expire();
+  m_multicastTrees.Expire();
+  
   // Schedule next cleanup
-  Simulator::Schedule(ROUTE_CACHE_TIMEOUT, &FrtaRoutingProtocol::CleanupRoutingTable, this);
+  Simulator::Schedule(m_routeCacheTimeout, &FrtaRoutingProtocolT::CleanupRoutingTable, this);
 }
 
+template class FrtaRoutingProtocolT<FrtaDefaultTrustPolicy>;
+template class FrtaRoutingProtocolT<FrtaConservativeTrustPolicy>;
+template class FrtaRoutingProtocolT<FrtaLenientTrustPolicy>;
+
 } // namespace ns3
\ No newline at end of file
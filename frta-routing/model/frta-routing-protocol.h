@@ -8,17 +8,43 @@
 #include "ns3/ipv4.h"
 #include "ns3/socket.h"
 #include "ns3/nstime.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/ipv4-address.h"
 #include "frta-routing-header.h"
 #include "frta-state.h"
 #include "frta-collision-detector.h"
+#include "frta-snapshot.h"
+#include "frta-bounded-map.h"
+#include "frta-path.h"
+#include "frta-arena.h"
+#include "frta-packet-pool.h"
+#include "frta-trust-policy.h"
+#include "frta-flow-table.h"
+#include "frta-fingerprint-cache.h"
+#include "frta-network-coding.h"
+#include "frta-dtn.h"
+#include "frta-watchdog.h"
+#include "frta-beta-trust.h"
+#include "frta-recommendation-trust.h"
+#include "frta-trust-replica.h"
+#include "frta-multicast.h"
+#include <array>
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
 namespace ns3 {
 
+class WifiPhy;
+class WifiTxVector;
+struct MpduInfo;
+struct SignalNoiseDbm;
+
 // Forward declarations
 class RouteRequestHeader;
 class RouteReplyHeader;
@@ -46,6 +72,95 @@ private:
   double m_trust;
 };
 
+/**
+ * \brief Prioritized candidate forwarders of an opportunistically routed packet
+ *
+ * The packet is sent to the link-layer broadcast address and every listed
+ * candidate that receives it may forward it. The first candidate has the
+ * highest priority. Candidates wait for a delay growing with their rank and
+ * drop the packet if a higher-priority candidate is heard forwarding it
+ * first, or if the destination, which always ranks first, acknowledges it.
+ * The tag also names the node that transmitted this copy.
+ */
+class FrtaCandidateTag : public Tag
+{
+public:
+  static const uint32_t MAX_CANDIDATES = FRTA_MAX_PATHS + 1;  //!< Destination and next hops
+
+  FrtaCandidateTag();
+
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(TagBuffer i) const;
+  virtual void Deserialize(TagBuffer i);
+  virtual void Print(std::ostream &os) const;
+
+  void SetForwarder(Ipv4Address forwarder);
+  Ipv4Address GetForwarder(void) const;
+
+  /**
+   * \brief Append a candidate with a lower priority than those already listed
+   * \return false if the list is full
+   */
+  bool AddCandidate(Ipv4Address candidate);
+  uint32_t GetNCandidates(void) const;
+  Ipv4Address GetCandidate(uint32_t i) const;
+
+  /**
+   * \return the position of a candidate in the list, or GetNCandidates() if
+   * it is not listed
+   */
+  uint32_t GetRank(Ipv4Address candidate) const;
+
+private:
+  Ipv4Address m_forwarder;                                 //!< Transmitter of this copy
+  std::array<Ipv4Address, MAX_CANDIDATES> m_candidates;    //!< Candidates by priority
+  uint8_t m_nCandidates;                                   //!< Number of candidates
+};
+
+/**
+ * \brief Transmitter of a data packet over its last hop
+ *
+ * Used by network coding: the transmitter is known to hold the packet.
+ */
+class FrtaCodingTag : public Tag
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(TagBuffer i) const;
+  virtual void Deserialize(TagBuffer i);
+  virtual void Print(std::ostream &os) const;
+
+  void SetTransmitter(Ipv4Address transmitter);
+  Ipv4Address GetTransmitter(void) const;
+
+private:
+  Ipv4Address m_transmitter;
+};
+
+/**
+ * \brief Marks a locally originated delay-tolerant packet without a route
+ *
+ * RouteOutput() sends such a packet over the loopback device with this tag,
+ * and RouteInput() moves it into the bundle store.
+ */
+class FrtaDeferredTag : public Tag
+{
+public:
+  static TypeId GetTypeId(void);
+  virtual TypeId GetInstanceTypeId(void) const;
+
+  virtual uint32_t GetSerializedSize(void) const;
+  virtual void Serialize(TagBuffer i) const;
+  virtual void Deserialize(TagBuffer i);
+  virtual void Print(std::ostream &os) const;
+};
+
 /**
  * \brief Route entry structure
  */
@@ -54,10 +169,38 @@ struct RouteEntry {
   double trust;
   Time lastUpdate;
   uint32_t hopCount;
+  uint32_t seqNo;      //!< Per-node sequence number of the last update
+  uint32_t interface;  //!< Interface the next hop is reached on
+  double channelCost = 0;  //!< WCETT-style cost of the path, 0 if its channels are unknown
+};
+
+/**
+ * \brief Next hops to a destination other than the one in its route entry
+ */
+struct AlternateHops {
+  static const uint32_t MAX_HOPS = FRTA_MAX_PATHS - 1;  //!< Capacity
+  std::array<Ipv4Address, MAX_HOPS> nextHop;            //!< Alternate next hops
+  std::array<Time, MAX_HOPS> lastUpdate;                //!< When each was last confirmed
+  std::array<uint32_t, MAX_HOPS> hopCount;              //!< Hops from each to the destination
+  std::array<double, MAX_HOPS> channelCost;             //!< Channel cost of the path through each
+  uint32_t n = 0;                                       //!< Number of alternates
+};
+
+/**
+ * \brief Counters of relay-side aggregation
+ */
+struct FrtaAggregationStats {
+  uint64_t frames = 0;         //!< Aggregate frames sent
+  uint64_t packets = 0;        //!< Packets carried by aggregate frames
+  uint64_t deaggregated = 0;   //!< Packets recovered from received aggregate frames
 };
 
 /**
  * \brief Fault-Resilient Trust-Aware (FRTA) Routing Protocol
+ *
+ * Holds the attributes, state and statistics of the protocol. The protocol
+ * itself is FrtaRoutingProtocolT, which evaluates its trust policy at
+ * compile time; this class is the type helpers and applications refer to.
  */
 class FrtaRoutingProtocol : public Ipv4RoutingProtocol
 {
@@ -67,13 +210,445 @@ public:
     FRTA_ROUTE_REQUEST  = 1,
     FRTA_ROUTE_REPLY    = 2,
     FRTA_ROUTE_ADVERTISEMENT = 3,
-    FRTA_TRUST_UPDATE   = 4
+    FRTA_TRUST_UPDATE   = 4,
+    FRTA_CODED_PACKET   = 5,
+    FRTA_RECEPTION_REPORT = 6,
+    FRTA_AGGREGATE      = 7,
+    FRTA_BUNDLE         = 8,
+    FRTA_DTN_BEACON     = 9,
+    FRTA_TRUST_VECTOR   = 10,
+    FRTA_TRUST_DIGEST   = 11,
+    FRTA_TRUST_REQUEST  = 12,
+    FRTA_MCAST_QUERY    = 13,
+    FRTA_MCAST_JOIN     = 14,
+    FRTA_CHANNEL_REPORT = 15,
+    FRTA_OPP_ACK        = 16,
+    FRTA_CUSTODY_ACK    = 17
   };
 
+  /**
+   * \brief Callback invoked when a route resolution completes
+   *
+   * Arguments are the destination and whether a route is now available.
+   */
+  typedef Callback<void, Ipv4Address, bool> RouteResolvedCallback;
+
+  static const uint16_t FRTA_PORT = 9;  //!< UDP port FRTA control packets are sent from and to
+
   static TypeId GetTypeId(void);
   FrtaRoutingProtocol();
   virtual ~FrtaRoutingProtocol();
 
+  // Protocol specific methods, implemented by FrtaRoutingProtocolT
+  virtual void Start() = 0;
+  virtual void Stop() = 0;
+  virtual void SetUpdateInterval(Time interval) = 0;
+
+  /**
+   * \brief Pre-size per-node state for a network of the given size
+   * \param nodes Expected number of nodes in the network
+   */
+  virtual void ReserveNodes(uint32_t nodes) = 0;
+
+  /**
+   * \brief Enable or disable the shared frta-protocol.log output
+   * \param enable Whether protocol events are written to the log
+   */
+  static void EnableProtocolLog(bool enable);
+
+  /**
+   * \brief Append route cache, trust table and collision statistics to a snapshot
+   * \param writer The snapshot being built
+   */
+  virtual void SaveState(FrtaSnapshotWriter& writer) const = 0;
+
+  /**
+   * \brief Restore route cache, trust table and collision statistics from a snapshot
+   * \param reader The snapshot being read
+   * \return true if this node's record was read completely
+   */
+  virtual bool RestoreState(FrtaSnapshotReader& reader) = 0;
+
+  /**
+   * \brief Write the route cache as CSV rows
+   * \param os The output stream
+   * \param prefix Leading columns prepended to every row
+   *
+   * Each row holds node, destination, next hop, hops, trust, age in seconds,
+   * sequence number and the collision probability of the next hop.
+   */
+  virtual void WriteRouteCache(std::ostream& os, const std::string& prefix) const = 0;
+
+  /**
+   * \return the number of entries evicted from all bounded state tables
+   */
+  uint64_t GetStateEvictions() const;
+
+  /**
+   * \return the fraction of control packets built in a recycled Packet
+   * object; see FrtaPacketPool for what this does and does not save
+   */
+  double GetPacketPoolHitRate() const;
+
+  /**
+   * \brief Find out when a route to a destination is available
+   * \param destination The destination to resolve
+   * \param callback Invoked with the outcome of the resolution
+   * \param timeout How long to wait for a route before reporting failure
+   * \return true if a route is already cached, in which case the callback
+   * has been invoked before returning
+   *
+   * Without a cached route, a route discovery is started, or joined if one
+   * is already in progress, and repeated until the timeout expires. The
+   * callback is invoked once, with true as soon as a route is learned or
+   * with false when the timeout expires.
+   */
+  virtual bool ResolveRoute(Ipv4Address destination, RouteResolvedCallback callback,
+                            Time timeout) = 0;
+
+  /**
+   * \return the table pinning flows to next hops, with per-flow and
+   * per-next-hop byte counters
+   */
+  const FrtaFlowTable& GetFlowTable() const;
+
+  /**
+   * \return the counters of the network coding layer, including the coding
+   * opportunities taken
+   */
+  const FrtaCodingStats& GetCodingStats() const;
+
+  /**
+   * \return the counters of relay-side aggregation of small packets
+   */
+  const FrtaAggregationStats& GetAggregationStats() const;
+
+  /**
+   * \return the counters of the delay-tolerant layer
+   */
+  const FrtaDtnStats& GetDtnStats() const;
+
+  /**
+   * \return the number of bundles this node carries
+   */
+  uint32_t GetNBundles() const;
+
+  /**
+   * \return the counters of the forwarding watchdog
+   */
+  const FrtaWatchdogStats& GetWatchdogStats() const;
+
+  /**
+   * \return the number of looping packets dropped by this node
+   */
+  uint64_t GetLoopsDetected() const;
+
+  /**
+   * \brief Receive the traffic of a multicast group on this node
+   * \param group The multicast group
+   *
+   * The node joins the forwarding tree of every source of the group at the
+   * next query of the source. Requires the Multicast attribute.
+   */
+  virtual void JoinGroup(Ipv4Address group) = 0;
+
+  /**
+   * \brief Stop receiving the traffic of a multicast group
+   * \param group The multicast group
+   */
+  virtual void LeaveGroup(Ipv4Address group) = 0;
+
+  /**
+   * \brief Use fixed random variable streams
+   * \param stream First stream index to use
+   * \return the number of stream indices assigned
+   */
+  virtual int64_t AssignStreams(int64_t stream) = 0;
+
+  /**
+   * \brief Set the channel of a radio
+   * \param interface The interface of the radio
+   * \param channel The channel number
+   *
+   * A Wi-Fi radio is retuned to the channel within its band. Other devices
+   * are only labelled, so that route discovery accounts for their channel.
+   */
+  virtual void SetInterfaceChannel(uint32_t interface, uint8_t channel) = 0;
+
+  /**
+   * \return the channel of the radio on an interface, 0 if it is unknown
+   */
+  virtual uint8_t GetInterfaceChannel(uint32_t interface) const = 0;
+
+  /**
+   * \return the traffic on a channel around this node in bytes per second,
+   * as measured locally and reported by neighbors
+   */
+  virtual uint64_t GetChannelLoad(uint8_t channel) const = 0;
+
+  /**
+   * \brief Move a radio to the least loaded of several channels
+   * \param interface The interface of the radio
+   * \param channels Candidate channels, not empty
+   * \return the channel chosen
+   *
+   * Channels of the other radios of this node are only chosen if all
+   * candidates are taken. Loads of neighbors are known with the
+   * ChannelDiversity attribute.
+   */
+  virtual uint8_t SelectChannel(uint32_t interface, const std::vector<uint8_t>& channels) = 0;
+
+  /**
+   * \return the path loss to a neighbor in dB, learned from its broadcasts
+   * with the TxPowerControl attribute, 0 if unknown
+   */
+  virtual double GetPathLoss(Ipv4Address neighbor) const = 0;
+
+protected:
+  // Constants
+  static const uint32_t CONTROL_PACKET_HEADROOM = 128;  //!< Room for FRTA, UDP, IP and MAC headers
+
+  // Member variables
+  Ptr<Ipv4> m_ipv4;
+  std::map<uint32_t, Ptr<Socket>> m_sockets;  //!< Control socket by interface
+  std::map<uint32_t, Ptr<Socket>> m_broadcastSockets;  //!< Receives control broadcasts, by interface
+  Time m_updateInterval;
+  Ptr<UniformRandomVariable> m_random;
+  bool m_running;
+  bool m_initialized;        //!< Whether the routing table has been initialized
+  uint32_t m_routeSeqNo;     //!< Sequence number of the last route cache update
+  uint32_t m_expectedNodes;  //!< Expected network size used to pre-size per-node state
+  
+  // Protocol parameters
+  Time m_routeRequestTimeout;  //!< Time to wait for a route reply
+  Time m_routeCacheTimeout;    //!< Lifetime of a route cache entry
+  uint32_t m_maxHopCount;      //!< Maximum hops of a forwarded request or found path
+  double m_minPathTrust;       //!< Minimum trust of a usable route or path
+  uint32_t m_maxPaths;         //!< Maximum alternative paths kept per destination
+  Time m_minJitter;            //!< Minimum delay before forwarding or replying
+  Time m_maxJitter;            //!< Maximum delay before forwarding or replying
+  
+  // Bounds on per-node state, 0 for unbounded
+  uint32_t m_maxRouteCacheEntries;     //!< Capacity of the route cache
+  uint32_t m_maxTrustEntries;          //!< Capacity of the trust and packet count tables
+  uint32_t m_maxCollisionStatsEntries; //!< Capacity of the collision statistics tables
+  uint32_t m_maxPathCacheEntries;      //!< Capacity of the path caches
+  bool m_evictLeastValuable;           //!< Evict least valuable instead of least recently used
+  uint32_t m_packetPoolSize;           //!< Number of pooled control packets, 0 to disable
+  
+  // Flow pinning
+  bool m_flowPinning;                  //!< Pin flows to one of several next hops
+  Time m_flowletGap;                   //!< Idle time after which a flow may move
+  Time m_flowIdleTimeout;              //!< Idle time after which a flow is forgotten
+  uint32_t m_maxFlowEntries;           //!< Capacity of the flow table
+  
+  // Opportunistic forwarding
+  bool m_opportunistic;                //!< Broadcast data packets to ranked candidates
+  Time m_candidateSlot;                //!< Forwarding delay added per candidate rank
+  uint32_t m_maxCandidates;            //!< Maximum candidate forwarders per packet
+  
+  // Network coding
+  bool m_networkCoding;                //!< XOR packets for opposite directions at relays
+  Time m_codingHoldTime;               //!< Time a packet waits for a coding partner
+  Time m_receptionReportInterval;      //!< Interval between reception reports
+  
+  // Aggregation of small packets
+  bool m_aggregation;                  //!< Aggregate small packets sharing a next hop
+  Time m_aggregationDelay;             //!< Longest time a packet waits for aggregation
+  uint32_t m_aggregationMaxPacketSize; //!< Largest packet that is aggregated
+  uint32_t m_aggregationMaxFrameSize;  //!< Largest aggregate frame
+  
+  // Delay-tolerant store-carry-forward
+  bool m_delayTolerant;                //!< Carry undeliverable packets of the DTN class
+  uint32_t m_dtnDscp;                  //!< DSCP marking the delay-tolerant class
+  Time m_dtnBeaconInterval;            //!< Interval between predictability beacons
+  Time m_dtnBundleLifetime;            //!< Lifetime of a new bundle
+  uint32_t m_dtnMaxCustody;            //!< Custody transfers after which only the destination takes a bundle
+  uint32_t m_dtnStoreSize;             //!< Capacity of the bundle store
+  
+  // Forwarding watchdog
+  bool m_watchdog;                     //!< Verify that next hops forward packets
+  Time m_watchdogTimeout;              //!< Time a next hop has to forward a packet
+  uint32_t m_watchdogWindow;           //!< Outcomes a forward ratio is taken over
+  double m_watchdogThreshold;          //!< Forward ratio below which a next hop is blacklisted
+  Time m_blacklistTime;                //!< Time a next hop stays blacklisted
+  
+  // Beta-reputation trust
+  bool m_betaTrust;                    //!< Derive trust from decaying evidence counts
+  Time m_trustHalfLife;                //!< Time after which trust evidence counts half
+  
+  // Transitive recommendation trust
+  bool m_recommendationTrust;          //!< Judge unobserved nodes by the opinions of neighbors
+  Time m_trustVectorInterval;          //!< Interval between trust vectors
+  uint32_t m_recommendationWork;       //!< Matrix entries visited per trust vector interval
+  
+  // Anti-entropy trust dissemination
+  bool m_antiEntropy;                  //!< Reconcile trust tables with neighbors by digests
+  Time m_antiEntropyInterval;          //!< Interval between trust digests
+  uint32_t m_antiEntropyFanout;        //!< Neighbors asked for differing buckets per interval
+  uint32_t m_trustRequests;            //!< Neighbors asked during the current interval
+  
+  // Loop detection
+  bool m_loopDetection;                //!< Drop packets this node already forwarded
+  Time m_loopDetectionLifetime;        //!< Time a forwarded packet is remembered
+  uint64_t m_loopsDetected;            //!< Looping packets dropped
+  
+  uint8_t m_controlPriority;           //!< Socket priority of control packets
+  
+  // Multicast
+  bool m_multicast;                    //!< Forward multicast along trust-aware source trees
+  Time m_multicastQueryInterval;       //!< Interval between queries of a multicast source
+  uint32_t m_multicastSequence;        //!< Latest query round of this node as a source
+  EventId m_multicastQueryEvent;       //!< Next query round
+  
+  // Channel diversity
+  bool m_channelDiversity;             //!< Prefer paths that alternate channels
+  double m_channelDiversityWeight;     //!< Weight of channel reuse against hop count
+  Time m_channelReportInterval;        //!< Interval between channel reports
+  
+  // Transmit power control
+  bool m_txPowerControl;               //!< Send to each neighbor at the lowest sufficient power
+  double m_txPowerMargin;              //!< Margin in dB above the receiver sensitivity
+  
+  // State management
+  FrtaState m_state;
+  FrtaArena m_scratch;  //!< Scratch memory released after each handler invocation
+  FrtaPacketPool m_packetPool;  //!< Recycled control packets
+  std::set<Ipv4Address> m_pendingRequests;
+  
+  /**
+   * \brief An application waiting for a route
+   */
+  struct RouteWaiter {
+    uint32_t id;                      //!< Identifies the waiter on timeout
+    RouteResolvedCallback callback;   //!< Invoked with the outcome
+    EventId timeoutEvent;             //!< Failure report
+  };
+  std::map<Ipv4Address, std::vector<RouteWaiter>> m_routeWaiters;  //!< Waiters per destination
+  uint32_t m_nextWaiterId;                                         //!< Identifier of the next waiter
+  FrtaBoundedMap<Ipv4Address, Time, Ipv4AddressHash> m_routeRequestTime;
+  std::map<Ipv4Address, Ptr<Ipv4Route>> m_routingTable;
+  FrtaBoundedMap<Ipv4Address, double, Ipv4AddressHash> m_trustValues;
+  FrtaBoundedMap<Ipv4Address, double, Ipv4AddressHash> m_reportedTrust;  //!< Trust merged from neighbors' records
+  FrtaBoundedMap<Ipv4Address, uint32_t, Ipv4AddressHash> m_packetCounts;
+  FrtaBoundedMap<Ipv4Address, RouteEntry, Ipv4AddressHash> m_routeCache;
+  FrtaBoundedMap<Ipv4Address, AlternateHops, Ipv4AddressHash> m_alternateHops;
+  FrtaBoundedMap<Ipv4Address, uint32_t, Ipv4AddressHash> m_neighborInterfaces;  //!< Interface each neighbor was last heard on
+  std::map<uint32_t, uint8_t> m_interfaceChannels;  //!< Channels set through SetInterfaceChannel
+  
+  /**
+   * \brief Traffic on one radio of this node
+   */
+  struct RadioLoad {
+    uint64_t bytes = 0;  //!< Bytes sent and received in the current report interval
+    uint64_t load = 0;   //!< Bytes per second over the last interval
+  };
+  std::map<uint32_t, RadioLoad> m_radioLoads;  //!< By interface
+  
+  /**
+   * \brief Radios of a neighbor as of its last channel report
+   */
+  struct NeighborChannels {
+    std::vector<std::pair<uint8_t, uint32_t>> radios;  //!< Channel and load of each radio
+    Time lastUpdate;                                   //!< Arrival of the report
+  };
+  FrtaBoundedMap<Ipv4Address, NeighborChannels, Ipv4AddressHash> m_neighborChannels;
+  
+  /**
+   * \brief Path loss to a neighbor, from the strength of its broadcasts
+   */
+  struct LinkLoss {
+    double loss;         //!< Smoothed path loss in dB
+    uint32_t interface;  //!< Interface the neighbor was heard on
+  };
+  FrtaBoundedMap<Ipv4Address, LinkLoss, Ipv4AddressHash> m_linkLosses;
+  FrtaFlowTable m_flowTable;
+  
+  /**
+   * \brief An opportunistic packet waiting for its forwarding slot
+   */
+  struct PendingForward {
+    EventId event;                 //!< Forwarding of the packet
+    uint32_t rank;                 //!< Rank of this node among the candidates
+    FrtaCandidateTag candidates;   //!< Candidates the packet was received with
+  };
+  std::unordered_map<uint64_t, PendingForward> m_pendingForwards;  //!< By packet fingerprint
+  FrtaFingerprintCache m_seenPackets;  //!< Opportunistic packets delivered or forwarded
+  FrtaFingerprintCache m_forwardedPackets;  //!< Packets recently forwarded, for loop detection
+  FrtaFingerprintCache m_multicastSeen;     //!< Multicast packets delivered or forwarded
+  FrtaMulticastTable m_multicastTrees;      //!< Group membership and forwarding trees
+  
+  /**
+   * \brief A packet to forward, held briefly in case it can be coded
+   */
+  struct CodingNative {
+    uint64_t fingerprint;           //!< Fingerprint of the packet
+    Ptr<const Packet> payload;      //!< The packet without its IPv4 header
+    Ipv4Header header;              //!< Its IPv4 header
+    Ptr<Ipv4Route> route;           //!< Route to forward it on natively
+    UnicastForwardCallback ucb;     //!< Native forwarding
+    Ipv4Address previousHop;        //!< Transmitter, known to hold the packet
+    EventId flushEvent;             //!< Native forwarding once the hold time is over
+  };
+  std::map<Ipv4Address, std::deque<CodingNative>> m_codingQueues;  //!< Held packets per next hop
+  FrtaNetworkCoder m_coder;
+  
+  /**
+   * \brief A small packet waiting to be aggregated
+   */
+  struct AggregatedPacket {
+    Ptr<const Packet> payload;      //!< The packet without its IPv4 header
+    Ipv4Header header;              //!< Its IPv4 header
+    UnicastForwardCallback ucb;     //!< Native forwarding, if it ends up alone
+  };
+  /**
+   * \brief Small packets waiting for one next hop
+   */
+  struct AggregationBuffer {
+    std::vector<AggregatedPacket> packets;  //!< Packets in arrival order
+    uint32_t bytes = 0;                     //!< Frame size, IPv4 headers included
+    Ptr<Ipv4Route> route;                   //!< Route to the next hop
+    EventId flushEvent;                     //!< Sending of the frame at the delay bound
+  };
+  std::map<Ipv4Address, AggregationBuffer> m_aggregationBuffers;  //!< By next hop
+  FrtaAggregationStats m_aggregationStats;
+  
+  FrtaBundleStore m_bundles;                   //!< Bundles carried by this node
+  FrtaDeliveryPredictability m_predictability; //!< PRoPHET delivery predictabilities
+  FrtaDtnStats m_dtnStats;
+  
+  FrtaBetaTrust m_trustEngine;          //!< Evidence behind trust values, if beta trust is used
+  FrtaRecommendationTrust m_recommendations;  //!< Trust recommended by neighbors
+  FrtaTrustReplica m_trustReplica;      //!< Versioned trust table shared with neighbors
+  FrtaWatchdog m_monitor;               //!< Forwarding verification of next hops
+  Ipv4Address m_lastOutputDestination;  //!< Destination of the last locally routed packet
+  Ipv4Address m_lastOutputNextHop;      //!< Next hop chosen for it
+  
+  // Collision detection and trusted path management
+  FrtaCollisionDetector m_collisionDetector;
+  FrtaNodeIdMap m_nodeIds;  //!< Dense identifiers of the nodes appearing in paths
+  FrtaBoundedMap<FrtaPath, double, FrtaPathHash> m_pathTrustValues;
+  FrtaBoundedMap<Ipv4Address, FrtaPathList, Ipv4AddressHash> m_cachedPaths;
+};
+
+/**
+ * \brief FRTA routing protocol specialized for a trust policy
+ *
+ * The policy is a template parameter, so trust evaluations along the
+ * forwarding path are resolved at compile time. Each instantiation is a
+ * distinct TypeId, named by its policy, so several trust models can be
+ * selected through FrtaRoutingHelper::SetTypeId() and compared within one
+ * build. The instantiations are listed at the end of
+ * frta-routing-protocol.cc.
+ *
+ * \tparam Policy A trust policy, see FrtaDefaultTrustPolicy
+ */
+template <typename Policy>
+class FrtaRoutingProtocolT : public FrtaRoutingProtocol
+{
+public:
+  static TypeId GetTypeId(void);
+
   // Inherited from Ipv4RoutingProtocol
   virtual Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif,
                                     Socket::SocketErrno &sockerr) override;
@@ -87,74 +662,231 @@ public:
   virtual void SetIpv4(Ptr<Ipv4> ipv4) override;
   virtual void PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const override;
 
-  // Protocol specific methods
-  void Start();
-  void Stop();
-  void SetUpdateInterval(Time interval);
+  // Inherited from FrtaRoutingProtocol
+  void Start() override;
+  void Stop() override;
+  void SetUpdateInterval(Time interval) override;
+  void ReserveNodes(uint32_t nodes) override;
+  void SaveState(FrtaSnapshotWriter& writer) const override;
+  bool RestoreState(FrtaSnapshotReader& reader) override;
+  void WriteRouteCache(std::ostream& os, const std::string& prefix) const override;
+  bool ResolveRoute(Ipv4Address destination, RouteResolvedCallback callback, Time timeout) override;
+  void JoinGroup(Ipv4Address group) override;
+  void LeaveGroup(Ipv4Address group) override;
+  int64_t AssignStreams(int64_t stream) override;
+  void SetInterfaceChannel(uint32_t interface, uint8_t channel) override;
+  uint8_t GetInterfaceChannel(uint32_t interface) const override;
+  uint64_t GetChannelLoad(uint8_t channel) const override;
+  uint8_t SelectChannel(uint32_t interface, const std::vector<uint8_t>& channels) override;
+  double GetPathLoss(Ipv4Address neighbor) const override;
 
 protected:
   virtual void DoInitialize() override;
   virtual void DoDispose() override;
 
 private:
+  typedef FrtaTrustModel<Policy> Model;
+
+  /**
+   * \name Trust model
+   *
+   * Evaluations of the trust policy, inlined into their callers.
+   * @{
+   */
+  double GetDefaultTrust() const
+  {
+    return Policy::DEFAULT_TRUST;
+  }
+
+  double GetReverseRouteTrust() const
+  {
+    return Policy::REVERSE_ROUTE_TRUST;
+  }
+
+  double SmoothTrust(double current, double observed) const
+  {
+    return Model::Smooth(current, observed);
+  }
+
+  double AdjustTrust(double trust, bool success) const
+  {
+    return Model::Adjust(trust, success);
+  }
+
+  double TrustFromPacketCount(uint32_t count) const
+  {
+    return Model::FromPacketCount(count);
+  }
+
+  bool IsLowTrust(double trust) const
+  {
+    return Model::IsLowTrust(trust);
+  }
+
+  bool IsOverloaded(uint32_t count) const
+  {
+    return Model::IsOverloaded(count);
+  }
+  /** @} */
+
+  void CreateSocket(uint32_t interface);
+  void CloseSocket(uint32_t interface);
+  void BroadcastControl(Ptr<Packet> packet);
+  void SendControl(Ptr<Packet> packet, Ipv4Address destination, uint32_t interface);
+  bool IsOwnAddress(Ipv4Address address) const;
+  /**
+   * \return the first interface FRTA runs on, -1 if there is none
+   */
+  int32_t GetMainInterface() const;
+  /**
+   * \return the address of the first interface FRTA runs on, which names
+   * this node in trust and delay-tolerant state; 0.0.0.0 if there is none
+   */
+  Ipv4Address GetMainAddress() const;
+  uint32_t GetInterfaceForNeighbor(Ipv4Address neighbor) const;
+  Ptr<Ipv4Route> CreateRoute(Ipv4Address destination, Ipv4Address gateway, uint32_t interface) const;
+  void ApplyStateBounds();
   void InitializeRoutingTable();
+  void AddInterfaceRoutes(uint32_t interface);
   void SendRoutingUpdate();
   void ReceiveRoutingPacket(Ptr<Socket> socket);
   Ptr<Ipv4Route> SelectOptimalPath(Ipv4Address destination);
   bool DetectCollision(Ptr<const Packet> packet, Ipv4Address nextHop);
   void UpdateTrustValue(Ipv4Address node, double trust);
+  void ObserveTrust(Ipv4Address node, double positive, double negative);
+  double GetNodeTrustScore(Ipv4Address node) const;
+  void SendTrustVector();
+  void ProcessTrustVector(Ptr<Packet> packet, Ipv4Address sender);
+  
+  // Anti-entropy trust dissemination
+  void PublishTrust(Ipv4Address node);
+  void MergeTrust(Ipv4Address node, double trust);
+  void SendTrustDigest();
+  void SendTrustRecords(uint16_t buckets, Ipv4Address neighbor);
+  void ProcessTrustDigest(Ptr<Packet> packet, Ipv4Address sender);
+  void ProcessTrustRequest(Ptr<Packet> packet, Ipv4Address sender);
+  void ProcessTrustUpdate(Ptr<Packet> packet, Ipv4Address sender);
+  
+  // Multicast
+  bool RouteMulticastInput(Ptr<const Packet> p, const Ipv4Header& header, Ptr<const NetDevice> idev,
+                           const MulticastForwardCallback& mcb, const LocalDeliverCallback& lcb);
+  void SendMulticastQueries();
+  void ForwardMulticastQuery(Ipv4Address source, Ipv4Address group);
+  void ProcessMulticastQuery(Ptr<Packet> packet, Ipv4Address sender);
+  void SendMulticastJoin(Ipv4Address source, Ipv4Address group, bool join);
+  void ProcessMulticastJoin(Ptr<Packet> packet, Ipv4Address sender);
+  
+  // Channel diversity
+  double GetChannelCost(const std::vector<uint8_t>& channels) const;
+  double GetRouteCost(const RouteEntry& entry) const;
+  double GetPathChannelCost(const FrtaPath& path) const;
+  uint8_t GetLinkChannel(Ipv4Address from, Ipv4Address to, const std::vector<uint8_t>& used) const;
+  bool IsBetterRoute(Ipv4Address destination, const RouteEntry& entry) const;
+  void SendChannelReport();
+  void ProcessChannelReport(Ptr<Packet> packet, Ipv4Address sender);
+  void NoteChannelTraffic(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  Ptr<WifiPhy> GetWifiPhy(uint32_t interface) const;
+  
+  // Transmit power control
+  void NoteRxPower(std::string context, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                   WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise,
+                   uint16_t staId);
+  double GetTxPowerCost(Ipv4Address neighbor) const;
   double CalculateTrustValue(Ipv4Address node);
 
   // Route discovery and management
   void SendRouteRequest(Ipv4Address destination);
-  void SendRouteReply(Ipv4Address destination, Ipv4Address nextHop);
+  void SendRouteReply(Ipv4Address destination, Ipv4Address nextHop, Ipv4Address target,
+                      uint32_t hopCount, const std::vector<uint8_t>& channels);
   void ProcessRouteRequest(Ptr<Packet> packet, Ipv4Address sender);
   void ProcessRouteReply(Ptr<Packet> packet, Ipv4Address sender);
   void UpdateRoute(Ipv4Address destination, Ipv4Address nextHop, double trust);
+  void StoreRoute(Ipv4Address destination, RouteEntry entry);
   void BroadcastRouteAdvertisement();
   void ProcessRouteAdvertisement(Ptr<Packet> packet, Ipv4Address sender);
   void HandleRouteRequestTimeout(Ipv4Address destination);
+  bool HasValidRoute(Ipv4Address destination);
+  void AddAlternateHop(Ipv4Address destination, Ipv4Address nextHop, uint32_t hopCount,
+                       double channelCost);
+  void PruneAlternateHops(Ipv4Address destination, uint32_t hopCount);
+  Ipv4Address SelectNextHop(Ipv4Address destination, const RouteEntry& route, uint64_t flow,
+                            uint32_t bytes);
+  void NotifyRouteResolved(Ipv4Address destination);
+  void HandleResolveTimeout(Ipv4Address destination, uint32_t id);
+  
+  // Opportunistic forwarding
+  bool BuildCandidates(Ipv4Address destination, const RouteEntry& route, FrtaCandidateTag& tag);
+  bool ReceiveOpportunistic(Ptr<const Packet> p, const Ipv4Header& header,
+                            const FrtaCandidateTag& tag, const UnicastForwardCallback& ucb);
+  void SendOpportunisticAck(uint64_t fingerprint, uint32_t interface);
+  void ProcessOpportunisticAck(Ptr<Packet> packet, Ipv4Address sender);
+  void ForwardOpportunistic(uint64_t fingerprint, Ptr<const Packet> p, Ipv4Header header,
+                            UnicastForwardCallback ucb);
+  
+  // Network coding
+  void EnqueueForCoding(Ptr<const Packet> p, const Ipv4Header& header, Ptr<Ipv4Route> route,
+                        const UnicastForwardCallback& ucb);
+  void FlushCodingQueue(Ipv4Address nextHop, uint64_t fingerprint);
+  void ProcessCodedPacket(Ptr<Packet> packet, Ipv4Address sender);
+  void SendReceptionReport();
+  void ProcessReceptionReport(Ptr<Packet> packet, Ipv4Address sender);
+  void NotifyTx(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  void DeliverToIpv4(Ptr<Packet> packet, uint32_t interface);
+  
+  // Aggregation of small packets
+  void EnqueueForAggregation(Ptr<const Packet> p, const Ipv4Header& header, Ptr<Ipv4Route> route,
+                             const UnicastForwardCallback& ucb);
+  void FlushAggregate(Ipv4Address nextHop);
+  void ProcessAggregate(Ptr<Packet> packet, Ipv4Address sender);
+  void SendToNeighbor(Ptr<Packet> frame, Ipv4Address neighbor);
+  
+  // Loop detection
+  bool IsLooping(const Ipv4Header& header);
+  
+  // Delay-tolerant store-carry-forward
+  bool IsDelayTolerant(Ptr<const Packet> p, const Ipv4Header& header) const;
+  void StoreBundle(Ptr<Packet> packet, Ipv4Address destination, Time lifetime, uint32_t custody);
+  void DtnTick();
+  void ProcessDtnBeacon(Ptr<Packet> packet, Ipv4Address sender);
+  void ProcessBundle(Ptr<Packet> packet, Ipv4Address sender);
+  void ProcessCustodyAck(Ptr<Packet> packet, Ipv4Address sender);
+  
+  // Forwarding watchdog
+  void WatchForwarding(const Ipv4Header& header, Ipv4Address nextHop);
+  void Overhear(Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address& from, const Address& to, NetDevice::PacketType packetType);
+  void NoteForwarding(Ipv4Address nextHop, bool forwarded, bool blacklisted);
+  void RouteAround(Ipv4Address nextHop);
   
   // Trusted path implementation
-  std::vector<std::vector<Ipv4Address>> FindAllPaths(Ipv4Address source, Ipv4Address destination);
-  std::vector<Ipv4Address> SelectTrustedPath(Ipv4Address source, Ipv4Address destination);
-  bool IsPathTrusted(const std::vector<Ipv4Address>& path);
-  double CalculatePathTrust(const std::vector<Ipv4Address>& path);
-  void UpdatePathTrust(const std::vector<Ipv4Address>& path, bool success);
+  FrtaPathList FindAllPaths(Ipv4Address source, Ipv4Address destination);
+  void FindPathsFrom(uint32_t current, uint32_t destination, FrtaPath& currentPath, FrtaPathList& paths);
+  FrtaPath SelectTrustedPath(Ipv4Address source, Ipv4Address destination);
+  bool IsPathTrusted(const FrtaPath& path);
+  double CalculatePathTrust(const FrtaPath& path);
+  void UpdatePathTrust(const FrtaPath& path, bool success);
 
   // Additional helper functions
   void CleanupRoutingTable();
-  void ForwardRouteRequest(Ptr<Packet> packet);
+  void ForwardRouteRequest(RouteRequestHeader reqHeader);
   void SendDelayedReply(Ptr<Packet> packet, Ipv4Address nextHop);
+  Time GetJitter();
+};
 
-  // Constants
-  static const Time ROUTE_REQUEST_TIMEOUT;
-  static const Time ROUTE_CACHE_TIMEOUT;
-  static const uint32_t MAX_HOP_COUNT = 10;
-  static constexpr double MIN_PATH_TRUST = 0.5;
-  static const uint32_t MAX_PATHS = 5;
+typedef FrtaRoutingProtocolT<FrtaDefaultTrustPolicy> FrtaDefaultRoutingProtocol;
+typedef FrtaRoutingProtocolT<FrtaConservativeTrustPolicy> FrtaConservativeRoutingProtocol;
+typedef FrtaRoutingProtocolT<FrtaLenientTrustPolicy> FrtaLenientRoutingProtocol;
 
-  // Member variables
-  Ptr<Ipv4> m_ipv4;
-  Ptr<Socket> m_socket;
-  Time m_updateInterval;
-  Ptr<UniformRandomVariable> m_random;
-  bool m_running;
-  
-  // State management
-  FrtaState m_state;
-  std::set<Ipv4Address> m_pendingRequests;
-  std::map<Ipv4Address, Time> m_routeRequestTime;
-  std::map<Ipv4Address, Ptr<Ipv4Route>> m_routingTable;
-  std::map<Ipv4Address, double> m_trustValues;
-  std::map<Ipv4Address, uint32_t> m_packetCounts;
-  std::map<Ipv4Address, RouteEntry> m_routeCache;
-  
-  // Collision detection and trusted path management
-  FrtaCollisionDetector m_collisionDetector;
-  std::map<std::vector<Ipv4Address>, double> m_pathTrustValues;
-  std::map<Ipv4Address, std::vector<std::vector<Ipv4Address>>> m_cachedPaths;
-};
+template <>
+TypeId FrtaDefaultRoutingProtocol::GetTypeId(void);
+template <>
+TypeId FrtaConservativeRoutingProtocol::GetTypeId(void);
+template <>
+TypeId FrtaLenientRoutingProtocol::GetTypeId(void);
+
+extern template class FrtaRoutingProtocolT<FrtaDefaultTrustPolicy>;
+extern template class FrtaRoutingProtocolT<FrtaConservativeTrustPolicy>;
+extern template class FrtaRoutingProtocolT<FrtaLenientTrustPolicy>;
 
 } // namespace ns3
 
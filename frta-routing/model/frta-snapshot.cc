@@ -0,0 +1,197 @@
+#include "frta-snapshot.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaSnapshot");
+
+//-----------------------------------------------------------------------------
+// FrtaSnapshotWriter
+//-----------------------------------------------------------------------------
+
+FrtaSnapshotWriter::FrtaSnapshotWriter()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+FrtaSnapshotWriter::Append(const void* data, uint32_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  m_data.insert(m_data.end(), bytes, bytes + size);
+}
+
+void
+FrtaSnapshotWriter::WriteU32(uint32_t value)
+{
+  Append(&value, sizeof(value));
+}
+
+void
+FrtaSnapshotWriter::WriteU64(uint64_t value)
+{
+  Append(&value, sizeof(value));
+}
+
+void
+FrtaSnapshotWriter::WriteDouble(double value)
+{
+  Append(&value, sizeof(value));
+}
+
+void
+FrtaSnapshotWriter::WriteAddress(Ipv4Address address)
+{
+  WriteU32(address.Get());
+}
+
+void
+FrtaSnapshotWriter::WriteAge(Time timestamp)
+{
+  int64_t age = std::max<int64_t>(0, (Simulator::Now() - timestamp).GetNanoSeconds());
+  Append(&age, sizeof(age));
+}
+
+void
+FrtaSnapshotWriter::WriteBytes(const uint8_t* data, uint32_t size)
+{
+  WriteU32(size);
+  Append(data, size);
+}
+
+void
+FrtaSnapshotWriter::WriteRecord(const FrtaSnapshotWriter& record)
+{
+  WriteU32(record.m_data.size());
+  m_data.insert(m_data.end(), record.m_data.begin(), record.m_data.end());
+}
+
+bool
+FrtaSnapshotWriter::WriteToFile(const std::string& path) const
+{
+  NS_LOG_FUNCTION(this << path);
+  std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    NS_LOG_WARN("Cannot open snapshot file " << path);
+    return false;
+  }
+  file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+  return file.good();
+}
+
+uint32_t
+FrtaSnapshotWriter::GetSize() const
+{
+  return m_data.size();
+}
+
+//-----------------------------------------------------------------------------
+// FrtaSnapshotReader
+//-----------------------------------------------------------------------------
+
+FrtaSnapshotReader::FrtaSnapshotReader(const uint8_t* data, uint64_t size)
+  : m_data(data),
+    m_size(size),
+    m_offset(0),
+    m_ok(true)
+{
+}
+
+bool
+FrtaSnapshotReader::Extract(void* data, uint32_t size)
+{
+  if (!m_ok || m_size - m_offset < size)
+  {
+    m_ok = false;
+    std::memset(data, 0, size);
+    return false;
+  }
+  std::memcpy(data, m_data + m_offset, size);
+  m_offset += size;
+  return true;
+}
+
+uint32_t
+FrtaSnapshotReader::ReadU32()
+{
+  uint32_t value;
+  Extract(&value, sizeof(value));
+  return value;
+}
+
+uint64_t
+FrtaSnapshotReader::ReadU64()
+{
+  uint64_t value;
+  Extract(&value, sizeof(value));
+  return value;
+}
+
+double
+FrtaSnapshotReader::ReadDouble()
+{
+  double value;
+  Extract(&value, sizeof(value));
+  return value;
+}
+
+Ipv4Address
+FrtaSnapshotReader::ReadAddress()
+{
+  return Ipv4Address(ReadU32());
+}
+
+Time
+FrtaSnapshotReader::ReadAge()
+{
+  int64_t age;
+  Extract(&age, sizeof(age));
+  return Simulator::Now() - NanoSeconds(age);
+}
+
+std::vector<uint8_t>
+FrtaSnapshotReader::ReadBytes()
+{
+  uint32_t size = ReadU32();
+  if (!m_ok || m_size - m_offset < size)
+  {
+    m_ok = false;
+    return std::vector<uint8_t>();
+  }
+  std::vector<uint8_t> bytes(m_data + m_offset, m_data + m_offset + size);
+  m_offset += size;
+  return bytes;
+}
+
+FrtaSnapshotReader
+FrtaSnapshotReader::ReadRecord()
+{
+  uint32_t size = ReadU32();
+  if (!m_ok || m_size - m_offset < size)
+  {
+    m_ok = false;
+    return FrtaSnapshotReader(m_data + m_offset, 0);
+  }
+  FrtaSnapshotReader record(m_data + m_offset, size);
+  m_offset += size;
+  return record;
+}
+
+bool
+FrtaSnapshotReader::IsOk() const
+{
+  return m_ok;
+}
+
+bool
+FrtaSnapshotReader::IsAtEnd() const
+{
+  return m_offset == m_size;
+}
+
+} // namespace ns3
@@ -0,0 +1,126 @@
+#ifndef FRTA_SNAPSHOT_H
+#define FRTA_SNAPSHOT_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Builds a compact binary warm-start snapshot of FRTA state
+ *
+ * Values are written in host byte order; a snapshot is meant to be restored
+ * on the machine (or an identical one) that produced it. Times are stored as
+ * ages relative to the moment the snapshot was taken, so a restored entry
+ * keeps its age regardless of when the restoring run starts.
+ */
+class FrtaSnapshotWriter
+{
+public:
+  static const uint32_t MAGIC = 0x46525441;  //!< "FRTA"
+  static const uint32_t VERSION = 2;         //!< Format version
+
+  FrtaSnapshotWriter();
+
+  void WriteU32(uint32_t value);
+  void WriteU64(uint64_t value);
+  void WriteDouble(double value);
+  void WriteAddress(Ipv4Address address);
+
+  /**
+   * \brief Write the age of a timestamp relative to the current simulation time
+   * \param timestamp The timestamp to store
+   */
+  void WriteAge(Time timestamp);
+
+  /**
+   * \brief Write a byte string prefixed with its size
+   * \param data The bytes to store
+   * \param size The number of bytes
+   */
+  void WriteBytes(const uint8_t* data, uint32_t size);
+
+  /**
+   * \brief Append the contents of another snapshot, prefixed with its size
+   * \param record The nested record
+   */
+  void WriteRecord(const FrtaSnapshotWriter& record);
+
+  /**
+   * \brief Write the accumulated snapshot to a file
+   * \param path The output file
+   * \return true on success
+   */
+  bool WriteToFile(const std::string& path) const;
+
+  /**
+   * \return the number of bytes written so far
+   */
+  uint32_t GetSize() const;
+
+private:
+  void Append(const void* data, uint32_t size);
+
+  std::vector<uint8_t> m_data;  //!< Snapshot contents
+};
+
+/**
+ * \brief Bounds-checked cursor over a snapshot, typically a memory-mapped file
+ *
+ * A read past the end of the data yields zero and marks the reader as failed;
+ * callers check IsOk() after reading a record.
+ */
+class FrtaSnapshotReader
+{
+public:
+  FrtaSnapshotReader(const uint8_t* data, uint64_t size);
+
+  uint32_t ReadU32();
+  uint64_t ReadU64();
+  double ReadDouble();
+  Ipv4Address ReadAddress();
+
+  /**
+   * \brief Read an age and convert it back to a timestamp relative to now
+   * \return The restored timestamp
+   */
+  Time ReadAge();
+
+  /**
+   * \brief Read a byte string written by FrtaSnapshotWriter::WriteBytes
+   * \return The bytes, empty if the string ran past the end of the snapshot
+   */
+  std::vector<uint8_t> ReadBytes();
+
+  /**
+   * \brief Read a record written by FrtaSnapshotWriter::WriteRecord
+   * \return A reader limited to the record; the record is consumed even if
+   *         the caller does not read all of it
+   */
+  FrtaSnapshotReader ReadRecord();
+
+  /**
+   * \return false if a read ran past the end of the snapshot
+   */
+  bool IsOk() const;
+
+  /**
+   * \return true if all data has been consumed
+   */
+  bool IsAtEnd() const;
+
+private:
+  bool Extract(void* data, uint32_t size);
+
+  const uint8_t* m_data;  //!< Start of the snapshot
+  uint64_t m_size;        //!< Snapshot size in bytes
+  uint64_t m_offset;      //!< Current read position
+  bool m_ok;              //!< Whether all reads so far were in bounds
+};
+
+} // namespace ns3
+
+#endif /* FRTA_SNAPSHOT_H */
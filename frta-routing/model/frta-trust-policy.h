@@ -0,0 +1,138 @@
+#ifndef FRTA_TRUST_POLICY_H
+#define FRTA_TRUST_POLICY_H
+
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \brief Trust and metric model used by FrtaRoutingProtocol
+ *
+ * A trust policy is a struct of constexpr parameters and static functions:
+ *
+ * - DEFAULT_TRUST: trust assumed for nodes without history
+ * - MIN_TRUST: lower bound of a smoothed trust value
+ * - EWMA_WEIGHT: weight of a new observation in Combine()
+ * - REWARD, PENALTY: path trust adjustment after a success or failure
+ * - REVERSE_ROUTE_TRUST: trust given to the sender of a route request
+ * - PACKET_COUNT_SCALE: packet count at which count-based trust reaches 0
+ * - COLLISION_TRUST_THRESHOLD: next hops trusted less than this are avoided
+ * - COLLISION_PACKET_THRESHOLD: next hops that sent more than this are avoided
+ * - Combine(current, observed): smoothed trust after an observation
+ *
+ * FrtaRoutingProtocolT instantiates the protocol for a given policy; a new
+ * policy is made available by adding its instantiation and TypeId to
+ * frta-routing-protocol.cc.
+ */
+struct FrtaDefaultTrustPolicy
+{
+  static constexpr double DEFAULT_TRUST = 0.5;
+  static constexpr double MIN_TRUST = 0.1;
+  static constexpr double EWMA_WEIGHT = 0.7;
+  static constexpr double REWARD = 0.1;
+  static constexpr double PENALTY = 0.2;
+  static constexpr double REVERSE_ROUTE_TRUST = 0.7;
+  static constexpr double PACKET_COUNT_SCALE = 100.0;
+  static constexpr double COLLISION_TRUST_THRESHOLD = 0.3;
+  static constexpr uint32_t COLLISION_PACKET_THRESHOLD = 200;
+
+  static constexpr double Combine(double current, double observed)
+  {
+    return EWMA_WEIGHT * observed + (1 - EWMA_WEIGHT) * current;
+  }
+};
+
+/**
+ * \brief Slow to gain trust, quick to lose it
+ *
+ * Uses the stricter collision thresholds FRTA shipped with originally.
+ */
+struct FrtaConservativeTrustPolicy
+{
+  static constexpr double DEFAULT_TRUST = 0.4;
+  static constexpr double MIN_TRUST = 0.0;
+  static constexpr double EWMA_WEIGHT = 0.3;
+  static constexpr double REWARD = 0.05;
+  static constexpr double PENALTY = 0.3;
+  static constexpr double REVERSE_ROUTE_TRUST = 0.5;
+  static constexpr double PACKET_COUNT_SCALE = 100.0;
+  static constexpr double COLLISION_TRUST_THRESHOLD = 0.5;
+  static constexpr uint32_t COLLISION_PACKET_THRESHOLD = 100;
+
+  static constexpr double Combine(double current, double observed)
+  {
+    return EWMA_WEIGHT * observed + (1 - EWMA_WEIGHT) * current;
+  }
+};
+
+/**
+ * \brief Trust recovers at once on a good observation and decays smoothly on
+ * bad ones, suited to lossy but benign networks
+ */
+struct FrtaLenientTrustPolicy
+{
+  static constexpr double DEFAULT_TRUST = 0.6;
+  static constexpr double MIN_TRUST = 0.2;
+  static constexpr double EWMA_WEIGHT = 0.5;
+  static constexpr double REWARD = 0.2;
+  static constexpr double PENALTY = 0.1;
+  static constexpr double REVERSE_ROUTE_TRUST = 0.8;
+  static constexpr double PACKET_COUNT_SCALE = 400.0;
+  static constexpr double COLLISION_TRUST_THRESHOLD = 0.2;
+  static constexpr uint32_t COLLISION_PACKET_THRESHOLD = 400;
+
+  static constexpr double Combine(double current, double observed)
+  {
+    return observed > current ? observed : EWMA_WEIGHT * observed + (1 - EWMA_WEIGHT) * current;
+  }
+};
+
+/**
+ * \brief Trust and metric formulas of FRTA, instantiated for a trust policy
+ */
+template <typename Policy>
+struct FrtaTrustModel
+{
+  /**
+   * \return the smoothed trust after an observation, within [MIN_TRUST, 1]
+   */
+  static constexpr double Smooth(double current, double observed)
+  {
+    return Clamp(Policy::Combine(current, observed), Policy::MIN_TRUST);
+  }
+
+  /**
+   * \return the trust after a transmission along a path succeeded or failed
+   */
+  static constexpr double Adjust(double trust, bool success)
+  {
+    return success ? Clamp(trust + Policy::REWARD, 0.0) : Clamp(trust - Policy::PENALTY, 0.0);
+  }
+
+  /**
+   * \return the trust implied by the number of packets sent through a node
+   */
+  static constexpr double FromPacketCount(uint32_t count)
+  {
+    return Clamp(1.0 - count / Policy::PACKET_COUNT_SCALE, 0.0);
+  }
+
+  static constexpr bool IsLowTrust(double trust)
+  {
+    return trust < Policy::COLLISION_TRUST_THRESHOLD;
+  }
+
+  static constexpr bool IsOverloaded(uint32_t count)
+  {
+    return count > Policy::COLLISION_PACKET_THRESHOLD;
+  }
+
+  static constexpr double Clamp(double trust, double lower)
+  {
+    return trust < lower ? lower : (trust > 1.0 ? 1.0 : trust);
+  }
+};
+
+} // namespace ns3
+
+#endif /* FRTA_TRUST_POLICY_H */
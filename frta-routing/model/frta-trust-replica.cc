@@ -0,0 +1,137 @@
+#include "frta-trust-replica.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaTrustReplica");
+
+constexpr double FrtaTrustReplica::MIN_CHANGE;
+
+FrtaTrustReplica::FrtaTrustReplica()
+{
+  m_hashes.fill(0);
+}
+
+void
+FrtaTrustReplica::SetSelf(Ipv4Address self)
+{
+  m_self = self;
+}
+
+uint32_t
+FrtaTrustReplica::GetBucket(Ipv4Address subject)
+{
+  return Ipv4AddressHash()(subject) % BUCKETS;
+}
+
+uint32_t
+FrtaTrustReplica::Hash(const FrtaTrustRecord& record)
+{
+  // FNV-1a over the fields that make two records equal
+  uint32_t hash = 0x811c9dc5;
+  uint32_t fields[] = {record.subject.Get(), record.origin.Get(), record.version, record.trust};
+  for (uint32_t field : fields)
+  {
+    hash = (hash ^ field) * 0x01000193;
+  }
+  return hash;
+}
+
+void
+FrtaTrustReplica::Put(const FrtaTrustRecord& record)
+{
+  uint32_t& bucketHash = m_hashes[GetBucket(record.subject)];
+  auto inserted = m_records.emplace(record.subject, record);
+  if (!inserted.second)
+  {
+    bucketHash ^= Hash(inserted.first->second);
+    inserted.first->second = record;
+  }
+  bucketHash ^= Hash(record);
+}
+
+bool
+FrtaTrustReplica::SetLocal(Ipv4Address subject, double trust)
+{
+  uint16_t scaled = static_cast<uint16_t>(std::min(1.0, std::max(0.0, trust)) * 65535 + 0.5);
+  FrtaTrustRecord record = {subject, m_self, 1, scaled};
+  auto it = m_records.find(subject);
+  if (it != m_records.end())
+  {
+    if (std::abs(scaled - it->second.trust) < MIN_CHANGE * 65535)
+    {
+      return false;
+    }
+    record.version = it->second.version + 1;
+  }
+  Put(record);
+  return true;
+}
+
+bool
+FrtaTrustReplica::Merge(const FrtaTrustRecord& record)
+{
+  auto it = m_records.find(record.subject);
+  if (it != m_records.end() &&
+      (record.version < it->second.version ||
+       (record.version == it->second.version && record.origin.Get() <= it->second.origin.Get())))
+  {
+    return false;
+  }
+  NS_LOG_LOGIC("Merged trust of " << record.subject << " version " << record.version
+               << " from " << record.origin);
+  Put(record);
+  return true;
+}
+
+void
+FrtaTrustReplica::FillDigest(TrustDigestHeader& digest) const
+{
+  for (uint32_t bucket = 0; bucket < BUCKETS; bucket++)
+  {
+    digest.SetHash(bucket, m_hashes[bucket]);
+  }
+}
+
+uint16_t
+FrtaTrustReplica::Compare(const TrustDigestHeader& digest) const
+{
+  uint16_t differing = 0;
+  for (uint32_t bucket = 0; bucket < BUCKETS; bucket++)
+  {
+    if (digest.GetHash(bucket) != m_hashes[bucket])
+    {
+      differing |= 1 << bucket;
+    }
+  }
+  return differing;
+}
+
+void
+FrtaTrustReplica::GetRecords(uint16_t buckets, std::vector<FrtaTrustRecord>& records) const
+{
+  for (const auto& entry : m_records)
+  {
+    if (buckets & (1 << GetBucket(entry.first)))
+    {
+      records.push_back(entry.second);
+    }
+  }
+}
+
+uint32_t
+FrtaTrustReplica::GetN() const
+{
+  return m_records.size();
+}
+
+void
+FrtaTrustReplica::Clear()
+{
+  m_records.clear();
+  m_hashes.fill(0);
+}
+
+} // namespace ns3
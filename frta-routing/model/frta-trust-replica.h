@@ -0,0 +1,83 @@
+#ifndef FRTA_TRUST_REPLICA_H
+#define FRTA_TRUST_REPLICA_H
+
+#include "ns3/ipv4-address.h"
+#include "frta-routing-header.h"
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Versioned trust table reconciled with neighbors by anti-entropy
+ *
+ * Holds the latest trust reported for each node, by this node or relayed
+ * from others, with a version per record; the higher version wins, ties
+ * going to the higher origin address. Records are spread over
+ * TrustDigestHeader::BUCKETS buckets by subject, and the hash of each
+ * bucket is maintained incrementally, so a digest of the whole table is
+ * O(1) to produce and two tables can be compared bucket by bucket.
+ */
+class FrtaTrustReplica
+{
+public:
+  static const uint32_t BUCKETS = TrustDigestHeader::BUCKETS;  //!< Buckets of the table
+  static constexpr double MIN_CHANGE = 0.01;  //!< Smallest local change that is published
+
+  FrtaTrustReplica();
+
+  /**
+   * \param self The address of this node, the origin of local records
+   */
+  void SetSelf(Ipv4Address self);
+
+  /**
+   * \brief Publish this node's trust in a node
+   * \return true if a new version was created; changes below MIN_CHANGE
+   * are not published
+   */
+  bool SetLocal(Ipv4Address subject, double trust);
+
+  /**
+   * \brief Merge a record received from a neighbor
+   * \return true if it replaced an older record or was new
+   */
+  bool Merge(const FrtaTrustRecord& record);
+
+  /**
+   * \return the bucket a subject belongs to
+   */
+  static uint32_t GetBucket(Ipv4Address subject);
+
+  /**
+   * \brief Fill a digest with the hash of every bucket
+   */
+  void FillDigest(TrustDigestHeader& digest) const;
+
+  /**
+   * \return a mask of the buckets whose hash differs from a digest
+   */
+  uint16_t Compare(const TrustDigestHeader& digest) const;
+
+  /**
+   * \brief Get the records of the buckets set in a mask
+   */
+  void GetRecords(uint16_t buckets, std::vector<FrtaTrustRecord>& records) const;
+
+  uint32_t GetN() const;
+  void Clear();
+
+private:
+  static uint32_t Hash(const FrtaTrustRecord& record);
+  void Put(const FrtaTrustRecord& record);
+
+  std::unordered_map<Ipv4Address, FrtaTrustRecord, Ipv4AddressHash> m_records;  //!< Records by subject
+  std::array<uint32_t, BUCKETS> m_hashes;                                      //!< XOR of record hashes per bucket
+  Ipv4Address m_self;                                                          //!< Origin of local records
+};
+
+} // namespace ns3
+
+#endif /* FRTA_TRUST_REPLICA_H */
@@ -0,0 +1,185 @@
+#include "frta-tx-power-manager.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-tx-vector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaTxPowerWifiManager");
+
+NS_OBJECT_ENSURE_REGISTERED(FrtaTxPowerWifiManager);
+
+TypeId
+FrtaTxPowerWifiManager::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::FrtaTxPowerWifiManager")
+                          .SetParent<WifiRemoteStationManager>()
+                          .SetGroupName("FrtaRouting")
+                          .AddConstructor<FrtaTxPowerWifiManager>()
+                          .AddAttribute("DataMode",
+                                        "The transmission mode to use for every data packet "
+                                        "transmission.",
+                                        StringValue("OfdmRate6Mbps"),
+                                        MakeWifiModeAccessor(&FrtaTxPowerWifiManager::m_dataMode),
+                                        MakeWifiModeChecker())
+                          .AddAttribute("ControlMode",
+                                        "The transmission mode to use for every RTS packet "
+                                        "transmission.",
+                                        StringValue("OfdmRate6Mbps"),
+                                        MakeWifiModeAccessor(&FrtaTxPowerWifiManager::m_ctlMode),
+                                        MakeWifiModeChecker());
+  return tid;
+}
+
+FrtaTxPowerWifiManager::FrtaTxPowerWifiManager()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+FrtaTxPowerWifiManager::~FrtaTxPowerWifiManager()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void
+FrtaTxPowerWifiManager::SetupPhy(const Ptr<WifiPhy> phy)
+{
+  NS_LOG_FUNCTION(this << phy);
+  // Group addressed frames, FRTA broadcasts among them, at full power
+  SetAttribute("DefaultTxPowerLevel", UintegerValue(phy->GetNTxPower() - 1));
+  WifiRemoteStationManager::SetupPhy(phy);
+}
+
+void
+FrtaTxPowerWifiManager::SetTxPower(Mac48Address station, double dbm)
+{
+  Ptr<WifiPhy> phy = GetPhy();
+  uint8_t nLevels = phy->GetNTxPower();
+  double start = phy->GetTxPowerStart();
+  double end = phy->GetTxPowerEnd();
+  uint8_t level = nLevels - 1;
+  if (nLevels > 1 && end > start)
+  {
+    double step = (end - start) / (nLevels - 1);
+    double needed = std::ceil((dbm - start) / step - 1e-9);
+    level = static_cast<uint8_t>(std::min<double>(std::max(needed, 0.0), nLevels - 1));
+  }
+  m_powerLevels[station] = level;
+}
+
+double
+FrtaTxPowerWifiManager::GetTxPower(Mac48Address station) const
+{
+  Ptr<WifiPhy> phy = GetPhy();
+  auto it = m_powerLevels.find(station);
+  uint8_t level = it != m_powerLevels.end() ? it->second : phy->GetNTxPower() - 1;
+  if (phy->GetNTxPower() < 2)
+  {
+    return phy->GetTxPowerStart();
+  }
+  return phy->GetTxPowerStart() +
+         level * (phy->GetTxPowerEnd() - phy->GetTxPowerStart()) / (phy->GetNTxPower() - 1);
+}
+
+uint8_t
+FrtaTxPowerWifiManager::GetPowerLevel(WifiRemoteStation* station) const
+{
+  auto it = m_powerLevels.find(station->m_state->m_address);
+  return it != m_powerLevels.end() ? it->second : GetPhy()->GetNTxPower() - 1;
+}
+
+WifiRemoteStation*
+FrtaTxPowerWifiManager::DoCreateStation(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return new WifiRemoteStation();
+}
+
+void
+FrtaTxPowerWifiManager::DoReportRxOk(WifiRemoteStation* station, double rxSnr, WifiMode txMode)
+{
+  NS_LOG_FUNCTION(this << station << rxSnr << txMode);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportRtsFailed(WifiRemoteStation* station)
+{
+  NS_LOG_FUNCTION(this << station);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportDataFailed(WifiRemoteStation* station)
+{
+  NS_LOG_FUNCTION(this << station);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportRtsOk(WifiRemoteStation* station, double ctsSnr, WifiMode ctsMode,
+                                      double rtsSnr)
+{
+  NS_LOG_FUNCTION(this << station << ctsSnr << ctsMode << rtsSnr);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportDataOk(WifiRemoteStation* station, double ackSnr, WifiMode ackMode,
+                                       double dataSnr, uint16_t dataChannelWidth, uint8_t dataNss)
+{
+  NS_LOG_FUNCTION(this << station << ackSnr << ackMode << dataSnr << dataChannelWidth << +dataNss);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportFinalRtsFailed(WifiRemoteStation* station)
+{
+  NS_LOG_FUNCTION(this << station);
+}
+
+void
+FrtaTxPowerWifiManager::DoReportFinalDataFailed(WifiRemoteStation* station)
+{
+  NS_LOG_FUNCTION(this << station);
+}
+
+WifiTxVector
+FrtaTxPowerWifiManager::DoGetDataTxVector(WifiRemoteStation* station, uint16_t allowedWidth)
+{
+  NS_LOG_FUNCTION(this << station << allowedWidth);
+  uint8_t nss = std::min(GetMaxNumberOfTransmitStreams(), GetNumberOfSupportedStreams(station));
+  if (m_dataMode.GetModulationClass() == WIFI_MOD_CLASS_HT)
+  {
+    nss = 1 + (m_dataMode.GetMcsValue() / 8);
+  }
+  return WifiTxVector(
+    m_dataMode,
+    GetPowerLevel(station),
+    GetPreambleForTransmission(m_dataMode.GetModulationClass(), GetShortPreambleEnabled()),
+    ConvertGuardIntervalToNanoSeconds(m_dataMode, GetShortGuardIntervalSupported(station),
+                                      NanoSeconds(GetGuardInterval(station))),
+    GetNumberOfAntennas(),
+    nss,
+    0,
+    GetPhy()->GetTxBandwidth(m_dataMode, std::min(allowedWidth, GetChannelWidth(station))),
+    GetAggregation(station));
+}
+
+WifiTxVector
+FrtaTxPowerWifiManager::DoGetRtsTxVector(WifiRemoteStation* station)
+{
+  NS_LOG_FUNCTION(this << station);
+  return WifiTxVector(
+    m_ctlMode,
+    GetPowerLevel(station),
+    GetPreambleForTransmission(m_ctlMode.GetModulationClass(), GetShortPreambleEnabled()),
+    ConvertGuardIntervalToNanoSeconds(m_ctlMode, GetShortGuardIntervalSupported(station),
+                                      NanoSeconds(GetGuardInterval(station))),
+    1,
+    1,
+    0,
+    GetPhy()->GetTxBandwidth(m_ctlMode, GetChannelWidth(station)),
+    GetAggregation(station));
+}
+
+} // namespace ns3
@@ -0,0 +1,69 @@
+#ifndef FRTA_TX_POWER_MANAGER_H
+#define FRTA_TX_POWER_MANAGER_H
+
+#include "ns3/mac48-address.h"
+#include "ns3/wifi-mode.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \brief Constant rate Wi-Fi manager with a transmit power per station
+ *
+ * Rates are chosen as by ns3::ConstantRateWifiManager. Unicast frames to
+ * a station go out at the lowest power level of the PHY that reaches the
+ * power set through SetTxPower(), and at the highest level while none is
+ * set. Group addressed frames use the highest level, so that broadcast
+ * control packets keep their full range and show the path loss to each
+ * neighbor. FrtaRoutingProtocol sets the powers when its TxPowerControl
+ * attribute is enabled.
+ */
+class FrtaTxPowerWifiManager : public WifiRemoteStationManager
+{
+public:
+  static TypeId GetTypeId(void);
+  FrtaTxPowerWifiManager();
+  virtual ~FrtaTxPowerWifiManager();
+
+  void SetupPhy(const Ptr<WifiPhy> phy) override;
+
+  /**
+   * \brief Set the power unicast frames to a station are sent with
+   * \param station MAC address of the station
+   * \param dbm Power in dBm, rounded up to a power level of the PHY
+   */
+  void SetTxPower(Mac48Address station, double dbm);
+
+  /**
+   * \return the power in dBm of the level used for a station
+   */
+  double GetTxPower(Mac48Address station) const;
+
+private:
+  WifiRemoteStation* DoCreateStation(void) const override;
+  void DoReportRxOk(WifiRemoteStation* station, double rxSnr, WifiMode txMode) override;
+  void DoReportRtsFailed(WifiRemoteStation* station) override;
+  void DoReportDataFailed(WifiRemoteStation* station) override;
+  void DoReportRtsOk(WifiRemoteStation* station, double ctsSnr, WifiMode ctsMode,
+                     double rtsSnr) override;
+  void DoReportDataOk(WifiRemoteStation* station, double ackSnr, WifiMode ackMode,
+                      double dataSnr, uint16_t dataChannelWidth, uint8_t dataNss) override;
+  void DoReportFinalRtsFailed(WifiRemoteStation* station) override;
+  void DoReportFinalDataFailed(WifiRemoteStation* station) override;
+  WifiTxVector DoGetDataTxVector(WifiRemoteStation* station, uint16_t allowedWidth) override;
+  WifiTxVector DoGetRtsTxVector(WifiRemoteStation* station) override;
+
+  /**
+   * \return the power level of the PHY for a station
+   */
+  uint8_t GetPowerLevel(WifiRemoteStation* station) const;
+
+  WifiMode m_dataMode;  //!< Wi-Fi mode for unicast data frames
+  WifiMode m_ctlMode;   //!< Wi-Fi mode for RTS frames
+  std::map<Mac48Address, uint8_t> m_powerLevels;  //!< Power level by station
+};
+
+} // namespace ns3
+
+#endif /* FRTA_TX_POWER_MANAGER_H */
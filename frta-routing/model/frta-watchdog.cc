@@ -0,0 +1,169 @@
+#include "frta-watchdog.h"
+#include "frta-fingerprint-cache.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <bitset>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FrtaWatchdog");
+
+FrtaWatchdog::FrtaWatchdog()
+  : m_timeout(MilliSeconds(200)),
+    m_window(32),
+    m_threshold(0.5),
+    m_blacklistTime(Seconds(30))
+{
+}
+
+void
+FrtaWatchdog::SetTimeout(Time timeout)
+{
+  m_timeout = timeout;
+}
+
+void
+FrtaWatchdog::SetWindow(uint32_t window)
+{
+  m_window = std::min(std::max<uint32_t>(window, 1), MAX_WINDOW);
+}
+
+void
+FrtaWatchdog::SetThreshold(double threshold)
+{
+  m_threshold = threshold;
+}
+
+void
+FrtaWatchdog::SetBlacklistTime(Time duration)
+{
+  m_blacklistTime = duration;
+}
+
+void
+FrtaWatchdog::SetCapacity(uint32_t capacity)
+{
+  m_rings.SetCapacity(capacity);
+}
+
+void
+FrtaWatchdog::Watch(const Ipv4Header& header, Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION(this << header.GetDestination() << nextHop);
+  uint64_t fingerprint = FrtaFingerprintCache::Fingerprint(header);
+  Time now = Simulator::Now();
+  m_watched[fingerprint] = {nextHop, header.GetTtl(), now};
+  m_order.emplace_back(fingerprint, now);
+  m_stats.watched++;
+}
+
+void
+FrtaWatchdog::Overhear(const Ipv4Header& header, OutcomeCallback outcome)
+{
+  auto it = m_watched.find(FrtaFingerprintCache::Fingerprint(header));
+  // A copy with the TTL it was sent with is a retransmission, not a forward
+  if (it == m_watched.end() || header.GetTtl() >= it->second.ttl)
+  {
+    return;
+  }
+  Ipv4Address nextHop = it->second.nextHop;
+  m_watched.erase(it);
+  m_stats.forwarded++;
+  Record(nextHop, true, outcome);
+}
+
+void
+FrtaWatchdog::Expire(OutcomeCallback outcome)
+{
+  Time now = Simulator::Now();
+  while (!m_order.empty() && now - m_order.front().second >= m_timeout)
+  {
+    auto it = m_watched.find(m_order.front().first);
+    // Skip packets already overheard, or watched again since
+    if (it != m_watched.end() && it->second.sent == m_order.front().second)
+    {
+      Ipv4Address nextHop = it->second.nextHop;
+      m_watched.erase(it);
+      m_stats.missed++;
+      NS_LOG_LOGIC("Next hop " << nextHop << " did not forward a packet");
+      Record(nextHop, false, outcome);
+    }
+    m_order.pop_front();
+  }
+}
+
+void
+FrtaWatchdog::Record(Ipv4Address neighbor, bool forwarded, OutcomeCallback& outcome)
+{
+  ForwardRing& ring = m_rings[neighbor];
+  ring.bits = (ring.bits << 1) | (forwarded ? 1 : 0);
+  if (ring.n < m_window)
+  {
+    ring.n++;
+  }
+  bool blacklisted = false;
+  if (!forwarded && ring.n >= (m_window + 1) / 2 && GetForwardRatio(neighbor) < m_threshold &&
+      m_blacklist.find(neighbor) == m_blacklist.end())
+  {
+    NS_LOG_LOGIC("Blacklisting " << neighbor << ", forward ratio " << GetForwardRatio(neighbor));
+    m_blacklist[neighbor] = Simulator::Now() + m_blacklistTime;
+    m_stats.blacklisted++;
+    blacklisted = true;
+  }
+  outcome(neighbor, forwarded, blacklisted);
+}
+
+double
+FrtaWatchdog::GetForwardRatio(Ipv4Address neighbor) const
+{
+  auto it = m_rings.find(neighbor);
+  if (it == m_rings.end() || it->second.n == 0)
+  {
+    return 1.0;
+  }
+  const ForwardRing& ring = it->second;
+  uint64_t mask = ring.n == MAX_WINDOW ? ~0ULL : (1ULL << ring.n) - 1;
+  return static_cast<double>(std::bitset<MAX_WINDOW>(ring.bits & mask).count()) / ring.n;
+}
+
+uint32_t
+FrtaWatchdog::GetSamples(Ipv4Address neighbor) const
+{
+  auto it = m_rings.find(neighbor);
+  return it != m_rings.end() ? it->second.n : 0;
+}
+
+bool
+FrtaWatchdog::IsBlacklisted(Ipv4Address neighbor)
+{
+  auto it = m_blacklist.find(neighbor);
+  if (it == m_blacklist.end())
+  {
+    return false;
+  }
+  if (Simulator::Now() < it->second)
+  {
+    return true;
+  }
+  m_blacklist.erase(it);
+  m_rings.erase(neighbor);
+  return false;
+}
+
+const FrtaWatchdogStats&
+FrtaWatchdog::GetStats() const
+{
+  return m_stats;
+}
+
+void
+FrtaWatchdog::Clear()
+{
+  m_watched.clear();
+  m_order.clear();
+  m_rings.clear();
+  m_blacklist.clear();
+}
+
+} // namespace ns3
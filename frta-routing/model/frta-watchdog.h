@@ -0,0 +1,149 @@
+#ifndef FRTA_WATCHDOG_H
+#define FRTA_WATCHDOG_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/nstime.h"
+#include "frta-bounded-map.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \brief Counters of the forwarding watchdog
+ */
+struct FrtaWatchdogStats
+{
+  uint64_t watched = 0;      //!< Packets handed to a next hop and watched
+  uint64_t forwarded = 0;    //!< Watched packets overheard being forwarded
+  uint64_t missed = 0;       //!< Watched packets not forwarded within the timeout
+  uint64_t blacklisted = 0;  //!< Times a next hop was blacklisted
+};
+
+/**
+ * \brief Verifies that next hops forward the packets handed to them
+ *
+ * After a packet is handed to a next hop that is not its destination, the
+ * watchdog expects to overhear the next hop retransmit it, with a lower
+ * TTL, within a timeout. The outcomes of the last packets per next hop are
+ * kept as bits of a 64-bit ring. A next hop whose forward ratio drops below
+ * a threshold over at least half a window is blacklisted for a while.
+ */
+class FrtaWatchdog
+{
+public:
+  static const uint32_t MAX_WINDOW = 64;  //!< Outcomes a ring holds at most
+
+  /**
+   * \brief Reports an outcome: the next hop, whether it forwarded the
+   * packet, and whether it was just blacklisted
+   */
+  typedef std::function<void(Ipv4Address, bool, bool)> OutcomeCallback;
+
+  FrtaWatchdog();
+
+  /**
+   * \param timeout Time a next hop has to forward a packet
+   */
+  void SetTimeout(Time timeout);
+
+  /**
+   * \param window Number of recent outcomes the forward ratio is taken over
+   */
+  void SetWindow(uint32_t window);
+
+  /**
+   * \param threshold Forward ratio below which a next hop is blacklisted
+   */
+  void SetThreshold(double threshold);
+
+  /**
+   * \param duration Time a next hop stays blacklisted
+   */
+  void SetBlacklistTime(Time duration);
+
+  /**
+   * \param capacity Maximum number of next hops tracked, 0 for unbounded
+   */
+  void SetCapacity(uint32_t capacity);
+
+  /**
+   * \brief Watch a packet handed to a next hop
+   * \param header The IPv4 header of the packet as it was sent
+   * \param nextHop The next hop expected to forward it
+   */
+  void Watch(const Ipv4Header& header, Ipv4Address nextHop);
+
+  /**
+   * \brief Check an overheard packet against the watched ones
+   * \param header The IPv4 header of the overheard packet
+   * \param outcome Invoked if the packet was watched
+   */
+  void Overhear(const Ipv4Header& header, OutcomeCallback outcome);
+
+  /**
+   * \brief Count the watched packets whose timeout passed as not forwarded
+   * \param outcome Invoked for each of them
+   */
+  void Expire(OutcomeCallback outcome);
+
+  /**
+   * \return the fraction of recent packets a next hop forwarded, 1 if none
+   * were watched
+   */
+  double GetForwardRatio(Ipv4Address neighbor) const;
+
+  /**
+   * \return the number of outcomes the forward ratio of a next hop is based on
+   */
+  uint32_t GetSamples(Ipv4Address neighbor) const;
+
+  /**
+   * \return true if a next hop is blacklisted; an expired blacklisting is
+   * lifted and the next hop starts over with an empty ring
+   */
+  bool IsBlacklisted(Ipv4Address neighbor);
+
+  const FrtaWatchdogStats& GetStats() const;
+  void Clear();
+
+private:
+  /**
+   * \brief Recent outcomes of one next hop, newest in the lowest bit
+   */
+  struct ForwardRing
+  {
+    uint64_t bits = 0;  //!< 1 for a forwarded packet
+    uint8_t n = 0;      //!< Number of valid bits
+  };
+
+  /**
+   * \brief A packet waiting to be forwarded by its next hop
+   */
+  struct Watched
+  {
+    Ipv4Address nextHop;  //!< Next hop the packet was handed to
+    uint8_t ttl;          //!< TTL the packet was sent with
+    Time sent;            //!< Time the packet was sent
+  };
+
+  void Record(Ipv4Address neighbor, bool forwarded, OutcomeCallback& outcome);
+
+  std::unordered_map<uint64_t, Watched> m_watched;                  //!< Watched packets by fingerprint
+  std::deque<std::pair<uint64_t, Time>> m_order;                    //!< Watched packets in sending order
+  FrtaBoundedMap<Ipv4Address, ForwardRing, Ipv4AddressHash> m_rings; //!< Outcomes per next hop
+  std::map<Ipv4Address, Time> m_blacklist;                          //!< Blacklisted next hops, until when
+  Time m_timeout;                                                   //!< Time to forward a packet
+  uint32_t m_window;                                                //!< Outcomes per forward ratio
+  double m_threshold;                                               //!< Blacklisting forward ratio
+  Time m_blacklistTime;                                             //!< Blacklisting duration
+  FrtaWatchdogStats m_stats;
+};
+
+} // namespace ns3
+
+#endif /* FRTA_WATCHDOG_H */
@@ -0,0 +1,383 @@
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/frta-routing-helper.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("FrtaTuning");
+
+/**
+ * Successive-halving search over the FRTA protocol attributes.
+ *
+ * For each deployment profile a set of random configurations is run on a
+ * short simulation; the best third survives to a round three times as long,
+ * and so on until one configuration is left. Configurations are ranked by
+ *
+ *   score = wPdr * PDR - wDelay * min(1, delay / delayRef) - wOverhead * min(1, overhead)
+ *
+ * where overhead is FRTA control bytes sent per data byte delivered. Control
+ * bytes are counted as IP packets leave each node, broadcasts included, and
+ * exclude the FRTA messages that carry data packets. Every
+ * evaluation is appended to frta-tuning.csv and the winner of each profile
+ * is printed as command-line attribute settings.
+ */
+
+struct Profile
+{
+  std::string name;
+  uint32_t nodes;
+  double area;      // side of the square deployment area, m
+  double maxSpeed;  // 0 for static nodes, m/s
+  uint32_t flows;
+};
+
+struct Parameter
+{
+  std::string name;
+  double min;
+  double max;
+  bool integer;
+  bool time;  // value in seconds
+};
+
+struct Candidate
+{
+  std::vector<double> values;
+  double pdr;
+  double delay;
+  double overhead;
+  double score;
+};
+
+struct Weights
+{
+  double pdr;
+  double delay;
+  double overhead;
+  double delayRef;
+};
+
+static uint64_t g_controlBytes = 0;
+
+/**
+ * Ipv4L3Protocol Tx trace sink counting FRTA control bytes.
+ */
+static void
+CountControlTx(Ptr<const Packet> packet, Ptr<Ipv4>, uint32_t)
+{
+  Ptr<Packet> copy = packet->Copy();
+  Ipv4Header ipHeader;
+  copy->RemoveHeader(ipHeader);
+  if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER || ipHeader.GetFragmentOffset() != 0)
+  {
+    return;
+  }
+  UdpHeader udpHeader;
+  copy->RemoveHeader(udpHeader);
+  if (udpHeader.GetSourcePort() != FrtaRoutingProtocol::FRTA_PORT ||
+      udpHeader.GetDestinationPort() != FrtaRoutingProtocol::FRTA_PORT)
+  {
+    return;
+  }
+
+  // Aggregates, coded packets and bundles carry data
+  FrtaHeader frtaHeader;
+  copy->RemoveHeader(frtaHeader);
+  switch (frtaHeader.GetMessageType())
+  {
+    case FrtaHeader::FRTA_AGGREGATE:
+    case FrtaHeader::FRTA_CODED_PACKET:
+    case FrtaHeader::FRTA_BUNDLE:
+      return;
+    default:
+      g_controlBytes += packet->GetSize();
+  }
+}
+
+static const std::vector<Parameter> g_parameters = {
+  {"RouteRequestTimeout", 0.5, 5.0, false, true},
+  {"RouteCacheTimeout", 5.0, 60.0, false, true},
+  {"MaxHopCount", 3, FRTA_MAX_HOP_COUNT, true, false},
+  {"MinPathTrust", 0.2, 0.8, false, false},
+  {"MaxPaths", 1, FRTA_MAX_PATHS, true, false},
+  {"MaxJitter", 0.0001, 0.01, false, true},
+};
+
+static Candidate
+SampleCandidate(Ptr<UniformRandomVariable> random)
+{
+  Candidate candidate;
+  for (const auto& parameter : g_parameters)
+  {
+    double value = random->GetValue(parameter.min, parameter.max);
+    candidate.values.push_back(parameter.integer ? std::round(value) : value);
+  }
+  return candidate;
+}
+
+static void
+ApplyCandidate(FrtaRoutingHelper& helper, const Candidate& candidate)
+{
+  for (uint32_t i = 0; i < g_parameters.size(); i++)
+  {
+    const Parameter& parameter = g_parameters[i];
+    double value = candidate.values[i];
+    if (parameter.time)
+    {
+      helper.Set(parameter.name, TimeValue(Seconds(value)));
+    }
+    else if (parameter.integer)
+    {
+      helper.Set(parameter.name, UintegerValue(static_cast<uint32_t>(value)));
+    }
+    else
+    {
+      helper.Set(parameter.name, DoubleValue(value));
+    }
+  }
+}
+
+static std::string
+FormatCandidate(const Candidate& candidate, const std::string& separator, bool commandLine)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < g_parameters.size(); i++)
+  {
+    const Parameter& parameter = g_parameters[i];
+    if (i > 0)
+    {
+      os << separator;
+    }
+    if (commandLine)
+    {
+      os << "--ns3::FrtaRoutingProtocol::" << parameter.name << "=";
+    }
+    os << candidate.values[i] << (commandLine && parameter.time ? "s" : "");
+  }
+  return os.str();
+}
+
+/**
+ * Run one simulation of a profile with the given configuration and fill in
+ * the candidate's metrics and score.
+ */
+static void
+Evaluate(const Profile& profile, Candidate& candidate, double simTime, uint32_t run,
+         const Weights& weights)
+{
+  RngSeedManager::SetRun(run);
+
+  NodeContainer nodes;
+  nodes.Create(profile.nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard(WIFI_STANDARD_80211b);
+  wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                              "DataMode", StringValue("DsssRate11Mbps"),
+                              "ControlMode", StringValue("DsssRate11Mbps"));
+  YansWifiPhyHelper wifiPhy;
+  YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
+  wifiChannel.AddPropagationLoss("ns3::RangePropagationLossModel",
+                                "MaxRange", DoubleValue(100.0));
+  Ptr<YansWifiChannel> channel = wifiChannel.Create();
+  wifiPhy.SetChannel(channel);
+  WifiMacHelper wifiMac;
+  wifiMac.SetType("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, nodes);
+
+  // Streams are numbered automatically in creation order across runs, so fix
+  // them to give every configuration of a round the same scenario; stream 0
+  // is the configuration sampler
+  int64_t stream = 1;
+  stream += wifi.AssignStreams(devices, stream);
+  stream += wifiChannel.AssignStreams(channel, stream);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0.0|Max=" << profile.area << "]";
+  Ptr<RandomRectanglePositionAllocator> positionAlloc = CreateObject<RandomRectanglePositionAllocator>();
+  positionAlloc->SetAttribute("X", StringValue(bound.str()));
+  positionAlloc->SetAttribute("Y", StringValue(bound.str()));
+  stream += positionAlloc->AssignStreams(stream);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator(positionAlloc);
+  if (profile.maxSpeed > 0.0)
+  {
+    std::ostringstream speed;
+    speed << "ns3::UniformRandomVariable[Min=1.0|Max=" << profile.maxSpeed << "]";
+    mobility.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                             "Speed", StringValue(speed.str()),
+                             "Pause", StringValue("ns3::ConstantRandomVariable[Constant=2.0]"),
+                             "PositionAllocator", PointerValue(positionAlloc));
+  }
+  else
+  {
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+  }
+  mobility.Install(nodes);
+  stream += mobility.AssignStreams(nodes, stream);
+
+  FrtaRoutingHelper frtaRouting;
+  ApplyCandidate(frtaRouting, candidate);
+  frtaRouting.Install(nodes);
+  stream += FrtaRoutingHelper::AssignStreams(nodes, stream);
+
+  Ipv4AddressHelper address;
+  address.SetBase("10.1.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+  // Data flows between random node pairs on port 10; FRTA uses FRTA_PORT
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable>();
+  pick->SetStream(stream++);
+  for (uint32_t i = 0; i < profile.flows; i++)
+  {
+    uint32_t src = pick->GetInteger(0, profile.nodes - 1);
+    uint32_t dst = (src + 1 + pick->GetInteger(0, profile.nodes - 2)) % profile.nodes;
+
+    UdpServerHelper server(10 + i);
+    ApplicationContainer serverApps = server.Install(nodes.Get(dst));
+    serverApps.Start(Seconds(0.5));
+
+    UdpClientHelper client(interfaces.GetAddress(dst), 10 + i);
+    client.SetAttribute("MaxPackets", UintegerValue(0));
+    client.SetAttribute("Interval", TimeValue(Seconds(0.25)));
+    client.SetAttribute("PacketSize", UintegerValue(512));
+    ApplicationContainer clientApps = client.Install(nodes.Get(src));
+    clientApps.Start(Seconds(1.0 + pick->GetValue(0.0, 1.0)));
+    clientApps.Stop(Seconds(simTime - 1.0));
+  }
+
+  FlowMonitorHelper flowmonHelper;
+  Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll();
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
+
+  // FlowMonitor does not classify broadcasts, which most control packets are
+  g_controlBytes = 0;
+  Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/Tx",
+                                MakeCallback(&CountControlTx));
+
+  Simulator::Stop(Seconds(simTime));
+  Simulator::Run();
+
+  uint64_t txPackets = 0;
+  uint64_t rxPackets = 0;
+  uint64_t rxBytes = 0;
+  Time delaySum;
+  monitor->CheckForLostPackets();
+  for (const auto& flow : monitor->GetFlowStats())
+  {
+    Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow(flow.first);
+    if (tuple.destinationPort != 9)
+    {
+      txPackets += flow.second.txPackets;
+      rxPackets += flow.second.rxPackets;
+      rxBytes += flow.second.rxBytes;
+      delaySum += flow.second.delaySum;
+    }
+  }
+  Simulator::Destroy();
+
+  candidate.pdr = txPackets > 0 ? static_cast<double>(rxPackets) / txPackets : 0.0;
+  candidate.delay = rxPackets > 0 ? delaySum.GetSeconds() / rxPackets : weights.delayRef;
+  candidate.overhead = static_cast<double>(g_controlBytes) / std::max<uint64_t>(rxBytes, 1);
+  candidate.score = weights.pdr * candidate.pdr -
+                    weights.delay * std::min(1.0, candidate.delay / weights.delayRef) -
+                    weights.overhead * std::min(1.0, candidate.overhead);
+}
+
+int
+main(int argc, char *argv[])
+{
+  uint32_t nCandidates = 27;
+  uint32_t eta = 3;
+  double minTime = 10.0;
+  uint32_t seed = 1;
+  std::string profileNames = "static-dense,mobile-sparse,mobile-large";
+  Weights weights = {1.0, 0.3, 0.2, 0.5};
+
+  CommandLine cmd;
+  cmd.AddValue("nCandidates", "Number of random configurations per profile", nCandidates);
+  cmd.AddValue("eta", "Fraction (1/eta) of configurations kept after each round", eta);
+  cmd.AddValue("minTime", "Simulated time of the first round, in seconds", minTime);
+  cmd.AddValue("seed", "Seed of the configuration sampler", seed);
+  cmd.AddValue("profiles", "Comma-separated deployment profiles to tune", profileNames);
+  cmd.AddValue("wPdr", "Weight of the packet delivery ratio", weights.pdr);
+  cmd.AddValue("wDelay", "Weight of the normalized mean delay", weights.delay);
+  cmd.AddValue("wOverhead", "Weight of the control overhead per delivered byte", weights.overhead);
+  cmd.AddValue("delayRef", "Mean delay, in seconds, counted as the worst case", weights.delayRef);
+  cmd.Parse(argc, argv);
+  eta = std::max<uint32_t>(eta, 2);
+  nCandidates = std::max<uint32_t>(nCandidates, 1);
+
+  LogComponentEnable("FrtaTuning", LOG_LEVEL_INFO);
+  FrtaRoutingProtocol::EnableProtocolLog(false);
+
+  const std::vector<Profile> allProfiles = {
+    {"static-dense", 25, 150.0, 0.0, 4},
+    {"mobile-sparse", 30, 300.0, 10.0, 4},
+    {"mobile-large", 100, 500.0, 5.0, 10},
+  };
+
+  std::ofstream results("frta-tuning.csv", std::ios::out | std::ios::trunc);
+  results << "profile,round,simTime,candidate";
+  for (const auto& parameter : g_parameters)
+  {
+    results << "," << parameter.name;
+  }
+  results << ",pdr,delay,overhead,score\n";
+
+  RngSeedManager::SetSeed(seed);
+  Ptr<UniformRandomVariable> sampler = CreateObject<UniformRandomVariable>();
+  sampler->SetStream(0);
+
+  for (const auto& profile : allProfiles)
+  {
+    if (("," + profileNames + ",").find("," + profile.name + ",") == std::string::npos)
+    {
+      continue;
+    }
+
+    std::vector<Candidate> candidates;
+    for (uint32_t i = 0; i < nCandidates; i++)
+    {
+      candidates.push_back(SampleCandidate(sampler));
+    }
+
+    double simTime = minTime;
+    for (uint32_t round = 0; !candidates.empty(); round++)
+    {
+      NS_LOG_INFO("Profile " << profile.name << " round " << round << ": "
+                  << candidates.size() << " configurations, " << simTime << "s each");
+      for (uint32_t i = 0; i < candidates.size(); i++)
+      {
+        // Same run number for every configuration of a round, so they face the same scenario
+        Evaluate(profile, candidates[i], simTime, round + 1, weights);
+        results << profile.name << "," << round << "," << simTime << "," << i << ","
+                << FormatCandidate(candidates[i], ",", false) << ","
+                << candidates[i].pdr << "," << candidates[i].delay << ","
+                << candidates[i].overhead << "," << candidates[i].score << "\n";
+      }
+      std::sort(candidates.begin(), candidates.end(),
+                [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+      if (candidates.size() == 1)
+      {
+        break;
+      }
+      candidates.resize((candidates.size() + eta - 1) / eta);
+      simTime *= eta;
+    }
+
+    const Candidate& best = candidates.front();
+    std::cout << profile.name << " (score " << best.score << ", PDR " << best.pdr
+              << ", delay " << best.delay << "s, overhead " << best.overhead << "):\n  "
+              << FormatCandidate(best, " ", true) << std::endl;
+  }
+  return 0;
+}